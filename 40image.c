@@ -14,39 +14,94 @@
  *     Notes:
  *   - We didn't write the main function here, it was given to us
  *   - There must be at most 1 file on the command line inputted
+ *   - --fixed picks the integer-only pipeline and --conformance checks the
+ *     integer encoder against the float one (see codecopts.h)
+ *   - --ycocg compresses with the YCoCg-R transform (see ycocg.h); the
+ *     decoder reads the transform from the header, so -d needs no option
+ *   - PGM images (P5 or P2) are compressed without any chroma work and
+ *     decompress to P5 (see graymap.h)
+ *   - --kernel=NAME picks the level of vector kernels instead of the one
+ *     detected for this CPU (see kernels.h)
+ *   - --pool-stats prints how the buffers of the pipeline were reused to
+ *     standard error (see pool.h)
+ *   - -o FILE writes the output to FILE instead of standard output; the
+ *     file is mapped and written by several threads (see outputmap.h and
+ *     bands.h)
+ *   - --native writes compressed images in the native container, whose
+ *     code words can be mapped and used in place (see readwritecompressed.h)
+ *   - -r reads a compressed image in either container and writes it again
+ *     in the text container, or the native one with --native
  *     
  *******************************************************************/
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include "assert.h"
 #include "compress40.h"
+#include "codecopts.h"
+#include "codewords.h"
+#include "readwritecompressed.h"
+#include "kernels.h"
+#include "pool.h"
 
 static void (*compress_or_decompress)(FILE *input) = compress40;
 
+static void convert40(FILE *input);
+static void force_kernels(const char *program, const char *name);
+static void print_pool_stats(void);
+
 int main(int argc, char *argv[])
 {
         int i;
+        struct Codec_options options = Codecopts_get();
+        bool pool_stats = false;
 
         for (i = 1; i < argc; i++) {
-                if (strcmp(argv[i], "-c") == 0) {
+                if (strcmp(argv[i], "-o") == 0) {
+                        if (i + 1 == argc) {
+                                fprintf(stderr, "%s: option '-o' needs a "
+                                        "file name\n", argv[0]);
+                                exit(1);
+                        }
+                        options.output = argv[++i];
+                } else if (strcmp(argv[i], "-c") == 0) {
                         compress_or_decompress = compress40;
                 } else if (strcmp(argv[i], "-d") == 0) {
                         compress_or_decompress = decompress40;
+                } else if (strcmp(argv[i], "-r") == 0) {
+                        compress_or_decompress = convert40;
+                } else if (strcmp(argv[i], "--fixed") == 0) {
+                        options.arithmetic = CODEC_FIXED;
+                } else if (strcmp(argv[i], "--conformance") == 0) {
+                        options.conformance = true;
+                } else if (strcmp(argv[i], "--ycocg") == 0) {
+                        options.transform = CODEC_YCOCG;
+                } else if (strcmp(argv[i], "--native") == 0) {
+                        options.native = true;
+                } else if (strncmp(argv[i], "--kernel=", 9) == 0) {
+                        force_kernels(argv[0], argv[i] + 9);
+                } else if (strcmp(argv[i], "--pool-stats") == 0) {
+                        pool_stats = true;
                 } else if (*argv[i] == '-') {
                         fprintf(stderr, "%s: unknown option '%s'\n",
                                 argv[0], argv[i]);
                         exit(1);
                 } else if (argc - i > 2) {
-                        fprintf(stderr, "Usage: %s -d [filename]\n"
-                                "       %s -c [filename]\n",
-                                argv[0], argv[0]);
+                        fprintf(stderr, "Usage: %s -d [options] [filename]\n"
+                                "       %s -c [options] [filename]\n"
+                                "       %s -r [options] [filename]\n"
+                                "Options: --fixed  --conformance  --ycocg  "
+                                "--kernel=scalar|sse|avx2|avx512  "
+                                "--pool-stats  -o FILE  --native\n",
+                                argv[0], argv[0], argv[0]);
                         exit(1);
                 } else {
                         break;
                 }
         }
         assert(argc - i <= 1);    /* at most one file on command line */
+        Codecopts_set(options);
         if (i < argc) {
                 FILE *fp = fopen(argv[i], "r");
                 assert(fp != NULL);
@@ -55,6 +110,77 @@ int main(int argc, char *argv[])
         } else {
                 compress_or_decompress(stdin);
         }
+        if (pool_stats) {
+                print_pool_stats();
+        }
 
         return EXIT_SUCCESS; 
 }
+
+/**********convert40********
+ *
+ * Rewrites a compressed image in the container the options ask for
+ * Inputs:
+ *              FILE *input: the compressed image, in either container
+ * Return: N/A
+ * Expects:
+ *      * input to be nonnull
+ * Notes:
+ *      * the image goes to the file named by -o instead of standard output
+ *        if there is one (see codecopts.h)
+ ************************/
+static void convert40(FILE *input)
+{
+        struct Codec_options options = Codecopts_get();
+
+        convert_compressed_file(input, options.native ? COMPRESSED_NATIVE
+                                                      : COMPRESSED_TEXT,
+                                options.output);
+        Pool_reset();
+}
+
+/**********force_kernels********
+ *
+ * Makes the codec use the named level of kernels, or exits with an error
+ * Inputs:
+ *              const char *program: the name of the program, for the error
+ *              const char *name: the name of the level, from --kernel=
+ * Return: N/A
+ * Expects:
+ *      * to be called before any image is read
+ * Notes:
+ *      * exits with status 1 if name isn't a level or this CPU can't run it
+ ************************/
+static void force_kernels(const char *program, const char *name)
+{
+        Kernel_level level;
+
+        if (!Kernels_parse(name, &level)) {
+                fprintf(stderr, "%s: unknown kernel level '%s'\n", program,
+                        name);
+                exit(1);
+        }
+        if (!Kernels_force(level)) {
+                fprintf(stderr, "%s: can't run the %s kernels on this CPU\n",
+                        program, name);
+                exit(1);
+        }
+}
+
+/**********print_pool_stats********
+ *
+ * Prints the statistics of the buffer pool to standard error
+ * Inputs: N/A
+ * Return: N/A
+ * Expects:
+ *      N/A
+ ************************/
+static void print_pool_stats(void)
+{
+        struct Pool_stats stats = Pool_stats();
+
+        fprintf(stderr, "pool: %zu images, %zu allocations, %zu reused, "
+                "high water %zu bytes, %zu bytes cached\n", stats.images,
+                stats.allocations, stats.reused, stats.high_water,
+                stats.cached);
+}
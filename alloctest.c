@@ -0,0 +1,261 @@
+/********************************************************************
+ *
+ *                          alloctest.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Allocation-counting regression test, run by make check
+ *
+ *     Summary:
+ *      alloctest runs the per-element functions of the UArray2b reference
+ *      path over a small image, encoding and then decoding it, and fails if
+ *      any of them calls malloc, calloc, realloc or free. The per-image
+ *      arrays are made before counting starts, so only allocations made
+ *      for a pixel or a block are counted.
+ *
+ *     Notes:
+ *   - 40image only runs the planar and table paths, so nothing else
+ *     reaches onePixelToComponentVideo, onePixelToRGB, compress_one_block,
+ *     decompress_one_block, decompress_planes_block, unpacked_floats or
+ *     CVS_populator
+ *   - The allocator is wrapped at link time with ld's --wrap (see the
+ *     Makefile), so every call to it from an object linked into the test
+ *     lands in the __wrap_ functions here first
+ *   - This module uses functions from these other modules: rgbcomponent.h,
+ *     compress2x2.h, quantization.h, cvsplanes.h, uarray2b.h and
+ *     a2blocked.h
+ *******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "assert.h"
+#include "pnm.h"
+#include "a2methods.h"
+#include "a2blocked.h"
+#include "uarray2b.h"
+#include "cvsplanes.h"
+#include "codewords.h"
+#include "rgbview.h"
+#include "ppmwriter.h"
+#include "wordview.h"
+#include "decodetables.h"
+#include "quantization.h"
+#include "rgbcomponent.h"
+#include "compress2x2.h"
+
+/* the size of the test image, an odd number of 2x2 blocks each way */
+#define TEST_WIDTH 22
+#define TEST_HEIGHT 14
+#define DENOMINATOR 255
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+/* whether calls to the allocator are being counted, and how many there
+   have been, volatile since the compiler takes malloc not to touch them */
+static volatile bool counting = false;
+static volatile size_t allocations = 0;
+
+static bool expect_none(const char *what);
+static Pnm_ppm test_image(A2Methods_T methods);
+
+/**********__wrap_malloc********
+ *
+ * Stands in for malloc, counting the call while counting is on
+ * Inputs and Return: the same as malloc
+ ************************/
+void *__wrap_malloc(size_t size)
+{
+        if (counting) {
+                allocations++;
+        }
+        return __real_malloc(size);
+}
+
+/**********__wrap_calloc********
+ *
+ * Stands in for calloc, counting the call while counting is on
+ * Inputs and Return: the same as calloc
+ ************************/
+void *__wrap_calloc(size_t count, size_t size)
+{
+        if (counting) {
+                allocations++;
+        }
+        return __real_calloc(count, size);
+}
+
+/**********__wrap_realloc********
+ *
+ * Stands in for realloc, counting the call while counting is on
+ * Inputs and Return: the same as realloc
+ ************************/
+void *__wrap_realloc(void *ptr, size_t size)
+{
+        if (counting) {
+                allocations++;
+        }
+        return __real_realloc(ptr, size);
+}
+
+/**********__wrap_free********
+ *
+ * Stands in for free, counting the call while counting is on
+ * Inputs: the same as free
+ * Return: N/A
+ ************************/
+void __wrap_free(void *ptr)
+{
+        if (counting) {
+                allocations++;
+        }
+        __real_free(ptr);
+}
+
+int main(void)
+{
+        A2Methods_T methods = uarray2_methods_blocked;
+        assert(methods != NULL);
+        bool passed = true;
+
+        /* the counter has to see an allocation, or every check passes */
+        counting = true;
+        void *volatile probe = malloc(1);
+        free(probe);
+        counting = false;
+        if (allocations != 2) {
+                fprintf(stderr, "alloctest: the allocator isn't wrapped\n");
+                return EXIT_FAILURE;
+        }
+        allocations = 0;
+
+        Pnm_ppm image = test_image(methods);
+        UArray2b_T component_video = UArray2b_new(TEST_WIDTH, TEST_HEIGHT,
+                                                  sizeof(struct CVS), 2);
+        counting = true;
+        UArray2b_map(component_video, onePixelToComponentVideo, &image);
+        passed = expect_none("onePixelToComponentVideo") && passed;
+
+        UArray2b_T compressed_blocks = UArray2b_new(TEST_WIDTH / 2,
+                                                    TEST_HEIGHT / 2,
+                                                    sizeof(uint64_t), 1);
+        counting = true;
+        for (int row = 0; row < TEST_HEIGHT; row += 2) {
+                for (int col = 0; col < TEST_WIDTH; col += 2) {
+                        *(uint64_t *)UArray2b_at(compressed_blocks, col / 2,
+                                                 row / 2) =
+                                compress_one_block(component_video, col,
+                                                   row);
+                }
+        }
+        passed = expect_none("compress_one_block") && passed;
+
+        UArray2b_T decoded_video = UArray2b_new(TEST_WIDTH, TEST_HEIGHT,
+                                                sizeof(struct CVS), 1);
+        counting = true;
+        UArray2b_map(compressed_blocks, decompress_one_block, decoded_video);
+        passed = expect_none("decompress_one_block") && passed;
+
+        CVS_planes planes = CVS_planes_new(TEST_WIDTH, TEST_HEIGHT);
+        counting = true;
+        for (int row = 0; row < TEST_HEIGHT / 2; row++) {
+                for (int col = 0; col < TEST_WIDTH / 2; col++) {
+                        uint64_t word = *(uint64_t *)UArray2b_at(
+                                        compressed_blocks, col, row);
+                        decompress_planes_block(planes, col, row,
+                                                (uint32_t)word);
+                        struct block_values values = unpacked_floats(word);
+                        struct CVS pixel = CVS_populator(values.a,
+                                                         values.pbavg,
+                                                         values.pravg);
+                        (void)pixel;
+                }
+        }
+        passed = expect_none("decompress_planes_block, unpacked_floats "
+                             "and CVS_populator") && passed;
+
+        struct Pnm_ppm decoded_image = { TEST_WIDTH, TEST_HEIGHT,
+                                         DENOMINATOR,
+                                         methods->new(TEST_WIDTH,
+                                                      TEST_HEIGHT,
+                                                      sizeof(struct Pnm_rgb)),
+                                         methods };
+        counting = true;
+        UArray2b_map(decoded_video, onePixelToRGB, &decoded_image);
+        passed = expect_none("onePixelToRGB") && passed;
+
+        methods->free(&decoded_image.pixels);
+        CVS_planes_free(&planes);
+        UArray2b_free(&decoded_video);
+        UArray2b_free(&compressed_blocks);
+        UArray2b_free(&component_video);
+        Pnm_ppmfree(&image);
+
+        if (!passed) {
+                return EXIT_FAILURE;
+        }
+        printf("alloctest: no per-element allocations\n");
+        return EXIT_SUCCESS;
+}
+
+/**********expect_none********
+ *
+ * Stops counting, and reports the allocations made since counting started
+ * Inputs:
+ *              const char *what: the functions that were counted
+ * Return: true if there were none
+ * Notes:
+ *      * resets the count for the next check
+ ************************/
+static bool expect_none(const char *what)
+{
+        counting = false;
+        size_t made = allocations;
+        allocations = 0;
+
+        if (made != 0) {
+                fprintf(stderr, "alloctest: %s made %zu allocator calls\n",
+                        what, made);
+                return false;
+        }
+        return true;
+}
+
+/**********test_image********
+ *
+ * Makes a TEST_WIDTH by TEST_HEIGHT image with a different color at every
+ * pixel
+ * Inputs:
+ *              A2Methods_T methods: the methods of the pixel array
+ * Return: the image, which the caller frees with Pnm_ppmfree
+ * Expects:
+ *      * methods to be nonnull
+ ************************/
+static Pnm_ppm test_image(A2Methods_T methods)
+{
+        assert(methods != NULL);
+        Pnm_ppm image = malloc(sizeof(*image));
+        assert(image != NULL);
+
+        image->width = TEST_WIDTH;
+        image->height = TEST_HEIGHT;
+        image->denominator = DENOMINATOR;
+        image->pixels = methods->new(TEST_WIDTH, TEST_HEIGHT,
+                                     sizeof(struct Pnm_rgb));
+        image->methods = methods;
+
+        for (int row = 0; row < TEST_HEIGHT; row++) {
+                for (int col = 0; col < TEST_WIDTH; col++) {
+                        Pnm_rgb pixel = methods->at(image->pixels, col, row);
+                        pixel->red = (col * 11) % (DENOMINATOR + 1);
+                        pixel->green = (row * 17) % (DENOMINATOR + 1);
+                        pixel->blue = (col * row * 5) % (DENOMINATOR + 1);
+                }
+        }
+        return image;
+}
@@ -0,0 +1,160 @@
+/********************************************************************
+ *
+ *                          bands.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for bands.h
+ *
+ *     Summary:
+ *      bands runs the bands of a job on POSIX threads, with the first band
+ *      on the calling thread.
+ *
+ *     Notes:
+ *   - There is one band per online CPU, up to MAX_BANDS, but never so many
+ *     that a band has fewer than min_rows rows, so a small image is done
+ *     on the calling thread alone
+ *   - The first row is done on the calling thread before any other thread
+ *     starts, so lazy one-time choices the work makes, like the kernels of
+ *     kernels.h and the tables of decodetables.h, are made on one thread
+ *   - The bands of the other rows are as even as they can be, and nothing
+ *     is shared between them but the closure, which the work must only
+ *     read
+ *   - If a thread can't be started, its band is done on the calling thread
+ *     instead, so the work is always done
+ *   - Each thread gives its pool.h blocks back with Pool_release before it
+ *     exits
+ *   - This module uses functions from pool.h
+ *******************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "assert.h"
+#include "pool.h"
+#include "bands.h"
+
+#define MAX_BANDS 64
+
+/*
+ * This is the struct definition of a band
+ * Elements:
+ *      Bands_work *work: the work to do
+ *      void *closure: what the work is given
+ *      int first: the first row of the band
+ *      int last: one past the last row of the band
+ *      pthread_t thread: the thread doing the band
+ *      bool started: true if the thread was started
+ *
+ */
+struct band {
+        Bands_work *work;
+        void *closure;
+        int first;
+        int last;
+        pthread_t thread;
+        bool started;
+};
+
+static int band_count(int count, int min_rows);
+static void *run_band(void *band);
+
+/**********Bands_run********
+ *
+ * Does a job in bands of rows, one thread per band
+ * Inputs:
+ *              int count: the number of rows
+ *              int min_rows: the fewest rows worth a thread of their own
+ *              Bands_work *work: the work of one band
+ *              void *closure: passed to every call of work
+ * Return: N/A
+ * Expects:
+ *      * work to be nonnull
+ *      * count to be nonnegative and min_rows positive
+ *      * the bands to be independent, and to write disjoint memory
+ * Notes:
+ *      * work is called for every row exactly once: for row 0 alone, and
+ *        then for bands of the other rows that may run at the same time;
+ *        it returns when every band is done
+ *      * checked runtime error if work is NULL or count or min_rows is out
+ *        of range
+ ************************/
+void Bands_run(int count, int min_rows, Bands_work *work, void *closure)
+{
+        assert(work != NULL);
+        assert(count >= 0 && min_rows > 0);
+        if (count == 0) {
+                return;
+        }
+        work(closure, 0, 1);
+
+        int rest = count - 1;
+        int bands = band_count(rest, min_rows);
+        struct band band[MAX_BANDS];
+
+        for (int i = 0; i < bands; i++) {
+                band[i].work = work;
+                band[i].closure = closure;
+                band[i].first = 1 + (int)((long long)rest * i / bands);
+                band[i].last = 1 + (int)((long long)rest * (i + 1) / bands);
+                band[i].started = i > 0 && pthread_create(&band[i].thread,
+                                                          NULL, run_band,
+                                                          &band[i]) == 0;
+        }
+
+        work(closure, band[0].first, band[0].last);
+        for (int i = 1; i < bands; i++) {
+                if (band[i].started) {
+                        pthread_join(band[i].thread, NULL);
+                } else {
+                        work(closure, band[i].first, band[i].last);
+                }
+        }
+}
+
+/**********band_count********
+ *
+ * Picks how many bands a job is split into
+ * Inputs:
+ *              int count: the number of rows
+ *              int min_rows: the fewest rows a band may have
+ * Return: the number of bands, between 1 and MAX_BANDS
+ * Expects:
+ *      * count to be nonnegative and min_rows positive
+ ************************/
+static int band_count(int count, int min_rows)
+{
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int bands = count / min_rows;
+
+        if (cpus > 0 && bands > cpus) {
+                bands = (int)cpus;
+        }
+        if (bands > MAX_BANDS) {
+                bands = MAX_BANDS;
+        }
+        return bands > 0 ? bands : 1;
+}
+
+/**********run_band********
+ *
+ * Does the work of one band on its own thread
+ * Inputs:
+ *              void *band: the struct band
+ * Return: NULL
+ * Expects:
+ *      * band to be nonnull
+ ************************/
+static void *run_band(void *band)
+{
+        struct band *mine = band;
+
+        mine->work(mine->closure, mine->first, mine->last);
+        Pool_release();
+        return NULL;
+}
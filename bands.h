@@ -0,0 +1,26 @@
+/********************************************************************
+ *
+ *                          bands.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for bands.c
+ *
+ *     Summary:
+ *      bands splits a run of rows into one band per CPU and does the work
+ *      of every band on its own thread, for work whose bands don't depend
+ *      on each other and write to disjoint memory, like rows of an output
+ *      file that is already mapped. It returns when every band is done.
+ *
+ *******************************************************************/
+#ifndef BANDS_INCLUDED
+#define BANDS_INCLUDED
+
+/* the work of one band: rows first to last - 1 */
+typedef void Bands_work(void *closure, int first, int last);
+
+void Bands_run(int count, int min_rows, Bands_work *work, void *closure);
+
+#endif
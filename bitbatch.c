@@ -0,0 +1,579 @@
+/********************************************************************
+ *
+ *                          bitbatch.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for bitbatch.h
+ *
+ *     Summary:
+ *      bitbatch packs and unpacks whole arrays of 32-bit words at once,
+ *      where bitpack.h works on one field of one word. A layout describes up
+ *      to 8 fields of up to 8 bits each, and each field of the words is kept
+ *      in its own array of bytes. It uses the BMI2 instructions PDEP and
+ *      PEXT when the CPU has them, and shifts and masks otherwise, and it can
+ *      also pull one field out of every word with AVX2.
+ *
+ *     Notes:
+ *   - With BMI2, the fields of a word are moved between the word and the 8
+ *     bytes of a 64-bit "lane" value, one field per byte in order of lsb,
+ *     with one PEXT and one PDEP. Signed fields are sign extended, and
+ *     checked, in all 8 bytes at once with carry-free byte arithmetic
+ *   - PDEP and PEXT are slow on AMD CPUs before Zen 3, where the
+ *     shift and mask version is the faster one
+ *   - Like Bitpack_newu and Bitpack_news, packing raises Bitpack_Overflow
+ *     if a value doesn't fit in its field. Every version gives the same
+ *     words and fields
+ *   - This module uses the Bitpack_Overflow exception from bitpack.h, and
+ *     kernels.h to pick the version
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "assert.h"
+#include "except.h"
+#include "bitpack.h"
+#include "kernels.h"
+#include "bitbatch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+/* _pdep_u64 and _pext_u64 only exist in 64-bit mode */
+#if X86_KERNELS && defined(__x86_64__)
+#define BMI2_KERNELS 1
+#else
+#define BMI2_KERNELS 0
+#endif
+
+#define WORD_BITS 32
+#define LANE_BITS 8
+#define INTS_PER_STEP 8
+#define INTS_PER_WIDE_STEP 16
+
+/* the low 7 bits and the high bit of every byte of a lane value */
+#define LOW_BITS 0x7f7f7f7f7f7f7f7fULL
+#define HIGH_BITS 0x8080808080808080ULL
+
+/*
+ * This is the struct definition of a plan, which is a layout worked out
+ * once per call for the functions that do the packing
+ * Elements:
+ *      unsigned count: the number of fields
+ *      unsigned lanes[]: the index in the layout of the field in each byte
+ *                        of a lane value, by increasing lsb
+ *      uint32_t mask: every bit of every field of a word
+ *      uint64_t spread: the low width bits of each byte of a lane value
+ *      uint64_t bias: the sign bit of each signed field's byte
+ *      struct Bitbatch_field fields[]: the fields, in lane order
+ *
+ */
+struct plan {
+        unsigned count;
+        unsigned lanes[BITBATCH_MAX_FIELDS];
+        uint32_t mask;
+        uint64_t spread;
+        uint64_t bias;
+        struct Bitbatch_field fields[BITBATCH_MAX_FIELDS];
+};
+
+typedef void pack_fun(const struct plan *plan, const int8_t *const fields[],
+                      size_t count, uint32_t *words);
+typedef void unpack_fun(const struct plan *plan, const uint32_t *words,
+                        size_t count, int8_t *const fields[]);
+typedef void field_fun(struct Bitbatch_field field, const uint32_t *words,
+                       size_t count, int32_t *values);
+
+static pack_fun pack_scalar;
+static unpack_fun unpack_scalar;
+static field_fun field_scalar;
+static pack_fun *pack_best(void);
+static unpack_fun *unpack_best(void);
+static field_fun *field_best(void);
+
+static struct plan plan_of(const struct Bitbatch_layout *layout);
+static uint32_t field_mask(unsigned width);
+static int8_t signed_byte(uint8_t byte);
+
+/**********Bitbatch_pack********
+ *
+ * Packs arrays of field values into an array of 32-bit words
+ * Inputs:
+ *              const struct Bitbatch_layout *layout: the fields of a word
+ *              const int8_t *const fields[]: one array of count values for
+ *                                            each field of the layout, in
+ *                                            the layout's order
+ *              size_t count: the number of words
+ *              uint32_t *words: where the count words are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * the layout to be valid (see bitbatch.h)
+ *      * every value to fit in its field
+ * Notes:
+ *      * bits of a word that aren't in any field are 0
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * the layout isn't valid
+ *      * raises Bitpack_Overflow if a value doesn't fit in its field
+ ************************/
+void Bitbatch_pack(const struct Bitbatch_layout *layout,
+                   const int8_t *const fields[], size_t count,
+                   uint32_t *words)
+{
+        assert(layout != NULL && fields != NULL && words != NULL);
+        struct plan plan = plan_of(layout);
+        for (unsigned i = 0; i < plan.count; i++) {
+                assert(fields[i] != NULL);
+        }
+
+        static pack_fun *best = NULL;
+        if (best == NULL) {
+                best = pack_best();
+        }
+        best(&plan, fields, count, words);
+}
+
+/**********Bitbatch_unpack********
+ *
+ * Unpacks an array of 32-bit words into arrays of field values
+ * Inputs:
+ *              const struct Bitbatch_layout *layout: the fields of a word
+ *              const uint32_t *words: the count words
+ *              size_t count: the number of words
+ *              int8_t *const fields[]: one array of count values for each
+ *                                      field of the layout, in the layout's
+ *                                      order, where the values are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * the layout to be valid (see bitbatch.h)
+ * Notes:
+ *      * signed fields are sign extended
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * the layout isn't valid
+ ************************/
+void Bitbatch_unpack(const struct Bitbatch_layout *layout,
+                     const uint32_t *words, size_t count,
+                     int8_t *const fields[])
+{
+        assert(layout != NULL && words != NULL && fields != NULL);
+        struct plan plan = plan_of(layout);
+        for (unsigned i = 0; i < plan.count; i++) {
+                assert(fields[i] != NULL);
+        }
+
+        static unpack_fun *best = NULL;
+        if (best == NULL) {
+                best = unpack_best();
+        }
+        best(&plan, words, count, fields);
+}
+
+/**********Bitbatch_field********
+ *
+ * Pulls one field out of every word of an array, for decoders that work on
+ * 32-bit lanes
+ * Inputs:
+ *              struct Bitbatch_field field: the field, which may be up to 31
+ *                                           bits wide here
+ *              const uint32_t *words: the count words
+ *              size_t count: the number of words
+ *              int32_t *values: where the count values are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * the field to fit in 32 bits
+ * Notes:
+ *      * a signed field is sign extended
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * the field's width is 0 or over 31, or it doesn't fit in 32
+ *                bits
+ ************************/
+void Bitbatch_field(struct Bitbatch_field field, const uint32_t *words,
+                    size_t count, int32_t *values)
+{
+        assert(words != NULL && values != NULL);
+        assert(field.width > 0 && field.width < WORD_BITS);
+        assert(field.lsb + field.width <= WORD_BITS);
+
+        static field_fun *best = NULL;
+        if (best == NULL) {
+                best = field_best();
+        }
+        best(field, words, count, values);
+}
+
+/**********pack_scalar********
+ *
+ * Shift and mask version of Bitbatch_pack
+ * Inputs:
+ *              const struct plan *plan: the plan of the layout
+ *              the rest: same as Bitbatch_pack
+ * Return: N/A
+ * Expects:
+ *      * plan to be nonnull
+ ************************/
+static void pack_scalar(const struct plan *plan, const int8_t *const fields[],
+                        size_t count, uint32_t *words)
+{
+        for (size_t k = 0; k < count; k++) {
+                uint32_t word = 0;
+                for (unsigned i = 0; i < plan->count; i++) {
+                        struct Bitbatch_field field = plan->fields[i];
+                        uint32_t mask = field_mask(field.width);
+                        uint8_t value = fields[plan->lanes[i]][k];
+                        uint8_t bias = field.is_signed ?
+                                        1u << (field.width - 1) : 0;
+
+                        /* a signed value fits if adding bias makes it fit */
+                        if (((uint8_t)(value + bias) & ~mask) != 0) {
+                                RAISE(Bitpack_Overflow);
+                        }
+                        word |= (value & mask) << field.lsb;
+                }
+                words[k] = word;
+        }
+}
+
+/**********unpack_scalar********
+ *
+ * Shift and mask version of Bitbatch_unpack
+ * Inputs:
+ *              const struct plan *plan: the plan of the layout
+ *              the rest: same as Bitbatch_unpack
+ * Return: N/A
+ * Expects:
+ *      * plan to be nonnull
+ ************************/
+static void unpack_scalar(const struct plan *plan, const uint32_t *words,
+                          size_t count, int8_t *const fields[])
+{
+        for (size_t k = 0; k < count; k++) {
+                for (unsigned i = 0; i < plan->count; i++) {
+                        struct Bitbatch_field field = plan->fields[i];
+                        int32_t value = (words[k] >> field.lsb) &
+                                        field_mask(field.width);
+                        if (field.is_signed) {
+                                int32_t sign = 1 << (field.width - 1);
+                                value = (value ^ sign) - sign;
+                        }
+                        fields[plan->lanes[i]][k] = value;
+                }
+        }
+}
+
+/**********field_scalar********
+ *
+ * Scalar version of Bitbatch_field, also used by the AVX2 version for the
+ * words left over after the last full step
+ * Inputs and Expects: same as Bitbatch_field
+ * Return: N/A
+ ************************/
+static void field_scalar(struct Bitbatch_field field, const uint32_t *words,
+                         size_t count, int32_t *values)
+{
+        uint32_t mask = field_mask(field.width);
+        int32_t sign = field.is_signed ? 1 << (field.width - 1) : 0;
+
+        for (size_t k = 0; k < count; k++) {
+                int32_t value = (words[k] >> field.lsb) & mask;
+                values[k] = (value ^ sign) - sign;
+        }
+}
+
+#if BMI2_KERNELS
+
+/**********pack_bmi2********
+ *
+ * BMI2 version of Bitbatch_pack
+ * Inputs and Expects: same as pack_scalar
+ * Return: N/A
+ * Notes:
+ *      * the bytes of the fields are gathered into a lane value, checked
+ *        all at once, squeezed together with PEXT and spread over the word
+ *        with PDEP
+ ************************/
+__attribute__((target("bmi2")))
+static void pack_bmi2(const struct plan *plan, const int8_t *const fields[],
+                      size_t count, uint32_t *words)
+{
+        for (size_t k = 0; k < count; k++) {
+                uint64_t bytes = 0;
+                for (unsigned i = 0; i < plan->count; i++) {
+                        bytes |= (uint64_t)(uint8_t)fields[plan->lanes[i]][k]
+                                                        << (i * LANE_BITS);
+                }
+
+                /* adds bias to every byte without carries between bytes */
+                uint64_t biased = ((bytes & LOW_BITS) + plan->bias) ^
+                                  (bytes & HIGH_BITS);
+                if ((biased & ~plan->spread) != 0) {
+                        RAISE(Bitpack_Overflow);
+                }
+                words[k] = (uint32_t)_pdep_u64(_pext_u64(bytes, plan->spread),
+                                               plan->mask);
+        }
+}
+
+/**********unpack_bmi2********
+ *
+ * BMI2 version of Bitbatch_unpack
+ * Inputs and Expects: same as unpack_scalar
+ * Return: N/A
+ * Notes:
+ *      * the fields are squeezed together with PEXT and spread one per byte
+ *        with PDEP, and every signed byte is sign extended at once
+ ************************/
+__attribute__((target("bmi2")))
+static void unpack_bmi2(const struct plan *plan, const uint32_t *words,
+                        size_t count, int8_t *const fields[])
+{
+        for (size_t k = 0; k < count; k++) {
+                uint64_t bytes = _pdep_u64(_pext_u64(words[k], plan->mask),
+                                           plan->spread);
+
+                /* (bytes ^ bias) - bias in every byte, without borrows */
+                uint64_t flipped = bytes ^ plan->bias;
+                uint64_t extended = ((flipped | HIGH_BITS) -
+                                     (plan->bias & LOW_BITS)) ^
+                                    ((flipped ^ ~plan->bias) & HIGH_BITS);
+
+                for (unsigned i = 0; i < plan->count; i++) {
+                        fields[plan->lanes[i]][k] =
+                                signed_byte(extended >> (i * LANE_BITS));
+                }
+        }
+}
+
+#endif
+
+#if X86_KERNELS
+
+/**********field_avx2********
+ *
+ * AVX2 version of Bitbatch_field, which does 8 words per step
+ * Inputs and Expects: same as Bitbatch_field
+ * Return: N/A
+ * Notes:
+ *      * a signed field is moved to the top of the lane and shifted back
+ *        down arithmetically, which sign extends it
+ ************************/
+__attribute__((target("avx2")))
+static void field_avx2(struct Bitbatch_field field, const uint32_t *words,
+                       size_t count, int32_t *values)
+{
+        unsigned top = WORD_BITS - field.width;
+        const __m128i down = _mm_cvtsi32_si128(field.lsb);
+        const __m128i up = _mm_cvtsi32_si128(top);
+        const __m256i mask = _mm256_set1_epi32(field_mask(field.width));
+        size_t k = 0;
+
+        for (; k + INTS_PER_STEP <= count; k += INTS_PER_STEP) {
+                __m256i value = _mm256_srl_epi32(
+                        _mm256_loadu_si256((const __m256i *)(words + k)),
+                                                 down);
+                if (field.is_signed) {
+                        value = _mm256_sra_epi32(_mm256_sll_epi32(value, up),
+                                                 up);
+                } else {
+                        value = _mm256_and_si256(value, mask);
+                }
+                _mm256_storeu_si256((__m256i *)(values + k), value);
+        }
+        field_scalar(field, words + k, count - k, values + k);
+}
+
+/**********field_avx512********
+ *
+ * AVX-512 version of Bitbatch_field, which does 16 words per step
+ * Inputs and Expects: same as Bitbatch_field
+ * Return: N/A
+ * Notes:
+ *      * works the same way as field_avx2
+ ************************/
+__attribute__((target("avx512f")))
+static void field_avx512(struct Bitbatch_field field, const uint32_t *words,
+                         size_t count, int32_t *values)
+{
+        unsigned top = WORD_BITS - field.width;
+        const __m128i down = _mm_cvtsi32_si128(field.lsb);
+        const __m128i up = _mm_cvtsi32_si128(top);
+        const __m512i mask = _mm512_set1_epi32(field_mask(field.width));
+        size_t k = 0;
+
+        for (; k + INTS_PER_WIDE_STEP <= count; k += INTS_PER_WIDE_STEP) {
+                __m512i value = _mm512_srl_epi32(
+                        _mm512_loadu_si512((const void *)(words + k)), down);
+                if (field.is_signed) {
+                        value = _mm512_sra_epi32(_mm512_sll_epi32(value, up),
+                                                 up);
+                } else {
+                        value = _mm512_and_si512(value, mask);
+                }
+                _mm512_storeu_si512((void *)(values + k), value);
+        }
+        field_avx2(field, words + k, count - k, values + k);
+}
+
+#endif
+
+/**********pack_best********
+ *
+ * Picks the fastest version of Bitbatch_pack at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the BMI2 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static pack_fun *pack_best(void)
+{
+#if BMI2_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return pack_bmi2;
+        }
+#endif
+        return pack_scalar;
+}
+
+/**********unpack_best********
+ *
+ * Picks the fastest version of Bitbatch_unpack at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the BMI2 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static unpack_fun *unpack_best(void)
+{
+#if BMI2_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return unpack_bmi2;
+        }
+#endif
+        return unpack_scalar;
+}
+
+/**********field_best********
+ *
+ * Picks the fastest version of Bitbatch_field at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX-512, AVX2 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static field_fun *field_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX512) {
+                return field_avx512;
+        }
+        if (level >= KERNEL_AVX2) {
+                return field_avx2;
+        }
+#endif
+        return field_scalar;
+}
+
+/**********plan_of********
+ *
+ * Checks a layout and works out its plan
+ * Inputs:
+ *              const struct Bitbatch_layout *layout: the layout
+ * Return: the plan, with the fields in order of increasing lsb
+ * Expects:
+ *      * layout to be nonnull
+ * Notes:
+ *      * checked runtime error if:
+ *              * the layout has more than BITBATCH_MAX_FIELDS fields
+ *              * a field is empty, wider than an int8_t can hold, or
+ *                doesn't fit in 32 bits
+ *              * two fields overlap
+ ************************/
+static struct plan plan_of(const struct Bitbatch_layout *layout)
+{
+        assert(layout->count <= BITBATCH_MAX_FIELDS);
+
+        struct plan plan;
+        memset(&plan, 0, sizeof(plan));
+        plan.count = layout->count;
+
+        /* insertion sort of the field indices by lsb */
+        for (unsigned i = 0; i < layout->count; i++) {
+                struct Bitbatch_field field = layout->fields[i];
+                unsigned limit = field.is_signed ? BITBATCH_MAX_WIDTH
+                                                 : BITBATCH_MAX_WIDTH - 1;
+                assert(field.width > 0 && field.width <= limit);
+                assert(field.lsb + field.width <= WORD_BITS);
+
+                uint32_t bits = field_mask(field.width) << field.lsb;
+                assert((plan.mask & bits) == 0);
+                plan.mask |= bits;
+
+                unsigned j = i;
+                while (j > 0 && layout->fields[plan.lanes[j - 1]].lsb >
+                                                                field.lsb) {
+                        plan.lanes[j] = plan.lanes[j - 1];
+                        j--;
+                }
+                plan.lanes[j] = i;
+        }
+
+        for (unsigned i = 0; i < plan.count; i++) {
+                struct Bitbatch_field field = layout->fields[plan.lanes[i]];
+                plan.fields[i] = field;
+                plan.spread |= (uint64_t)field_mask(field.width) <<
+                                                        (i * LANE_BITS);
+                if (field.is_signed) {
+                        plan.bias |= (uint64_t)1 << (i * LANE_BITS +
+                                                     field.width - 1);
+                }
+        }
+        return plan;
+}
+
+/**********field_mask********
+ *
+ * Returns the mask of the low bits of a field
+ * Inputs:
+ *              unsigned width: the width of the field, below 32
+ * Return: a word with the low width bits set
+ * Expects:
+ *      * width to be below 32
+ ************************/
+static uint32_t field_mask(unsigned width)
+{
+        return ((uint32_t)1 << width) - 1;
+}
+
+/**********signed_byte********
+ *
+ * Reinterprets a byte as two's complement
+ * Inputs:
+ *              uint8_t byte: the byte
+ * Return: the byte's value as an int8_t
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * avoids converting an out of range value to a signed type, which
+ *        isn't defined the same way by every compiler
+ ************************/
+static int8_t signed_byte(uint8_t byte)
+{
+        return byte < 128 ? byte : byte - 256;
+}
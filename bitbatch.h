@@ -0,0 +1,82 @@
+/********************************************************************
+ *
+ *                          bitbatch.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for bitbatch.c
+ *
+ *     Summary:
+ *      bitbatch packs and unpacks whole arrays of 32-bit words at once,
+ *      where bitpack.h works on one field of one word. A layout describes up
+ *      to 8 fields of up to 8 bits each, and each field of the words is kept
+ *      in its own array of bytes. It uses the BMI2 instructions PDEP and
+ *      PEXT when the CPU has them, and shifts and masks otherwise, and it can
+ *      also pull one field out of every word with AVX2 or AVX-512. bitpack.h
+ *      is the interface given by the course and can't change, so the batch
+ *      functions are here.
+ *
+ *******************************************************************/
+#ifndef BITBATCH_INCLUDED
+#define BITBATCH_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* the most fields a layout can have, and the widest field */
+#define BITBATCH_MAX_FIELDS 8
+#define BITBATCH_MAX_WIDTH 8
+
+/*
+ * This is the struct definition of the Bitbatch_field instance
+ * Elements:
+ *      unsigned width: the number of bits in the field, from 1 to 8, or to 7
+ *                      for an unsigned field, so its values fit in an int8_t
+ *      unsigned lsb: the least significant bit of the field
+ *      bool is_signed: true if the field holds two's complement values
+ *
+ */
+struct Bitbatch_field {
+        unsigned width;
+        unsigned lsb;
+        bool is_signed;
+};
+
+/*
+ * This is the struct definition of the Bitbatch_layout instance
+ * Elements:
+ *      unsigned count: the number of fields
+ *      struct Bitbatch_field fields[]: the fields, in any order, which must
+ *                                      fit in 32 bits and not overlap
+ *
+ */
+struct Bitbatch_layout {
+        unsigned count;
+        struct Bitbatch_field fields[BITBATCH_MAX_FIELDS];
+};
+
+/*
+ * builds the initializer of a Bitbatch_layout from a layout list for
+ * bitfields.h, such as CODEWORD_FIELD_LIST in quantization.h
+ */
+#define BITBATCH_COUNT(field, kind, width, lsb, unused) + 1
+#define BITBATCH_FIELD(field, kind, width, lsb, unused) \
+        { (width), (lsb), BITBATCH_SIGNED_##kind },
+#define BITBATCH_SIGNED_unsigned false
+#define BITBATCH_SIGNED_signed true
+#define BITBATCH_LAYOUT_OF(LIST) \
+        { 0 LIST(BITBATCH_COUNT, 0), { LIST(BITBATCH_FIELD, 0) } }
+
+void Bitbatch_pack(const struct Bitbatch_layout *layout,
+                   const int8_t *const fields[], size_t count,
+                   uint32_t *words);
+void Bitbatch_unpack(const struct Bitbatch_layout *layout,
+                     const uint32_t *words, size_t count,
+                     int8_t *const fields[]);
+void Bitbatch_field(struct Bitbatch_field field, const uint32_t *words,
+                    size_t count, int32_t *values);
+
+#endif
@@ -0,0 +1,172 @@
+/********************************************************************
+ *
+ *                          bitbatchtest.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Test of bitbatch.h against bitfields.h, run by make check
+ *
+ *     Summary:
+ *      bitbatchtest checks Bitbatch_unpack, Bitbatch_pack and
+ *      Bitbatch_field on the code word layout against Codeword_unpack and
+ *      Codeword_pack from quantization.h, at the kernel level named on its
+ *      command line. It uses pseudo-random words and several counts, so
+ *      that the vector loops and the scalar tails both run.
+ *
+ *     Notes:
+ *   - bitbatch.h picks its kernels once per process, so each level needs
+ *     its own run; make check runs every level in turn
+ *   - A level the CPU doesn't have is reported and skipped, not failed
+ *   - This module uses functions from these other modules: bitbatch.h,
+ *     kernels.h and quantization.h
+ *******************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "assert.h"
+#include "bitbatch.h"
+#include "kernels.h"
+#include "quantization.h"
+
+/* the most words checked at once, and the counts that are checked */
+#define MAX_WORDS 1037
+static const size_t counts[] = { 1, 3, 17, 64, 255, MAX_WORDS };
+#define COUNTS (sizeof(counts) / sizeof(counts[0]))
+
+/* the index of each field of a code word in the arrays of bitbatch.h */
+#define FIELD_INDEX(field, kind, width, lsb, unused) FIELD_##field,
+enum { CODEWORD_FIELD_LIST(FIELD_INDEX, 0) FIELD_COUNT };
+
+/* the array of one field, and a field of a struct Codeword_fields stored
+   at its index in an array */
+#define FIELD_ARRAY(field, kind, width, lsb, arrays) (arrays)[FIELD_##field],
+#define FIELD_VALUE(field, kind, width, lsb, values) \
+        (values)[FIELD_##field] = (int32_t)fields.field;
+
+static const struct Bitbatch_layout codeword_layout =
+                                BITBATCH_LAYOUT_OF(CODEWORD_FIELD_LIST);
+
+static bool check_count(size_t count, uint32_t *state);
+static uint32_t next_word(uint32_t *state);
+
+int main(int argc, char *argv[])
+{
+        Kernel_level level;
+        if (argc != 2 || !Kernels_parse(argv[1], &level)) {
+                fprintf(stderr, "Usage: %s scalar|sse|avx2|avx512\n",
+                        argv[0]);
+                return EXIT_FAILURE;
+        }
+        if (!Kernels_force(level)) {
+                printf("bitbatchtest: %s skipped, not on this CPU\n",
+                       argv[1]);
+                return EXIT_SUCCESS;
+        }
+
+        uint32_t state = 0x9e3779b9u;
+        bool passed = true;
+        for (size_t i = 0; i < COUNTS; i++) {
+                passed = check_count(counts[i], &state) && passed;
+        }
+
+        if (!passed) {
+                return EXIT_FAILURE;
+        }
+        printf("bitbatchtest: %s agrees with Codeword_pack and "
+               "Codeword_unpack\n", argv[1]);
+        return EXIT_SUCCESS;
+}
+
+/**********check_count********
+ *
+ * Checks unpacking, packing and single field extraction of count
+ * pseudo-random code words
+ * Inputs:
+ *              size_t count: the number of words, at most MAX_WORDS
+ *              uint32_t *state: the state of next_word
+ * Return: true if every result matched, after reporting each one that
+ *         didn't to standard error
+ * Expects:
+ *      * state to be nonnull
+ ************************/
+static bool check_count(size_t count, uint32_t *state)
+{
+        assert(state != NULL && count <= MAX_WORDS);
+        static uint32_t words[MAX_WORDS], packed[MAX_WORDS];
+        static int8_t unpacked[FIELD_COUNT][MAX_WORDS];
+        static int32_t values[MAX_WORDS];
+        int8_t *const arrays[FIELD_COUNT] = {
+                CODEWORD_FIELD_LIST(FIELD_ARRAY, unpacked)
+        };
+        size_t mismatches = 0;
+
+        for (size_t i = 0; i < count; i++) {
+                words[i] = next_word(state);
+        }
+
+        Bitbatch_unpack(&codeword_layout, words, count, arrays);
+        Bitbatch_pack(&codeword_layout, (const int8_t *const *)arrays, count,
+                      packed);
+        for (size_t i = 0; i < count; i++) {
+                struct Codeword_fields fields = Codeword_unpack(words[i]);
+                int32_t expected[FIELD_COUNT];
+                CODEWORD_FIELD_LIST(FIELD_VALUE, expected)
+
+                for (int field = 0; field < FIELD_COUNT; field++) {
+                        if (unpacked[field][i] != expected[field]) {
+                                fprintf(stderr, "bitbatchtest: unpack of "
+                                        "word %zu of %zu field %d gave %d, "
+                                        "not %d\n", i, count, field,
+                                        (int)unpacked[field][i],
+                                        (int)expected[field]);
+                                mismatches++;
+                        }
+                }
+                if (packed[i] != Codeword_pack(fields)) {
+                        fprintf(stderr, "bitbatchtest: pack of word %zu of "
+                                "%zu gave 0x%08x, not 0x%08x\n", i, count,
+                                (unsigned)packed[i],
+                                (unsigned)Codeword_pack(fields));
+                        mismatches++;
+                }
+        }
+
+        for (int field = 0; field < FIELD_COUNT; field++) {
+                Bitbatch_field(codeword_layout.fields[field], words, count,
+                               values);
+                for (size_t i = 0; i < count; i++) {
+                        if (values[i] != unpacked[field][i]) {
+                                fprintf(stderr, "bitbatchtest: field %d of "
+                                        "word %zu of %zu gave %d, not %d\n",
+                                        field, i, count, (int)values[i],
+                                        (int)unpacked[field][i]);
+                                mismatches++;
+                        }
+                }
+        }
+        return mismatches == 0;
+}
+
+/**********next_word********
+ *
+ * Gives the next word of a xorshift sequence
+ * Inputs:
+ *              uint32_t *state: the last word, which must not be 0
+ * Return: the next word, which is also stored in state
+ * Expects:
+ *      * state to be nonnull
+ ************************/
+static uint32_t next_word(uint32_t *state)
+{
+        assert(state != NULL);
+        uint32_t word = *state;
+
+        word ^= word << 13;
+        word ^= word >> 17;
+        word ^= word << 5;
+        *state = word;
+        return word;
+}
@@ -0,0 +1,108 @@
+/********************************************************************
+ *
+ *                          bitfields.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Header-only generator of inline bit-field packing functions
+ *
+ *     Summary:
+ *      bitfields turns a description of a 32-bit word layout that is known
+ *      at compile time into a struct with one member per field and inline
+ *      functions that check, pack and unpack all the fields of a word at
+ *      once. Since the widths and least significant bits are constants,
+ *      packing and unpacking compile down to a few shifts and masks, with
+ *      none of the calls and per-field checks of bitpack.h.
+ *
+ *     Usage:
+ *      A layout is a list macro that applies X to each field, in the style of
+ *      CHROMA_LEVEL_LIST in chroma.h:
+ *
+ *          #define PAIR_FIELD_LIST(X, arg) \
+ *                  X(high, unsigned, 4, 4, arg) \
+ *                  X(low, signed, 4, 0, arg)
+ *          BITFIELDS_LAYOUT(Pair, PAIR_FIELD_LIST)
+ *
+ *      Each field is its name, unsigned or signed, its width and its least
+ *      significant bit. This defines struct Pair_fields, with a uint32_t or
+ *      int32_t member per field, and:
+ *
+ *          bool Pair_fits(struct Pair_fields fields);
+ *          uint32_t Pair_pack(struct Pair_fields fields);
+ *          struct Pair_fields Pair_unpack(uint32_t word);
+ *
+ *     Notes:
+ *   - Pair_pack doesn't check its fields: a value that doesn't fit is cut
+ *     to its width. Callers that can't guarantee their values fit call
+ *     Pair_fits once per word first
+ *   - Widths must be from 1 to 31, and the fields must not overlap
+ *   - Signed fields are sign extended without shifting a negative value
+ *     right, which isn't defined the same way by every compiler
+ *******************************************************************/
+#ifndef BITFIELDS_INCLUDED
+#define BITFIELDS_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* the type of the struct member of a field */
+#define BITFIELDS_TYPE_unsigned uint32_t
+#define BITFIELDS_TYPE_signed int32_t
+
+/* the low width bits, and the sign bit of a signed field */
+#define BITFIELDS_MASK(width) ((((uint32_t)1) << (width)) - 1)
+#define BITFIELDS_SIGN(width) (((uint32_t)1) << ((width) - 1))
+
+/* whether a value is in the range of a field */
+#define BITFIELDS_FITS_unsigned(value, width) \
+        ((value) <= BITFIELDS_MASK(width))
+#define BITFIELDS_FITS_signed(value, width) \
+        ((value) >= -(int32_t)BITFIELDS_SIGN(width) && \
+         (value) < (int32_t)BITFIELDS_SIGN(width))
+
+/* reads a field out of a word */
+#define BITFIELDS_GET_unsigned(word, width, lsb) \
+        (((word) >> (lsb)) & BITFIELDS_MASK(width))
+#define BITFIELDS_GET_signed(word, width, lsb) \
+        ((int32_t)(BITFIELDS_GET_unsigned(word, width, lsb) ^ \
+                   BITFIELDS_SIGN(width)) - (int32_t)BITFIELDS_SIGN(width))
+
+/* what each field of a layout list expands to in each generated function */
+#define BITFIELDS_MEMBER(field, kind, width, lsb, unused) \
+        BITFIELDS_TYPE_##kind field;
+#define BITFIELDS_CHECK(field, kind, width, lsb, unused) \
+        && BITFIELDS_FITS_##kind(fields.field, width)
+#define BITFIELDS_PUT(field, kind, width, lsb, unused) \
+        | ((uint32_t)fields.field & BITFIELDS_MASK(width)) << (lsb)
+#define BITFIELDS_TAKE(field, kind, width, lsb, unused) \
+        fields.field = BITFIELDS_GET_##kind(word, width, lsb);
+
+/*
+ * defines struct Name##_fields and the inline functions Name##_fits,
+ * Name##_pack and Name##_unpack for the layout list LIST
+ */
+#define BITFIELDS_LAYOUT(Name, LIST) \
+        struct Name##_fields { \
+                LIST(BITFIELDS_MEMBER, 0) \
+        }; \
+        \
+        static inline bool Name##_fits(struct Name##_fields fields) \
+        { \
+                return true LIST(BITFIELDS_CHECK, 0); \
+        } \
+        \
+        static inline uint32_t Name##_pack(struct Name##_fields fields) \
+        { \
+                return 0 LIST(BITFIELDS_PUT, 0); \
+        } \
+        \
+        static inline struct Name##_fields Name##_unpack(uint32_t word) \
+        { \
+                struct Name##_fields fields; \
+                LIST(BITFIELDS_TAKE, 0) \
+                return fields; \
+        }
+
+#endif
@@ -0,0 +1,259 @@
+/********************************************************************
+ *
+ *                          chroma.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for chroma.h
+ *
+ *     Summary:
+ *      chroma quantizes averaged pb and pr values to the 4-bit indices
+ *      stored in a code word, and turns indices back into chroma values.
+ *      It uses the same 16 nonlinear chroma levels as the arith40 library
+ *      and gives exactly the same indices as Arith40_index_of_chroma, but
+ *      finds them with a table lookup instead of a search.
+ *
+ *     Notes:
+ *   - Arith40_index_of_chroma finds the first level i with the value at
+ *     most level i + 1, and then picks i or i + 1, whichever is closer,
+ *     taking i + 1 on a tie. Both steps are kept exactly, with the same
+ *     float subtractions, so every index matches
+ *   - The search is replaced by a table of CHROMA_BUCKETS buckets over
+ *     [-0.5, 0.5). Each bucket stores how many levels (after the first) lie
+ *     below it. A bucket is narrower than the smallest gap between levels,
+ *     so at most one more level can lie below the value, and one comparison
+ *     finishes the search. The bucket table is worked out by the compiler
+ *     from the levels themselves
+ *   - Values outside [-0.5, 0.5), and NaN, take the original search
+ *   - The AVX2 version quantizes 8 values per step with gathers from the
+ *     same tables. It is compiled with a target attribute, so the Makefile
+ *     doesn't need any -m flags
+ *   - This module uses functions from kernels.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "assert.h"
+#include "kernels.h"
+#include "chroma.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+#define LAST_INDEX (CHROMA_LEVELS - 1)
+#define CHROMA_BUCKETS 64
+#define LOWEST_BUCKETED -0.5f
+#define HIGHEST_BUCKETED 0.5f
+
+/*
+ * a little below the start of bucket k, so a value rounded into the wrong
+ * bucket still starts at or below its level
+ */
+#define BUCKET_START(k) \
+        ((double)(k) / CHROMA_BUCKETS + LOWEST_BUCKETED - 1e-4)
+#define LEVEL_VALUE(level, unused) level,
+#define LEVEL_BELOW(level, k) + ((level) < BUCKET_START(k))
+
+/* levels after the first below bucket k, which is where the search starts */
+#define BUCKET(k) \
+        ((0 CHROMA_LEVEL_LIST(LEVEL_BELOW, k)) > 0 ? \
+                                (0 CHROMA_LEVEL_LIST(LEVEL_BELOW, k)) - 1 : 0)
+#define BUCKETS4(k) BUCKET(k), BUCKET(k + 1), BUCKET(k + 2), BUCKET(k + 3)
+#define BUCKETS16(k) BUCKETS4(k), BUCKETS4(k + 4), BUCKETS4(k + 8), \
+                                                        BUCKETS4(k + 12)
+
+/*
+ * the levels, with one more entry above the last so that level i + 1 can
+ * always be read. It is far enough above 0.5 that no bucketed value moves
+ * past the last level, or rounds up to it
+ */
+static const float levels[CHROMA_LEVELS + 1] = {
+        CHROMA_LEVEL_LIST(LEVEL_VALUE, 0) 1.0f
+};
+
+/* one extra bucket for values that round up to HIGHEST_BUCKETED */
+static const int32_t buckets[CHROMA_BUCKETS + 1] = {
+        BUCKETS16(0), BUCKETS16(16), BUCKETS16(32), BUCKETS16(48),
+        BUCKET(64)
+};
+
+typedef void indices_fun(const float *chromas, int count, uint32_t *indices);
+
+static indices_fun indices_scalar;
+static indices_fun *indices_best(void);
+
+/**********Chroma_index_of********
+ *
+ * Quantizes one chroma value to the index of its nearest level
+ * Inputs:
+ *              float chroma: the averaged pb or pr value
+ * Return: the index of the level, from 0 to CHROMA_LEVELS - 1
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * gives the same index as Arith40_index_of_chroma for every float
+ ************************/
+unsigned Chroma_index_of(float chroma)
+{
+        unsigned i;
+
+        if (chroma >= LOWEST_BUCKETED && chroma < HIGHEST_BUCKETED) {
+                i = buckets[(int)((chroma - LOWEST_BUCKETED) *
+                                                        CHROMA_BUCKETS)];
+                if (i < LAST_INDEX && chroma > levels[i + 1]) {
+                        i++;
+                }
+        } else {
+                for (i = 0; i < LAST_INDEX && chroma > levels[i + 1]; i++);
+        }
+
+        if (i == LAST_INDEX || levels[i + 1] - chroma > chroma - levels[i]) {
+                return i;
+        }
+        return i + 1;
+}
+
+/**********Chroma_of_index********
+ *
+ * Returns the chroma level of an index
+ * Inputs:
+ *              unsigned index: the index of the level
+ * Return: the chroma value of the level
+ * Expects:
+ *      * index to be less than CHROMA_LEVELS
+ * Notes:
+ *      * gives the same value as Arith40_chroma_of_index
+ *      * checked runtime error if index is CHROMA_LEVELS or more
+ ************************/
+float Chroma_of_index(unsigned index)
+{
+        assert(index < CHROMA_LEVELS);
+        return levels[index];
+}
+
+/**********Chroma_indices********
+ *
+ * Quantizes a run of chroma values, like Chroma_index_of on each one
+ * Inputs:
+ *              const float *chromas: the values to be quantized
+ *              int count: the number of values
+ *              uint32_t *indices: where the count indices are written
+ * Return: N/A
+ * Expects:
+ *      * chromas and indices to be nonnull
+ *      * count to be nonnegative
+ * Notes:
+ *      * uses the AVX2 version when the CPU has it
+ *      * checked runtime error if:
+ *              * chromas or indices is NULL
+ *              * count is negative
+ ************************/
+void Chroma_indices(const float *chromas, int count, uint32_t *indices)
+{
+        assert(chromas != NULL && indices != NULL);
+        assert(count >= 0);
+
+        static indices_fun *best = NULL;
+        if (best == NULL) {
+                best = indices_best();
+        }
+        best(chromas, count, indices);
+}
+
+/**********indices_scalar********
+ *
+ * Scalar version of Chroma_indices
+ * Inputs and Expects: same as Chroma_indices
+ * Return: N/A
+ ************************/
+static void indices_scalar(const float *chromas, int count, uint32_t *indices)
+{
+        for (int i = 0; i < count; i++) {
+                indices[i] = Chroma_index_of(chromas[i]);
+        }
+}
+
+#if X86_KERNELS
+
+/**********indices_avx2********
+ *
+ * AVX2 version of Chroma_indices, quantizing 8 values per step
+ * Inputs and Expects: same as Chroma_indices
+ * Return: N/A
+ * Notes:
+ *      * a step with any value outside [-0.5, 0.5) is done by the scalar
+ *        version instead
+ ************************/
+__attribute__((target("avx2")))
+static void indices_avx2(const float *chromas, int count, uint32_t *indices)
+{
+        const __m256i one = _mm256_set1_epi32(1);
+        int i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+                __m256 chroma = _mm256_loadu_ps(chromas + i);
+                __m256 bucketed = _mm256_and_ps(
+                        _mm256_cmp_ps(chroma, _mm256_set1_ps(LOWEST_BUCKETED),
+                                      _CMP_GE_OQ),
+                        _mm256_cmp_ps(chroma, _mm256_set1_ps(HIGHEST_BUCKETED),
+                                      _CMP_LT_OQ));
+                if (_mm256_movemask_ps(bucketed) != 0xff) {
+                        indices_scalar(chromas + i, 8, indices + i);
+                        continue;
+                }
+
+                __m256i bucket = _mm256_cvttps_epi32(_mm256_mul_ps(
+                        _mm256_sub_ps(chroma, _mm256_set1_ps(LOWEST_BUCKETED)),
+                        _mm256_set1_ps(CHROMA_BUCKETS)));
+                __m256i level = _mm256_i32gather_epi32(buckets, bucket, 4);
+
+                /* the one comparison left of the search; true is -1 */
+                __m256 above = _mm256_i32gather_ps(levels,
+                                        _mm256_add_epi32(level, one), 4);
+                level = _mm256_sub_epi32(level, _mm256_castps_si256(
+                        _mm256_cmp_ps(chroma, above, _CMP_GT_OQ)));
+
+                /* pick level or level + 1, whichever is closer */
+                __m256 below = _mm256_i32gather_ps(levels, level, 4);
+                above = _mm256_i32gather_ps(levels,
+                                        _mm256_add_epi32(level, one), 4);
+                __m256 below_closer = _mm256_cmp_ps(
+                                        _mm256_sub_ps(above, chroma),
+                                        _mm256_sub_ps(chroma, below),
+                                        _CMP_GT_OQ);
+                level = _mm256_add_epi32(level, _mm256_andnot_si256(
+                                _mm256_castps_si256(below_closer), one));
+
+                _mm256_storeu_si256((__m256i *)(indices + i), level);
+        }
+
+        indices_scalar(chromas + i, count - i, indices + i);
+}
+
+#endif
+
+/**********indices_best********
+ *
+ * Picks the fastest version of Chroma_indices at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX2 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static indices_fun *indices_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return indices_avx2;
+        }
+#endif
+        return indices_scalar;
+}
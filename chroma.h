@@ -0,0 +1,42 @@
+/********************************************************************
+ *
+ *                          chroma.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for chroma.c
+ *
+ *     Summary:
+ *      chroma quantizes averaged pb and pr values to the 4-bit indices
+ *      stored in a code word, and turns indices back into chroma values.
+ *      It uses the same 16 nonlinear chroma levels as the arith40 library
+ *      and gives exactly the same indices as Arith40_index_of_chroma, but
+ *      finds them with a table lookup instead of a search.
+ *
+ *******************************************************************/
+#ifndef CHROMA_INCLUDED
+#define CHROMA_INCLUDED
+
+#include <stdint.h>
+
+/* number of chroma levels, so indices are from 0 to CHROMA_LEVELS - 1 */
+#define CHROMA_LEVELS 16
+
+/*
+ * the chroma levels of the arith40 library, from lowest to highest, each
+ * applied to X with an extra argument, so other modules can build their own
+ * tables from them at compile time
+ */
+#define CHROMA_LEVEL_LIST(X, arg) \
+        X(-0.35f, arg) X(-0.2f, arg) X(-0.15f, arg) X(-0.10f, arg) \
+        X(-0.077f, arg) X(-0.055f, arg) X(-0.033f, arg) X(-0.011f, arg) \
+        X(0.011f, arg) X(0.033f, arg) X(0.055f, arg) X(0.077f, arg) \
+        X(0.10f, arg) X(0.15f, arg) X(0.2f, arg) X(0.35f, arg)
+
+unsigned Chroma_index_of(float chroma);
+float Chroma_of_index(unsigned index);
+void Chroma_indices(const float *chromas, int count, uint32_t *indices);
+
+#endif
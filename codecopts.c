@@ -0,0 +1,55 @@
+/********************************************************************
+ *
+ *                          codecopts.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for codecopts.h
+ *
+ *     Summary:
+ *      codecopts holds the options given on the command line that change
+ *      how compress40 and decompress40 work. compress40.h can't be changed,
+ *      so 40image.c sets the options here before calling them.
+ *
+ *     Notes:
+ *   - Until Codecopts_set is called, the options are the defaults: the float
+ *     pipeline with no conformance checking, written to standard output in
+ *     the text container
+ *   - This module does not use functions from other modules
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "codecopts.h"
+
+static struct Codec_options current = { CODEC_FLOAT, false, CODEC_YPBPR,
+                                        NULL, false };
+
+/**********Codecopts_get********
+ *
+ * Returns the options the codec should use
+ * Inputs: N/A
+ * Return: a copy of the current options
+ * Expects:
+ *      N/A
+ ************************/
+struct Codec_options Codecopts_get(void)
+{
+        return current;
+}
+
+/**********Codecopts_set********
+ *
+ * Replaces the options the codec should use
+ * Inputs:
+ *              struct Codec_options options: the new options
+ * Return: N/A
+ * Expects:
+ *      * to be called before compress40 or decompress40
+ ************************/
+void Codecopts_set(struct Codec_options options)
+{
+        current = options;
+}
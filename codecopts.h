@@ -0,0 +1,65 @@
+/********************************************************************
+ *
+ *                          codecopts.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for codecopts.c
+ *
+ *     Summary:
+ *      codecopts holds the options given on the command line that change
+ *      how compress40 and decompress40 work. compress40.h can't be changed,
+ *      so 40image.c sets the options here before calling them.
+ *
+ *******************************************************************/
+#ifndef CODECOPTS_INCLUDED
+#define CODECOPTS_INCLUDED
+
+#include <stdbool.h>
+
+/* the arithmetic the codec uses */
+typedef enum Codec_arithmetic {
+        CODEC_FLOAT,
+        CODEC_FIXED
+} Codec_arithmetic;
+
+/* the color transform the encoder uses */
+typedef enum Codec_transform {
+        CODEC_YPBPR,
+        CODEC_YCOCG
+} Codec_transform;
+
+/*
+ * This is the struct definition of the Codec_options instance
+ * Elements:
+ *      Codec_arithmetic arithmetic: CODEC_FLOAT for the float pipeline (the
+ *                                   reference) or CODEC_FIXED for the
+ *                                   integer-only one
+ *      bool conformance: true to run both encoders and report every code
+ *                        word where the integer one differs from the float
+ *                        one
+ *      Codec_transform transform: CODEC_YPBPR for the float Y/Pb/Pr matrices
+ *                                 (the reference) or CODEC_YCOCG for the
+ *                                 integer YCoCg-R transform of ycocg.h,
+ *                                 which ignores arithmetic and conformance
+ *      const char *output: the file named by -o, which the output is
+ *                          mapped into and written by several threads, or
+ *                          NULL to write to standard output
+ *      bool native: true to write compressed images in the native container
+ *                   of readwritecompressed.h instead of the text one
+ *
+ */
+struct Codec_options {
+        Codec_arithmetic arithmetic;
+        bool conformance;
+        Codec_transform transform;
+        const char *output;
+        bool native;
+};
+
+struct Codec_options Codecopts_get(void);
+void Codecopts_set(struct Codec_options options);
+
+#endif
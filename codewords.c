@@ -0,0 +1,437 @@
+/********************************************************************
+ *
+ *                          codewords.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for codewords.h
+ *
+ *     Summary:
+ *      codewords holds the 32-bit code words of a compressed image in one
+ *      flat, row-major buffer, with one word per 2x2 block of pixels. It also
+ *      converts runs of words to and from the big-endian order used in the
+ *      compressed file format.
+ *
+ *     Notes:
+ *   - The whole image is one allocation, unlike a UArray2b with a blocksize
+ *     of 1, which allocates a separate block for every word
+ *   - The buffer comes from pool.h, so the buffer of one image is reused by
+ *     the next
+ *   - Converting to or from big-endian order reverses the bytes of each
+ *     word. The vector versions do it for 4 (SSSE3), 8 (AVX2) or 16
+ *     (AVX-512 BW) words at once with one byte shuffle, and only run on
+ *     x86, which is little-endian. The scalar version works on any CPU
+ *   - This module uses functions from pool.h, and kernels.h to pick the
+ *     version
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "assert.h"
+#include "pool.h"
+#include "kernels.h"
+#include "codewords.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+#define SSE_WORDS 4
+#define AVX2_WORDS 8
+#define AVX512_WORDS 16
+
+typedef void to_fun(const uint32_t *words, unsigned char *bytes,
+                    size_t count);
+typedef void from_fun(const unsigned char *bytes, uint32_t *words,
+                      size_t count);
+
+static to_fun *to_best(void);
+static from_fun *from_best(void);
+static void to_scalar(const uint32_t *words, unsigned char *bytes,
+                      size_t count);
+static void from_scalar(const unsigned char *bytes, uint32_t *words,
+                        size_t count);
+
+/**********Codewords_new********
+ *
+ * Allocates a buffer for width x height code words
+ * Inputs:
+ *              int width: the number of code words in each row
+ *              int height: the number of rows of code words
+ * Return: a new Codewords with room for width * height words
+ * Expects:
+ *      * width and height to be nonnegative
+ * Notes:
+ *      * the words are uninitialized
+ *      * the caller must free the buffer with Codewords_free
+ *      * checked runtime error if:
+ *              * width or height is negative
+ *              * the memory can't be allocated
+ ************************/
+Codewords Codewords_new(int width, int height)
+{
+        assert(width >= 0 && height >= 0);
+
+        Codewords codewords = malloc(sizeof(struct Codewords));
+        assert(codewords != NULL);
+
+        size_t count = (size_t)width * height;
+        codewords->width = width;
+        codewords->height = height;
+        codewords->words = Pool_alloc(count * sizeof(uint32_t));
+
+        return codewords;
+}
+
+/**********Codewords_free********
+ *
+ * Deallocates a Codewords and its buffer of words
+ * Inputs:
+ *              Codewords *codewords: pointer to the Codewords to be freed
+ * Return: N/A
+ * Expects:
+ *      * codewords and *codewords to be nonnull
+ * Notes:
+ *      * sets *codewords to NULL
+ *      * checked runtime error if codewords or *codewords is NULL
+ ************************/
+void Codewords_free(Codewords *codewords)
+{
+        assert(codewords != NULL && *codewords != NULL);
+
+        Pool_free((*codewords)->words);
+        free(*codewords);
+        *codewords = NULL;
+}
+
+/**********Codewords_row********
+ *
+ * Returns a pointer to the first code word in a row
+ * Inputs:
+ *              Codewords codewords: the buffer of code words
+ *              int row: the index of the row
+ * Return: a pointer to the codewords->width words of the row
+ * Expects:
+ *      * codewords to be nonnull
+ *      * row to be between 0 and the height - 1
+ * Notes:
+ *      * checked runtime error if:
+ *              * codewords is NULL
+ *              * row is out of bounds
+ ************************/
+uint32_t *Codewords_row(Codewords codewords, int row)
+{
+        assert(codewords != NULL);
+        assert(row >= 0 && row < codewords->height);
+
+        return codewords->words + (size_t)row * codewords->width;
+}
+
+/**********Codewords_to_bigendian********
+ *
+ * Converts a run of code words into the bytes stored in a compressed file
+ * Inputs:
+ *              const uint32_t *words: the code words to be converted
+ *              unsigned char *bytes: where the count * CODEWORD_BYTES bytes
+ *                                    are written
+ *              size_t count: the number of code words
+ * Return: N/A
+ * Expects:
+ *      * words and bytes to be nonnull
+ * Notes:
+ *      * each word is written most significant byte first
+ *      * checked runtime error if words or bytes is NULL
+ ************************/
+void Codewords_to_bigendian(const uint32_t *words, unsigned char *bytes,
+                                                                size_t count)
+{
+        assert(words != NULL && bytes != NULL);
+
+        static to_fun *best = NULL;
+        if (best == NULL) {
+                best = to_best();
+        }
+        best(words, bytes, count);
+}
+
+/**********Codewords_from_bigendian********
+ *
+ * Converts the bytes stored in a compressed file into a run of code words
+ * Inputs:
+ *              const unsigned char *bytes: count * CODEWORD_BYTES bytes, each
+ *                                          word most significant byte first
+ *              uint32_t *words: where the count code words are written
+ *              size_t count: the number of code words
+ * Return: N/A
+ * Expects:
+ *      * bytes and words to be nonnull
+ * Notes:
+ *      * checked runtime error if bytes or words is NULL
+ ************************/
+void Codewords_from_bigendian(const unsigned char *bytes, uint32_t *words,
+                                                                size_t count)
+{
+        assert(bytes != NULL && words != NULL);
+
+        static from_fun *best = NULL;
+        if (best == NULL) {
+                best = from_best();
+        }
+        best(bytes, words, count);
+}
+
+/**********to_scalar********
+ *
+ * Scalar version of Codewords_to_bigendian
+ * Inputs and Expects: same as Codewords_to_bigendian
+ * Return: N/A
+ ************************/
+static void to_scalar(const uint32_t *words, unsigned char *bytes,
+                      size_t count)
+{
+        for (size_t i = 0; i < count; i++) {
+                uint32_t word = words[i];
+                bytes[0] = word >> 24;
+                bytes[1] = word >> 16;
+                bytes[2] = word >> 8;
+                bytes[3] = word;
+                bytes += CODEWORD_BYTES;
+        }
+}
+
+/**********from_scalar********
+ *
+ * Scalar version of Codewords_from_bigendian
+ * Inputs and Expects: same as Codewords_from_bigendian
+ * Return: N/A
+ ************************/
+static void from_scalar(const unsigned char *bytes, uint32_t *words,
+                        size_t count)
+{
+        for (size_t i = 0; i < count; i++) {
+                words[i] = (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16
+                                | (uint32_t)bytes[2] << 8 | bytes[3];
+                bytes += CODEWORD_BYTES;
+        }
+}
+
+#if X86_KERNELS
+
+/**********swap_sse********
+ *
+ * Reverses the bytes of each 32-bit word, 4 words per step
+ * Inputs:
+ *              const void *from: the words
+ *              void *to: where the reversed words go
+ *              size_t count: the number of words
+ * Return: the number of words reversed, count rounded down to a multiple
+ *         of 4
+ * Expects:
+ *      * from and to to be nonnull
+ ************************/
+__attribute__((target("ssse3")))
+static size_t swap_sse(const void *from, void *to, size_t count)
+{
+        const __m128i reverse = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                              11, 10, 9, 8, 15, 14, 13, 12);
+        const unsigned char *in = from;
+        unsigned char *out = to;
+        size_t k = 0;
+
+        for (; k + SSE_WORDS <= count; k += SSE_WORDS) {
+                __m128i words = _mm_loadu_si128(
+                        (const __m128i *)(in + k * CODEWORD_BYTES));
+                _mm_storeu_si128((__m128i *)(out + k * CODEWORD_BYTES),
+                                 _mm_shuffle_epi8(words, reverse));
+        }
+        return k;
+}
+
+/**********swap_avx2********
+ *
+ * Reverses the bytes of each 32-bit word, 8 words per step
+ * Inputs and Expects: same as swap_sse
+ * Return: the number of words reversed, count rounded down to a multiple
+ *         of 8
+ ************************/
+__attribute__((target("avx2")))
+static size_t swap_avx2(const void *from, void *to, size_t count)
+{
+        const __m256i reverse = _mm256_setr_epi8(
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        const unsigned char *in = from;
+        unsigned char *out = to;
+        size_t k = 0;
+
+        for (; k + AVX2_WORDS <= count; k += AVX2_WORDS) {
+                __m256i words = _mm256_loadu_si256(
+                        (const __m256i *)(in + k * CODEWORD_BYTES));
+                _mm256_storeu_si256((__m256i *)(out + k * CODEWORD_BYTES),
+                                    _mm256_shuffle_epi8(words, reverse));
+        }
+        return k;
+}
+
+/**********swap_avx512********
+ *
+ * Reverses the bytes of each 32-bit word, 16 words per step
+ * Inputs and Expects: same as swap_sse
+ * Return: the number of words reversed, count rounded down to a multiple
+ *         of 16
+ ************************/
+__attribute__((target("avx512f,avx512bw")))
+static size_t swap_avx512(const void *from, void *to, size_t count)
+{
+        const __m512i reverse = _mm512_set_epi32(
+                0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203,
+                0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203,
+                0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203,
+                0x0c0d0e0f, 0x08090a0b, 0x04050607, 0x00010203);
+        const unsigned char *in = from;
+        unsigned char *out = to;
+        size_t k = 0;
+
+        for (; k + AVX512_WORDS <= count; k += AVX512_WORDS) {
+                __m512i words = _mm512_loadu_si512(in + k * CODEWORD_BYTES);
+                _mm512_storeu_si512(out + k * CODEWORD_BYTES,
+                                    _mm512_shuffle_epi8(words, reverse));
+        }
+        return k;
+}
+
+/**********to_sse********
+ *
+ * SSSE3 version of Codewords_to_bigendian
+ * Inputs and Expects: same as Codewords_to_bigendian
+ * Return: N/A
+ ************************/
+static void to_sse(const uint32_t *words, unsigned char *bytes, size_t count)
+{
+        size_t k = swap_sse(words, bytes, count);
+        to_scalar(words + k, bytes + k * CODEWORD_BYTES, count - k);
+}
+
+/**********from_sse********
+ *
+ * SSSE3 version of Codewords_from_bigendian
+ * Inputs and Expects: same as Codewords_from_bigendian
+ * Return: N/A
+ ************************/
+static void from_sse(const unsigned char *bytes, uint32_t *words,
+                     size_t count)
+{
+        size_t k = swap_sse(bytes, words, count);
+        from_scalar(bytes + k * CODEWORD_BYTES, words + k, count - k);
+}
+
+/**********to_avx2********
+ *
+ * AVX2 version of Codewords_to_bigendian
+ * Inputs and Expects: same as Codewords_to_bigendian
+ * Return: N/A
+ ************************/
+static void to_avx2(const uint32_t *words, unsigned char *bytes,
+                    size_t count)
+{
+        size_t k = swap_avx2(words, bytes, count);
+        to_scalar(words + k, bytes + k * CODEWORD_BYTES, count - k);
+}
+
+/**********from_avx2********
+ *
+ * AVX2 version of Codewords_from_bigendian
+ * Inputs and Expects: same as Codewords_from_bigendian
+ * Return: N/A
+ ************************/
+static void from_avx2(const unsigned char *bytes, uint32_t *words,
+                      size_t count)
+{
+        size_t k = swap_avx2(bytes, words, count);
+        from_scalar(bytes + k * CODEWORD_BYTES, words + k, count - k);
+}
+
+/**********to_avx512********
+ *
+ * AVX-512 version of Codewords_to_bigendian
+ * Inputs and Expects: same as Codewords_to_bigendian
+ * Return: N/A
+ ************************/
+static void to_avx512(const uint32_t *words, unsigned char *bytes,
+                      size_t count)
+{
+        size_t k = swap_avx512(words, bytes, count);
+        to_scalar(words + k, bytes + k * CODEWORD_BYTES, count - k);
+}
+
+/**********from_avx512********
+ *
+ * AVX-512 version of Codewords_from_bigendian
+ * Inputs and Expects: same as Codewords_from_bigendian
+ * Return: N/A
+ ************************/
+static void from_avx512(const unsigned char *bytes, uint32_t *words,
+                        size_t count)
+{
+        size_t k = swap_avx512(bytes, words, count);
+        from_scalar(bytes + k * CODEWORD_BYTES, words + k, count - k);
+}
+
+#endif
+
+/**********to_best********
+ *
+ * Picks the fastest version of Codewords_to_bigendian at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX-512, AVX2, SSSE3 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static to_fun *to_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX512) {
+                return to_avx512;
+        }
+        if (level >= KERNEL_AVX2) {
+                return to_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return to_sse;
+        }
+#endif
+        return to_scalar;
+}
+
+/**********from_best********
+ *
+ * Picks the fastest version of Codewords_from_bigendian at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX-512, AVX2, SSSE3 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static from_fun *from_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX512) {
+                return from_avx512;
+        }
+        if (level >= KERNEL_AVX2) {
+                return from_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return from_sse;
+        }
+#endif
+        return from_scalar;
+}
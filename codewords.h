@@ -0,0 +1,52 @@
+/********************************************************************
+ *
+ *                          codewords.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for codewords.c
+ *
+ *     Summary:
+ *      codewords holds the 32-bit code words of a compressed image in one
+ *      flat, row-major buffer, with one word per 2x2 block of pixels. It also
+ *      converts runs of words to and from the big-endian order used in the
+ *      compressed file format.
+ *
+ *******************************************************************/
+#ifndef CODEWORDS_INCLUDED
+#define CODEWORDS_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* number of bytes each code word takes up in a compressed file */
+#define CODEWORD_BYTES 4
+
+typedef struct Codewords *Codewords;
+
+/*
+ * This is the struct definition of the Codewords instance
+ * Elements:
+ *      int width: the number of code words in each row (image width / 2)
+ *      int height: the number of rows of code words (image height / 2)
+ *      uint32_t *words: width * height code words in row-major order
+ *
+ */
+struct Codewords {
+        int width;
+        int height;
+        uint32_t *words;
+};
+
+Codewords Codewords_new(int width, int height);
+void Codewords_free(Codewords *codewords);
+uint32_t *Codewords_row(Codewords codewords, int row);
+
+void Codewords_to_bigendian(const uint32_t *words, unsigned char *bytes,
+                                                                size_t count);
+void Codewords_from_bigendian(const unsigned char *bytes, uint32_t *words,
+                                                                size_t count);
+
+#endif
@@ -0,0 +1,941 @@
+/********************************************************************
+ *
+ *                          colorconvert.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for colorconvert.h
+ *
+ *     Summary:
+ *      colorconvert converts whole scanlines between interleaved 8-bit RGB
+ *      and planar component video color space (CVS). It picks an AVX2 or
+ *      SSE4.1 version when the CPU has one and a scalar version otherwise.
+ *      Every version gives exactly the same floats as the per-pixel
+ *      functions in rgbcomponent.c.
+ *
+ *     Notes:
+ *   - To match rgbcomponent.c bit for bit, samples are scaled in float and
+ *     the color matrix is applied in double, just like the C expressions
+ *     there. The vector versions convert 8 pixels per step: the bytes are
+ *     deinterleaved with shuffles, widened to float and then to double.
+ *   - Going back to RGB, the vector versions clamp with min and max and 
+ *     scale by 255 in float, like CVS_to_RGB. The scaled value can land 
+ *     exactly halfway between two integers, where round() goes away from 
+ *     zero but a plain convert instruction goes to even, so the value is 
+ *     truncated with a rounding instruction and bumped up when the fraction
+ *     left over is at least one half
+ *   - The reciprocal of the denominator is only used when it was checked to
+ *     give the same float as the divide for every sample (see
+ *     Colorconvert_scale_of); for a denominator of 255 it doesn't, so the
+ *     divide stays
+ *   - The vector versions are compiled with target attributes, so the
+ *     Makefile doesn't need any -m flags, and they are never fused into
+ *     multiply-adds, which would change the rounding
+ *   - This module uses functions from kernels.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "assert.h"
+#include "kernels.h"
+#include "colorconvert.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+#define MAX_8_BIT_DENOMINATOR 255
+#define PIXELS_PER_STEP 8
+#define OUTPUT_DENOMINATOR 255
+
+typedef void rows_to_planes_fun(const unsigned char *top,
+                                const unsigned char *bottom, int width,
+                                struct Colorconvert_scale scale,
+                                float *y_top, float *y_bottom,
+                                float *pbavg, float *pravg);
+
+static rows_to_planes_fun rows_to_planes_scalar;
+static void pixel_to_cvs(const unsigned char *rgb,
+                         struct Colorconvert_scale scale,
+                         float *y, float *pb, float *pr);
+static rows_to_planes_fun *rows_to_planes_best(void);
+
+typedef void planes_to_row_fun(const float *y, const float *pbavg,
+                               const float *pravg, int width,
+                               unsigned char *rgb);
+
+static planes_to_row_fun planes_to_row_scalar;
+static void cvs_to_pixel(float y, float pb, float pr, unsigned char *rgb);
+static planes_to_row_fun *planes_to_row_best(void);
+
+/**********Colorconvert_scale_of********
+ *
+ * Works out how to scale samples of an image with the given denominator
+ * Inputs:
+ *              unsigned denominator: the denominator of the image
+ * Return: a Colorconvert_scale for the denominator
+ * Expects:
+ *      * denominator to be between 1 and 255
+ * Notes:
+ *      * checks every sample from 0 to denominator, so the reciprocal is
+ *        only used when it can't change a single float
+ *      * checked runtime error if denominator is 0 or greater than 255
+ ************************/
+struct Colorconvert_scale Colorconvert_scale_of(unsigned denominator)
+{
+        assert(denominator > 0 && denominator <= MAX_8_BIT_DENOMINATOR);
+        struct Colorconvert_scale scale;
+
+        scale.denominator = (float)denominator;
+        scale.reciprocal = 1.0f / scale.denominator;
+        scale.use_reciprocal = true;
+
+        for (unsigned sample = 0; sample <= denominator; sample++) {
+                volatile float divided = (float)sample / scale.denominator;
+                volatile float multiplied = (float)sample * scale.reciprocal;
+                if (divided != multiplied) {
+                        scale.use_reciprocal = false;
+                        break;
+                }
+        }
+
+        return scale;
+}
+
+/**********Colorconvert_vectorized********
+ *
+ * Tells whether this CPU runs a vector version of the RGB to CVS conversion
+ * Inputs: N/A
+ * Return: true if Colorconvert_rows_to_planes uses AVX2 or SSE4.1, false if
+ *         it falls back to the scalar version
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * lets callers pick a faster scalar conversion, like the lookup
+ *        tables in rgbtables.h, when there is no vector version
+ ************************/
+bool Colorconvert_vectorized(void)
+{
+        return rows_to_planes_best() != rows_to_planes_scalar;
+}
+
+/**********Colorconvert_rows_to_planes********
+ *
+ * Converts two scanlines of interleaved 8-bit RGB into their y values and the
+ * averaged pb and pr values of the 2x2 blocks they make up
+ * Inputs:
+ *              const unsigned char *top: width pixels of the top scanline,
+ *                                        3 bytes (red, green, blue) each
+ *              const unsigned char *bottom: width pixels of the scanline below
+ *              int width: the number of pixels in each scanline
+ *              struct Colorconvert_scale scale: from Colorconvert_scale_of
+ *              float *y_top: where the width y values of top are written
+ *              float *y_bottom: where the width y values of bottom are written
+ *              float *pbavg: where the width / 2 averaged pb values go
+ *              float *pravg: where the width / 2 averaged pr values go
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * width to be even and nonnegative
+ * Notes:
+ *      * gives the same values as RGB_to_CVS followed by the averaging in
+ *        RGBtoComponentPlanes
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * width is negative or odd
+ ************************/
+void Colorconvert_rows_to_planes(const unsigned char *top,
+                                 const unsigned char *bottom, int width,
+                                 struct Colorconvert_scale scale,
+                                 float *y_top, float *y_bottom,
+                                 float *pbavg, float *pravg)
+{
+        assert(top != NULL && bottom != NULL);
+        assert(y_top != NULL && y_bottom != NULL);
+        assert(pbavg != NULL && pravg != NULL);
+        assert(width >= 0 && width % 2 == 0);
+
+        static rows_to_planes_fun *best = NULL;
+        if (best == NULL) {
+                best = rows_to_planes_best();
+        }
+        best(top, bottom, width, scale, y_top, y_bottom, pbavg, pravg);
+}
+
+/**********pixel_to_cvs********
+ *
+ * Converts one 8-bit RGB pixel to component video color space
+ * Inputs:
+ *              const unsigned char *rgb: the red, green and blue bytes
+ *              struct Colorconvert_scale scale: from Colorconvert_scale_of
+ *              float *y, *pb, *pr: where the results are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ * Notes:
+ *      * the same arithmetic as RGB_to_CVS in rgbcomponent.c
+ ************************/
+static void pixel_to_cvs(const unsigned char *rgb,
+                         struct Colorconvert_scale scale,
+                         float *y, float *pb, float *pr)
+{
+        float r, g, b;
+
+        if (scale.use_reciprocal) {
+                r = (float)rgb[0] * scale.reciprocal;
+                g = (float)rgb[1] * scale.reciprocal;
+                b = (float)rgb[2] * scale.reciprocal;
+        } else {
+                r = (float)rgb[0] / scale.denominator;
+                g = (float)rgb[1] / scale.denominator;
+                b = (float)rgb[2] / scale.denominator;
+        }
+
+        *y = 0.299 * r + 0.587 * g + 0.114 * b;
+        *pb = -0.168736 * r - 0.331264 * g + 0.5 * b;
+        *pr = 0.5 * r - 0.418688 * g - 0.081312 * b;
+}
+
+/**********rows_to_planes_scalar********
+ *
+ * Scalar version of Colorconvert_rows_to_planes, also used by the vector
+ * versions for the pixels left over after the last full step
+ * Inputs and Expects: same as Colorconvert_rows_to_planes
+ * Return: N/A
+ ************************/
+static void rows_to_planes_scalar(const unsigned char *top,
+                                  const unsigned char *bottom, int width,
+                                  struct Colorconvert_scale scale,
+                                  float *y_top, float *y_bottom,
+                                  float *pbavg, float *pravg)
+{
+        for (int col = 0; col < width; col += 2) {
+                float pb[4], pr[4];
+
+                /* top left, top right, bottom left, bottom right */
+                pixel_to_cvs(top + col * 3, scale, &y_top[col],
+                                                        &pb[0], &pr[0]);
+                pixel_to_cvs(top + col * 3 + 3, scale, &y_top[col + 1],
+                                                        &pb[1], &pr[1]);
+                pixel_to_cvs(bottom + col * 3, scale, &y_bottom[col],
+                                                        &pb[2], &pr[2]);
+                pixel_to_cvs(bottom + col * 3 + 3, scale, &y_bottom[col + 1],
+                                                        &pb[3], &pr[3]);
+
+                pbavg[col / 2] = (pb[0] + pb[1] + pb[2] + pb[3]) / 4.0;
+                pravg[col / 2] = (pr[0] + pr[1] + pr[2] + pr[3]) / 4.0;
+        }
+}
+
+/**********Colorconvert_planes_to_row********
+ *
+ * Converts one scanline of y values, with the pb and pr values of the 2x2 
+ * blocks it crosses, into interleaved 8-bit RGB with a denominator of 255
+ * Inputs:
+ *              const float *y: the width y values of the scanline
+ *              const float *pbavg: the width / 2 pb values of its blocks
+ *              const float *pravg: the width / 2 pr values of its blocks
+ *              int width: the number of pixels in the scanline
+ *              unsigned char *rgb: where the 3 * width bytes are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * width to be even and nonnegative
+ * Notes:
+ *      * gives the same samples as CVS_to_RGB in rgbcomponent.c
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * width is negative or odd
+ ************************/
+void Colorconvert_planes_to_row(const float *y, const float *pbavg,
+                                const float *pravg, int width,
+                                unsigned char *rgb)
+{
+        assert(y != NULL && pbavg != NULL && pravg != NULL && rgb != NULL);
+        assert(width >= 0 && width % 2 == 0);
+
+        static planes_to_row_fun *best = NULL;
+        if (best == NULL) {
+                best = planes_to_row_best();
+        }
+        best(y, pbavg, pravg, width, rgb);
+}
+
+/**********cvs_to_pixel********
+ *
+ * Converts one component video pixel to 8-bit RGB
+ * Inputs:
+ *              float y, pb, pr: the component video values of the pixel
+ *              unsigned char *rgb: where the red, green and blue bytes go
+ * Return: N/A
+ * Expects:
+ *      * rgb to be nonnull
+ * Notes:
+ *      * the same arithmetic as CVS_to_RGB in rgbcomponent.c
+ ************************/
+static void cvs_to_pixel(float y, float pb, float pr, unsigned char *rgb)
+{
+        float r = 1.0 * y + 0.0 * pb + 1.402 * pr;
+        float g = 1.0 * y - 0.344136 * pb - 0.714136 * pr;
+        float b = 1.0 * y + 1.772 * pb + 0.0 * pr;
+
+        r = fmax(0, fmin(1, r));
+        g = fmax(0, fmin(1, g));
+        b = fmax(0, fmin(1, b));
+
+        rgb[0] = (int)(round(r * OUTPUT_DENOMINATOR));
+        rgb[1] = (int)(round(g * OUTPUT_DENOMINATOR));
+        rgb[2] = (int)(round(b * OUTPUT_DENOMINATOR));
+}
+
+/**********planes_to_row_scalar********
+ *
+ * Scalar version of Colorconvert_planes_to_row, also used by the vector
+ * versions for the pixels left over after the last full step
+ * Inputs and Expects: same as Colorconvert_planes_to_row
+ * Return: N/A
+ ************************/
+static void planes_to_row_scalar(const float *y, const float *pbavg,
+                                 const float *pravg, int width,
+                                 unsigned char *rgb)
+{
+        for (int col = 0; col < width; col++) {
+                cvs_to_pixel(y[col], pbavg[col / 2], pravg[col / 2], 
+                                                        rgb + col * 3);
+        }
+}
+
+#if X86_KERNELS
+
+/*
+ * This is the struct definition of a deinterleaved group of 8 pixels
+ * Elements:
+ *      __m128i r, g, b: the 8 red, green and blue bytes in the low half
+ *
+ */
+struct rgb8 {
+        __m128i r;
+        __m128i g;
+        __m128i b;
+};
+
+/*
+ * This is the struct definition of 8 floats held in two SSE registers
+ * Elements:
+ *      __m128 lo: the values of pixels 0 to 3
+ *      __m128 hi: the values of pixels 4 to 7
+ *
+ */
+struct float8 {
+        __m128 lo;
+        __m128 hi;
+};
+
+/**********deinterleave8********
+ *
+ * Splits 8 interleaved RGB pixels (24 bytes) into separate channels
+ * Inputs:
+ *              const unsigned char *rgb: the first byte of the 8 pixels
+ * Return: the red, green and blue bytes of the 8 pixels
+ * Expects:
+ *      * 24 readable bytes at rgb
+ * Notes:
+ *      * uses two overlapping loads, bytes 0-15 and bytes 8-23, so it never
+ *        reads past the 8 pixels. The last 2 or 3 bytes of each channel are
+ *        only in the second load
+ ************************/
+__attribute__((target("ssse3")))
+static struct rgb8 deinterleave8(const unsigned char *rgb)
+{
+        __m128i lo = _mm_loadu_si128((const __m128i *)rgb);
+        __m128i hi = _mm_loadu_si128((const __m128i *)(rgb + 8));
+        struct rgb8 channels;
+
+        channels.r = _mm_or_si128(
+                _mm_shuffle_epi8(lo, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1,
+                                 -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 
+                                 10, 13, -1, -1, -1, -1, -1, -1, -1, -1)));
+        channels.g = _mm_or_si128(
+                _mm_shuffle_epi8(lo, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1,
+                                 -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, 8, 11, 
+                                 14, -1, -1, -1, -1, -1, -1, -1, -1)));
+        channels.b = _mm_or_si128(
+                _mm_shuffle_epi8(lo, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1,
+                                 -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, 9, 12, 
+                                 15, -1, -1, -1, -1, -1, -1, -1, -1)));
+        return channels;
+}
+
+/**********matrix_row_avx2********
+ *
+ * Computes (c0 * r + c1 * g) + c2 * b in double for 8 pixels and rounds the
+ * results to float
+ * Inputs:
+ *              __m256 r, g, b: the scaled channels of 8 pixels
+ *              double c0, c1, c2: one row of the color matrix
+ * Return: the 8 results as floats
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * subtracting c * x is the same as adding (-c) * x, so the rows of the
+ *        matrix can all be written as sums
+ ************************/
+__attribute__((target("avx2")))
+static __m256 matrix_row_avx2(__m256 r, __m256 g, __m256 b,
+                              double c0, double c1, double c2)
+{
+        __m256d k0 = _mm256_set1_pd(c0);
+        __m256d k1 = _mm256_set1_pd(c1);
+        __m256d k2 = _mm256_set1_pd(c2);
+        __m256d half[2];
+
+        for (int i = 0; i < 2; i++) {
+                __m256d rd = _mm256_cvtps_pd(i == 0 ? 
+                                        _mm256_castps256_ps128(r) :
+                                        _mm256_extractf128_ps(r, 1));
+                __m256d gd = _mm256_cvtps_pd(i == 0 ? 
+                                        _mm256_castps256_ps128(g) :
+                                        _mm256_extractf128_ps(g, 1));
+                __m256d bd = _mm256_cvtps_pd(i == 0 ? 
+                                        _mm256_castps256_ps128(b) :
+                                        _mm256_extractf128_ps(b, 1));
+                half[i] = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(k0, rd),
+                                                      _mm256_mul_pd(k1, gd)),
+                                        _mm256_mul_pd(k2, bd));
+        }
+
+        return _mm256_set_m128(_mm256_cvtpd_ps(half[1]), 
+                               _mm256_cvtpd_ps(half[0]));
+}
+
+/**********convert8_avx2********
+ *
+ * Converts 8 interleaved RGB pixels to component video color space
+ * Inputs:
+ *              const unsigned char *rgb: the first byte of the 8 pixels
+ *              struct Colorconvert_scale scale: from Colorconvert_scale_of
+ *              __m256 *y, *pb, *pr: where the 8 results of each are written
+ * Return: N/A
+ * Expects:
+ *      * 24 readable bytes at rgb
+ ************************/
+__attribute__((target("avx2")))
+static void convert8_avx2(const unsigned char *rgb,
+                          struct Colorconvert_scale scale,
+                          __m256 *y, __m256 *pb, __m256 *pr)
+{
+        struct rgb8 channels = deinterleave8(rgb);
+        __m256 r = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(channels.r));
+        __m256 g = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(channels.g));
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(channels.b));
+
+        if (scale.use_reciprocal) {
+                __m256 reciprocal = _mm256_set1_ps(scale.reciprocal);
+                r = _mm256_mul_ps(r, reciprocal);
+                g = _mm256_mul_ps(g, reciprocal);
+                b = _mm256_mul_ps(b, reciprocal);
+        } else {
+                __m256 denominator = _mm256_set1_ps(scale.denominator);
+                r = _mm256_div_ps(r, denominator);
+                g = _mm256_div_ps(g, denominator);
+                b = _mm256_div_ps(b, denominator);
+        }
+
+        *y = matrix_row_avx2(r, g, b, 0.299, 0.587, 0.114);
+        *pb = matrix_row_avx2(r, g, b, -0.168736, -0.331264, 0.5);
+        *pr = matrix_row_avx2(r, g, b, 0.5, -0.418688, -0.081312);
+}
+
+/**********average_blocks********
+ *
+ * Averages the values of 4 2x2 blocks, given 8 values from each of their two
+ * rows
+ * Inputs:
+ *              struct float8 top: the values of the top row
+ *              struct float8 bottom: the values of the bottom row
+ * Return: the 4 averages, in order from left to right
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * adds top left, top right, bottom left and bottom right in that 
+ *        order, like RGBtoComponentPlanes. Multiplying by 0.25 is exact, so
+ *        it gives the same float as the divide by 4.0 there
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128 average_blocks(struct float8 top, struct float8 bottom)
+{
+        __m128 top_left = _mm_shuffle_ps(top.lo, top.hi, 
+                                                _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 top_right = _mm_shuffle_ps(top.lo, top.hi, 
+                                                _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 bottom_left = _mm_shuffle_ps(bottom.lo, bottom.hi, 
+                                                _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 bottom_right = _mm_shuffle_ps(bottom.lo, bottom.hi, 
+                                                _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(top_left, top_right),
+                                           bottom_left), 
+                                bottom_right);
+
+        return _mm_mul_ps(sum, _mm_set1_ps(0.25f));
+}
+
+/**********split_avx2********
+ *
+ * Splits 8 floats in an AVX register into two SSE registers
+ * Inputs:
+ *              __m256 values: the 8 floats
+ * Return: the 8 floats as a struct float8
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("avx2")))
+static struct float8 split_avx2(__m256 values)
+{
+        struct float8 split = { _mm256_castps256_ps128(values), 
+                                _mm256_extractf128_ps(values, 1) };
+        return split;
+}
+
+/**********rows_to_planes_avx2********
+ *
+ * AVX2 version of Colorconvert_rows_to_planes, converting 8 pixels of each
+ * scanline per step
+ * Inputs and Expects: same as Colorconvert_rows_to_planes
+ * Return: N/A
+ ************************/
+__attribute__((target("avx2")))
+static void rows_to_planes_avx2(const unsigned char *top,
+                                const unsigned char *bottom, int width,
+                                struct Colorconvert_scale scale,
+                                float *y_top, float *y_bottom,
+                                float *pbavg, float *pravg)
+{
+        int col = 0;
+
+        for (; col + PIXELS_PER_STEP <= width; col += PIXELS_PER_STEP) {
+                __m256 y[2], pb[2], pr[2];
+
+                convert8_avx2(top + col * 3, scale, &y[0], &pb[0], &pr[0]);
+                convert8_avx2(bottom + col * 3, scale, &y[1], &pb[1], &pr[1]);
+
+                _mm256_storeu_ps(y_top + col, y[0]);
+                _mm256_storeu_ps(y_bottom + col, y[1]);
+                _mm_storeu_ps(pbavg + col / 2, 
+                              average_blocks(split_avx2(pb[0]), 
+                                             split_avx2(pb[1])));
+                _mm_storeu_ps(pravg + col / 2, 
+                              average_blocks(split_avx2(pr[0]), 
+                                             split_avx2(pr[1])));
+        }
+
+        rows_to_planes_scalar(top + col * 3, bottom + col * 3, width - col,
+                              scale, y_top + col, y_bottom + col,
+                              pbavg + col / 2, pravg + col / 2);
+}
+
+/**********matrix_row_sse41********
+ *
+ * SSE4.1 version of matrix_row_avx2, working on 2 doubles at a time
+ * Inputs:
+ *              struct float8 r, g, b: the scaled channels of 8 pixels
+ *              double c0, c1, c2: one row of the color matrix
+ * Return: the 8 results as floats
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static struct float8 matrix_row_sse41(struct float8 r, struct float8 g,
+                                      struct float8 b,
+                                      double c0, double c1, double c2)
+{
+        __m128d k0 = _mm_set1_pd(c0);
+        __m128d k1 = _mm_set1_pd(c1);
+        __m128d k2 = _mm_set1_pd(c2);
+        __m128 rf[4] = { r.lo, _mm_movehl_ps(r.lo, r.lo), 
+                         r.hi, _mm_movehl_ps(r.hi, r.hi) };
+        __m128 gf[4] = { g.lo, _mm_movehl_ps(g.lo, g.lo), 
+                         g.hi, _mm_movehl_ps(g.hi, g.hi) };
+        __m128 bf[4] = { b.lo, _mm_movehl_ps(b.lo, b.lo), 
+                         b.hi, _mm_movehl_ps(b.hi, b.hi) };
+        __m128 quarter[4];
+
+        for (int i = 0; i < 4; i++) {
+                __m128d sum = _mm_add_pd(
+                        _mm_add_pd(_mm_mul_pd(k0, _mm_cvtps_pd(rf[i])),
+                                   _mm_mul_pd(k1, _mm_cvtps_pd(gf[i]))),
+                        _mm_mul_pd(k2, _mm_cvtps_pd(bf[i])));
+                quarter[i] = _mm_cvtpd_ps(sum);
+        }
+
+        struct float8 result = { _mm_movelh_ps(quarter[0], quarter[1]),
+                                 _mm_movelh_ps(quarter[2], quarter[3]) };
+        return result;
+}
+
+/**********convert8_sse41********
+ *
+ * Converts 8 interleaved RGB pixels to component video color space
+ * Inputs:
+ *              const unsigned char *rgb: the first byte of the 8 pixels
+ *              struct Colorconvert_scale scale: from Colorconvert_scale_of
+ *              struct float8 *y, *pb, *pr: where the results are written
+ * Return: N/A
+ * Expects:
+ *      * 24 readable bytes at rgb
+ ************************/
+__attribute__((target("sse4.1")))
+static void convert8_sse41(const unsigned char *rgb,
+                           struct Colorconvert_scale scale,
+                           struct float8 *y, struct float8 *pb,
+                           struct float8 *pr)
+{
+        struct rgb8 channels = deinterleave8(rgb);
+        __m128i bytes[3] = { channels.r, channels.g, channels.b };
+        struct float8 scaled[3];
+        __m128 factor = _mm_set1_ps(scale.use_reciprocal ? 
+                                        scale.reciprocal : scale.denominator);
+
+        for (int i = 0; i < 3; i++) {
+                __m128 lo = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes[i]));
+                __m128 hi = _mm_cvtepi32_ps(
+                        _mm_cvtepu8_epi32(_mm_srli_si128(bytes[i], 4)));
+                if (scale.use_reciprocal) {
+                        scaled[i].lo = _mm_mul_ps(lo, factor);
+                        scaled[i].hi = _mm_mul_ps(hi, factor);
+                } else {
+                        scaled[i].lo = _mm_div_ps(lo, factor);
+                        scaled[i].hi = _mm_div_ps(hi, factor);
+                }
+        }
+
+        *y = matrix_row_sse41(scaled[0], scaled[1], scaled[2], 
+                              0.299, 0.587, 0.114);
+        *pb = matrix_row_sse41(scaled[0], scaled[1], scaled[2], 
+                               -0.168736, -0.331264, 0.5);
+        *pr = matrix_row_sse41(scaled[0], scaled[1], scaled[2], 
+                               0.5, -0.418688, -0.081312);
+}
+
+/**********rows_to_planes_sse41********
+ *
+ * SSE4.1 version of Colorconvert_rows_to_planes, converting 8 pixels of each
+ * scanline per step
+ * Inputs and Expects: same as Colorconvert_rows_to_planes
+ * Return: N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static void rows_to_planes_sse41(const unsigned char *top,
+                                 const unsigned char *bottom, int width,
+                                 struct Colorconvert_scale scale,
+                                 float *y_top, float *y_bottom,
+                                 float *pbavg, float *pravg)
+{
+        int col = 0;
+
+        for (; col + PIXELS_PER_STEP <= width; col += PIXELS_PER_STEP) {
+                struct float8 y[2], pb[2], pr[2];
+
+                convert8_sse41(top + col * 3, scale, &y[0], &pb[0], &pr[0]);
+                convert8_sse41(bottom + col * 3, scale, &y[1], &pb[1], 
+                                                                &pr[1]);
+
+                _mm_storeu_ps(y_top + col, y[0].lo);
+                _mm_storeu_ps(y_top + col + 4, y[0].hi);
+                _mm_storeu_ps(y_bottom + col, y[1].lo);
+                _mm_storeu_ps(y_bottom + col + 4, y[1].hi);
+                _mm_storeu_ps(pbavg + col / 2, average_blocks(pb[0], pb[1]));
+                _mm_storeu_ps(pravg + col / 2, average_blocks(pr[0], pr[1]));
+        }
+
+        rows_to_planes_scalar(top + col * 3, bottom + col * 3, width - col,
+                              scale, y_top + col, y_bottom + col,
+                              pbavg + col / 2, pravg + col / 2);
+}
+
+/**********interleave_store********
+ *
+ * Writes 8 pixels of red, green and blue bytes as 24 interleaved bytes
+ * Inputs:
+ *              __m128i r, g, b: the 8 bytes of each channel in the low half
+ *              unsigned char *rgb: where the 24 bytes are written
+ * Return: N/A
+ * Expects:
+ *      * 24 writable bytes at rgb
+ * Notes:
+ *      * never writes past the 24 bytes
+ ************************/
+__attribute__((target("ssse3")))
+static void interleave_store(__m128i r, __m128i g, __m128i b, 
+                                                        unsigned char *rgb)
+{
+        __m128i rg = _mm_unpacklo_epi8(r, g);
+        __m128i first = _mm_or_si128(
+                _mm_shuffle_epi8(rg, _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5,
+                                                   -1, 6, 7, -1, 8, 9, -1, 10)),
+                _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1,
+                                                  2, -1, -1, 3, -1, -1, 4, -1)));
+        __m128i last = _mm_or_si128(
+                _mm_shuffle_epi8(rg, _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15,
+                                                   -1, -1, -1, -1, -1, -1, -1,
+                                                   -1, -1)),
+                _mm_shuffle_epi8(b, _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7,
+                                                  -1, -1, -1, -1, -1, -1, -1, 
+                                                  -1)));
+
+        _mm_storeu_si128((__m128i *)rgb, first);
+        _mm_storel_epi64((__m128i *)(rgb + 16), last);
+}
+
+/**********pack_samples********
+ *
+ * Packs 8 samples held as 32-bit ints into 8 bytes with saturating packs
+ * Inputs:
+ *              __m128i lo: the samples of pixels 0 to 3
+ *              __m128i hi: the samples of pixels 4 to 7
+ * Return: the 8 samples as bytes in the low half
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i pack_samples(__m128i lo, __m128i hi)
+{
+        __m128i words = _mm_packs_epi32(lo, hi);
+        return _mm_packus_epi16(words, words);
+}
+
+/**********round_samples********
+ *
+ * Rounds 4 nonnegative floats to the nearest integer, with halfway cases 
+ * rounded away from zero like round()
+ * Inputs:
+ *              __m128 scaled: the 4 values to be rounded
+ * Return: the 4 rounded values as 32-bit ints
+ * Expects:
+ *      * every value to be between 0 and 255
+ * Notes:
+ *      * scaled minus its truncation is exact, so comparing it with one half
+ *        decides the rounding exactly
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i round_samples(__m128 scaled)
+{
+        __m128 truncated = _mm_round_ps(scaled, _MM_FROUND_TO_ZERO | 
+                                                        _MM_FROUND_NO_EXC);
+        __m128 round_up = _mm_cmpge_ps(_mm_sub_ps(scaled, truncated),
+                                       _mm_set1_ps(0.5f));
+        __m128 rounded = _mm_add_ps(truncated, 
+                                    _mm_and_ps(round_up, _mm_set1_ps(1.0f)));
+
+        return _mm_cvttps_epi32(rounded);
+}
+
+/**********clamp_scale********
+ *
+ * Clamps 4 floats between 0 and 1 and scales them by 255, in float
+ * Inputs:
+ *              __m128 value: the 4 values
+ * Return: the 4 clamped and scaled values
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * a NaN value is clamped to 1, like fmin(1, NaN) in CVS_to_RGB
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128 clamp_scale(__m128 value)
+{
+        value = _mm_min_ps(value, _mm_set1_ps(1.0f));
+        value = _mm_max_ps(value, _mm_setzero_ps());
+        return _mm_mul_ps(value, _mm_set1_ps((float)OUTPUT_DENOMINATOR));
+}
+
+/**********channel_avx2********
+ *
+ * Rounds 8 doubles to float and turns them into 8-bit samples
+ * Inputs:
+ *              __m256d lo: the values of pixels 0 to 3
+ *              __m256d hi: the values of pixels 4 to 7
+ * Return: the 8 samples as bytes in the low half
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("avx2")))
+static __m128i channel_avx2(__m256d lo, __m256d hi)
+{
+        return pack_samples(round_samples(clamp_scale(_mm256_cvtpd_ps(lo))),
+                            round_samples(clamp_scale(_mm256_cvtpd_ps(hi))));
+}
+
+/**********planes_to_row_avx2********
+ *
+ * AVX2 version of Colorconvert_planes_to_row, converting 8 pixels per step
+ * Inputs and Expects: same as Colorconvert_planes_to_row
+ * Return: N/A
+ * Notes:
+ *      * the 0.0 * pb and 0.0 * pr terms of CVS_to_RGB are left out, since
+ *        adding a zero can only change the sign of a zero, which the clamp
+ *        removes
+ ************************/
+__attribute__((target("avx2")))
+static void planes_to_row_avx2(const float *y, const float *pbavg,
+                               const float *pravg, int width,
+                               unsigned char *rgb)
+{
+        __m256d k_r_pr = _mm256_set1_pd(1.402);
+        __m256d k_g_pb = _mm256_set1_pd(0.344136);
+        __m256d k_g_pr = _mm256_set1_pd(0.714136);
+        __m256d k_b_pb = _mm256_set1_pd(1.772);
+        int col = 0;
+
+        for (; col + PIXELS_PER_STEP <= width; col += PIXELS_PER_STEP) {
+                __m128 pb4 = _mm_loadu_ps(pbavg + col / 2);
+                __m128 pr4 = _mm_loadu_ps(pravg + col / 2);
+                /* each block's chroma is shared by its two pixels */
+                __m128 pb_pixels[2] = { _mm_unpacklo_ps(pb4, pb4),
+                                        _mm_unpackhi_ps(pb4, pb4) };
+                __m128 pr_pixels[2] = { _mm_unpacklo_ps(pr4, pr4),
+                                        _mm_unpackhi_ps(pr4, pr4) };
+                __m256d r[2], g[2], b[2];
+
+                for (int i = 0; i < 2; i++) {
+                        __m256d yd = _mm256_cvtps_pd(
+                                        _mm_loadu_ps(y + col + i * 4));
+                        __m256d pb = _mm256_cvtps_pd(pb_pixels[i]);
+                        __m256d pr = _mm256_cvtps_pd(pr_pixels[i]);
+
+                        r[i] = _mm256_add_pd(yd, _mm256_mul_pd(k_r_pr, pr));
+                        g[i] = _mm256_sub_pd(_mm256_sub_pd(yd, 
+                                                _mm256_mul_pd(k_g_pb, pb)),
+                                             _mm256_mul_pd(k_g_pr, pr));
+                        b[i] = _mm256_add_pd(yd, _mm256_mul_pd(k_b_pb, pb));
+                }
+
+                interleave_store(channel_avx2(r[0], r[1]), 
+                                 channel_avx2(g[0], g[1]),
+                                 channel_avx2(b[0], b[1]), rgb + col * 3);
+        }
+
+        planes_to_row_scalar(y + col, pbavg + col / 2, pravg + col / 2,
+                             width - col, rgb + col * 3);
+}
+
+/**********channel_sse41********
+ *
+ * SSE4.1 version of channel_avx2, for 8 values held as 4 pairs of doubles
+ * Inputs:
+ *              __m128d *pairs: the values of pixels 0-1, 2-3, 4-5 and 6-7
+ * Return: the 8 samples as bytes in the low half
+ * Expects:
+ *      * pairs to point to 4 values
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i channel_sse41(const __m128d *pairs)
+{
+        __m128 lo = _mm_movelh_ps(_mm_cvtpd_ps(pairs[0]), 
+                                  _mm_cvtpd_ps(pairs[1]));
+        __m128 hi = _mm_movelh_ps(_mm_cvtpd_ps(pairs[2]), 
+                                  _mm_cvtpd_ps(pairs[3]));
+
+        return pack_samples(round_samples(clamp_scale(lo)),
+                            round_samples(clamp_scale(hi)));
+}
+
+/**********planes_to_row_sse41********
+ *
+ * SSE4.1 version of Colorconvert_planes_to_row, converting 8 pixels per step
+ * as 4 pairs of pixels that share a block
+ * Inputs and Expects: same as Colorconvert_planes_to_row
+ * Return: N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static void planes_to_row_sse41(const float *y, const float *pbavg,
+                                const float *pravg, int width,
+                                unsigned char *rgb)
+{
+        __m128d k_r_pr = _mm_set1_pd(1.402);
+        __m128d k_g_pb = _mm_set1_pd(0.344136);
+        __m128d k_g_pr = _mm_set1_pd(0.714136);
+        __m128d k_b_pb = _mm_set1_pd(1.772);
+        int col = 0;
+
+        for (; col + PIXELS_PER_STEP <= width; col += PIXELS_PER_STEP) {
+                __m128d r[4], g[4], b[4];
+
+                for (int i = 0; i < 4; i++) {
+                        int block = col / 2 + i;
+                        __m128d yd = _mm_cvtps_pd(_mm_castsi128_ps(
+                                _mm_loadl_epi64((const __m128i *)
+                                                        (y + col + 2 * i))));
+                        __m128d pb = _mm_set1_pd(pbavg[block]);
+                        __m128d pr = _mm_set1_pd(pravg[block]);
+
+                        r[i] = _mm_add_pd(yd, _mm_mul_pd(k_r_pr, pr));
+                        g[i] = _mm_sub_pd(_mm_sub_pd(yd, 
+                                                     _mm_mul_pd(k_g_pb, pb)),
+                                          _mm_mul_pd(k_g_pr, pr));
+                        b[i] = _mm_add_pd(yd, _mm_mul_pd(k_b_pb, pb));
+                }
+
+                interleave_store(channel_sse41(r), channel_sse41(g),
+                                 channel_sse41(b), rgb + col * 3);
+        }
+
+        planes_to_row_scalar(y + col, pbavg + col / 2, pravg + col / 2,
+                             width - col, rgb + col * 3);
+}
+
+#endif
+
+/**********rows_to_planes_best********
+ *
+ * Picks the fastest version of Colorconvert_rows_to_planes at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX2, SSE4.1 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static rows_to_planes_fun *rows_to_planes_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return rows_to_planes_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return rows_to_planes_sse41;
+        }
+#endif
+        return rows_to_planes_scalar;
+}
+
+/**********planes_to_row_best********
+ *
+ * Picks the fastest version of Colorconvert_planes_to_row at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX2, SSE4.1 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static planes_to_row_fun *planes_to_row_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return planes_to_row_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return planes_to_row_sse41;
+        }
+#endif
+        return planes_to_row_scalar;
+}
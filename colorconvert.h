@@ -0,0 +1,54 @@
+/********************************************************************
+ *
+ *                          colorconvert.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for colorconvert.c
+ *
+ *     Summary:
+ *      colorconvert converts whole scanlines between interleaved 8-bit RGB
+ *      and planar component video color space (CVS). It picks an AVX2 or
+ *      SSE4.1 version when the CPU has one and a scalar version otherwise.
+ *      Every version gives exactly the same floats as the per-pixel
+ *      functions in rgbcomponent.c.
+ *
+ *******************************************************************/
+#ifndef COLORCONVERT_INCLUDED
+#define COLORCONVERT_INCLUDED
+
+#include <stdbool.h>
+
+/*
+ * This is the struct definition of the Colorconvert_scale instance, which
+ * holds what is needed to turn a sample into a float between 0 and 1
+ * Elements:
+ *      float denominator: the denominator of the image, as a float
+ *      float reciprocal: 1 / denominator
+ *      bool use_reciprocal: true if multiplying every possible sample by
+ *                           reciprocal gives the same float as dividing it by
+ *                           denominator, so the divide can be skipped
+ *
+ */
+struct Colorconvert_scale {
+        float denominator;
+        float reciprocal;
+        bool use_reciprocal;
+};
+
+struct Colorconvert_scale Colorconvert_scale_of(unsigned denominator);
+bool Colorconvert_vectorized(void);
+
+void Colorconvert_rows_to_planes(const unsigned char *top,
+                                 const unsigned char *bottom, int width,
+                                 struct Colorconvert_scale scale,
+                                 float *y_top, float *y_bottom,
+                                 float *pbavg, float *pravg);
+
+void Colorconvert_planes_to_row(const float *y, const float *pbavg,
+                                const float *pravg, int width,
+                                unsigned char *rgb);
+
+#endif
@@ -16,8 +16,17 @@
  *      values in a new 2D blocked array. 
  * 
  *     Notes:
+ *   - The planar functions do the same work on a CVS_planes, whose pb and pr
+ *     planes already hold one average per 2x2 block
+ *   - compressed_fixed_planes does it on fixed-point planes with integer
+ *     arithmetic only (see fixedcodec.h)
+ *   - Both planar encoders also convert a single row of blocks, so that
+ *     threads can encode their own rows straight into an output file
+ *   - decompressed_planes unpacks a whole row of code words at a time with
+ *     bitbatch.h
  *   - This module uses functions from these other modules: uarray2b.h, 
- *     pnm.h, rgbcomponent.h, bitpack.h, and quantization.h
+ *     pnm.h, cvsplanes.h, codewords.h, dct2x2.h, fixedcodec.h, rgbcomponent.h,
+ *     bitpack.h, bitbatch.h, chroma.h, pool.h and quantization.h
  *******************************************************************/
 #include <string.h>
 #include <stdlib.h>
@@ -25,13 +34,32 @@
 #include "assert.h"
 #include "pnm.h"
 #include "uarray2b.h"
+#include "cvsplanes.h"
+#include "codewords.h"
+#include "rgbview.h"
+#include "ppmwriter.h"
+#include "readwritecompressed.h"
+#include "wordview.h"
+#include "dct2x2.h"
+#include "fixedcodec.h"
+#include "decodetables.h"
 #include "rgbcomponent.h"
 #include "bitpack.h"
+#include "bitbatch.h"
+#include "chroma.h"
+#include "pool.h"
 #include "compress2x2.h"
 #include "quantization.h"
 
 #define COMPRESSED_BLOCK_SIZE 1
 
+/* the index of each field of a code word in the arrays of bitbatch.h */
+#define FIELD_INDEX(field, kind, width, lsb, unused) FIELD_##field,
+enum { CODEWORD_FIELD_LIST(FIELD_INDEX, 0) FIELD_COUNT };
+
+static const struct Bitbatch_layout codeword_layout = 
+                                BITBATCH_LAYOUT_OF(CODEWORD_FIELD_LIST);
+
 /**********compressed2x2s********
  *
  * Compresses a UArray2b that holds component video color space (CVS) structs 
@@ -95,19 +123,16 @@ UArray2b_T compressed2x2s(UArray2b_T componentUArray2b)
  * Return: a 32 bit word that corresponds to each 2x2 block in the UArray2b
  * Expects:
  *      componentUArray2b to be nonnull
- *      one_block to be nonnull (created within function, not passed in)
  * Notes:
  *      * to be called on every 2x2 block in the UArray2b (called in function
  *      compressed 2x2s)
  *      * checked runtime error if
  *              * componentUArray2b is NULL
- *              * one_block is NULL
  ************************/
 uint64_t compress_one_block(UArray2b_T componentUArray2b, int col, int row)
 {
         assert(componentUArray2b != NULL);
-        block_values one_block = malloc(sizeof(struct block_values));
-        assert(one_block != NULL);
+        struct block_values one_block;
 
         /* start of the discrete cosine transform */
         float Y1 = ((CVS)UArray2b_at(componentUArray2b, col, row))->y;
@@ -115,10 +140,10 @@ uint64_t compress_one_block(UArray2b_T componentUArray2b, int col, int row)
         float Y3 = ((CVS)UArray2b_at(componentUArray2b, col, row + 1))->y;
         float Y4 = ((CVS)UArray2b_at(componentUArray2b, col + 1, row + 1))->y;
 
-        one_block->a = (Y4 + Y3 + Y2 + Y1) / 4.0;
-        one_block->b = (Y4 + Y3 - Y2 - Y1) / 4.0;
-        one_block->c = (Y4 - Y3 + Y2 - Y1) / 4.0;
-        one_block->d = (Y4 - Y3 - Y2 + Y1) / 4.0;
+        one_block.a = (Y4 + Y3 + Y2 + Y1) / 4.0;
+        one_block.b = (Y4 + Y3 - Y2 - Y1) / 4.0;
+        one_block.c = (Y4 - Y3 + Y2 - Y1) / 4.0;
+        one_block.d = (Y4 - Y3 - Y2 + Y1) / 4.0;
         /* end of the discrete cosine transform */
 
         float pb1 = ((CVS)UArray2b_at(componentUArray2b, col, row))->pb;
@@ -132,11 +157,10 @@ uint64_t compress_one_block(UArray2b_T componentUArray2b, int col, int row)
         float pr4 = ((CVS)UArray2b_at(componentUArray2b, col + 1, row + 1))->pr;
                         
         /* averaging the pb and pr values for 4 pixels */
-        one_block->pbavg = (pb1 + pb2 + pb3 + pb4) / 4.0;
-        one_block->pravg = (pr1 + pr2 + pr3 + pr4) / 4.0;
+        one_block.pbavg = (pb1 + pb2 + pb3 + pb4) / 4.0;
+        one_block.pravg = (pr1 + pr2 + pr3 + pr4) / 4.0;
 
-        uint64_t one_32_bit_word = quantization(one_block);
-        free(one_block);
+        uint64_t one_32_bit_word = quantization(&one_block);
         
         return one_32_bit_word;
 }
@@ -199,13 +223,10 @@ UArray2b_T decompressed2x2s(UArray2b_T compressed_blocks)
  * Return: N/A
  * Expects:
  *      componentUArray2b to be nonnull
- *      float_block_values to be nonnull (created within function, 
- *                                        not passed in)
  * Notes:
  *      * to be used as an apply function in the UArray2b_map function
  *      * checked runtime error if
  *              * componentUArray2b is NULL
- *              * float_block_values is NULL
  ************************/
 void decompress_one_block(int col, int row, UArray2b_T compressed_blocks, 
                                         void *elem, void *componentUArray2b)
@@ -217,20 +238,17 @@ void decompress_one_block(int col, int row, UArray2b_T compressed_blocks,
          * calls modules in quantization.h to turn a 32-bit word into a struct 
          * of 6 float values 
          */
-        block_values float_block_values = 
+        struct block_values float_block_values = 
                 unpacked_floats(*(uint64_t *)UArray2b_at(compressed_blocks, 
                                                                           col, 
                                                                           row));
-        assert(float_block_values != NULL);
 
-        float a = float_block_values->a;
-        float b = float_block_values->b;
-        float c = float_block_values->c;
-        float d = float_block_values->d;
-        float pbavg = float_block_values->pbavg;
-        float pravg = float_block_values->pravg;
-
-        free(float_block_values);
+        float a = float_block_values.a;
+        float b = float_block_values.b;
+        float c = float_block_values.c;
+        float d = float_block_values.d;
+        float pbavg = float_block_values.pbavg;
+        float pravg = float_block_values.pravg;
 
         /* inverse discrete cosine transform */
         float Y1 = a - b - c + d;
@@ -240,47 +258,352 @@ void decompress_one_block(int col, int row, UArray2b_T compressed_blocks,
 
         /* repopulate the decompressed UArray2 with the four values */
 
-        CVS top_left = CVS_populator(Y1, pbavg, pravg);
-        CVS top_right = CVS_populator(Y2, pbavg, pravg);
-        CVS bottom_left = CVS_populator(Y3, pbavg, pravg);
-        CVS bottom_right = CVS_populator(Y4, pbavg, pravg);
-                        
-        *(CVS)UArray2b_at(componentUArray2b, col * 2, row * 2) = *top_left;
-        *(CVS)UArray2b_at(componentUArray2b, col * 2 + 1, row * 2) = *top_right;
+        *(CVS)UArray2b_at(componentUArray2b, col * 2, row * 2) = 
+                                        CVS_populator(Y1, pbavg, pravg);
+        *(CVS)UArray2b_at(componentUArray2b, col * 2 + 1, row * 2) = 
+                                        CVS_populator(Y2, pbavg, pravg);
         *(CVS)UArray2b_at(componentUArray2b, col * 2, row * 2 + 1) = 
-                                                                *bottom_left;
+                                        CVS_populator(Y3, pbavg, pravg);
         *(CVS)UArray2b_at(componentUArray2b, col * 2 + 1, row * 2 + 1) = 
-                                                                *bottom_right;
+                                        CVS_populator(Y4, pbavg, pravg);
+}
 
-        free(top_left);   
-        free(top_right);   
-        free(bottom_left);   
-        free(bottom_right);
+/**********CVS_populator********
+ *
+ * Populates a struct 
+ * Inputs:
+ *              float y: the y value of the pixel
+ *              float pbavg: the averaged pb value of the pixel's block
+ *              float pravg: the averaged pr value of the pixel's block
+ * Return: a CVS struct holding the 3 values
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * returns the struct by value, so nothing is allocated
+ ************************/
+struct CVS CVS_populator(float y, float pbavg, float pravg) 
+{
+        struct CVS one_pixel;
 
+        one_pixel.y = y;
+        one_pixel.pb = pbavg;
+        one_pixel.pr = pravg;
 
+        return one_pixel;
 }
 
-/**********CVS_populator********
+/**********compressed_planes********
  *
- * Populates a struct 
+ * Compresses planar component video color space (CVS) values into a buffer
+ * of 32-bit words. The 4 y values and the averaged pb and pr values of each 
+ * 2x2 block get converted into one 32-bit word.
  * Inputs:
- *              FILE *input: pointer to the input PPM file
+ *              CVS_planes planes: the y, pbavg and pravg planes of an image
+ * Return: A Codewords buffer with each 2x2 block corresponding to one 32 bit 
+ *         word
+ * Expects:
+ *      * planes to be nonnull
+ *      * frees up the memory used for the inputted planes, and allocates 
+ *        memory for the returned Codewords. The caller assumes ownership of 
+ *        the returned Codewords
+ * Notes:
+ *      * produces the same words as compressed2x2s, a whole row of blocks
+ *        at a time (see dct2x2.h)
+ *      * Checked runtime error if:
+ *              * planes is NULL
+ ************************/
+Codewords compressed_planes(CVS_planes planes)
+{
+        assert(planes != NULL);
+
+        Codewords compressed_blocks = Codewords_new(planes->chroma_width, 
+                                                    planes->chroma_height);
+
+        for (int row = 0; row < planes->chroma_height; row++) {
+                compress_planes_row(planes, row,
+                                    Codewords_row(compressed_blocks, row));
+        }
+
+        CVS_planes_free(&planes);
+        return compressed_blocks;
+}
+
+/**********compress_planes_row********
+ *
+ * Converts one row of 2x2 blocks held in planes into 32-bit words
+ * Inputs:
+ *              CVS_planes planes: the y, pbavg and pravg planes of an image
+ *              int row: the row of blocks (in blocks, not pixels)
+ *              uint32_t *words: where the chroma_width words of the row go
  * Return: N/A
  * Expects:
- *      * pointer to input PPM file to be nonnull
+ *      * planes and words to be nonnull
+ *      * row to be between 0 and chroma_height - 1
  * Notes:
+ *      * only reads planes, so rows of one image can be converted by
+ *        several threads at once
  *      * Checked runtime error if:
- *              * pointer to input PPM file is NULL
+ *              * planes or words is NULL
+ *              * row is out of range
  ************************/
-CVS CVS_populator(float y, float pbavg, float pravg) 
+void compress_planes_row(CVS_planes planes, int row, uint32_t *words)
 {
-        CVS one_pixel = malloc(sizeof(struct CVS));
-        assert(one_pixel != NULL);
+        assert(planes != NULL && words != NULL);
+        assert(row >= 0 && row < planes->chroma_height);
 
-        one_pixel->y = y;
-        one_pixel->pb = pbavg;
-        one_pixel->pr = pravg;
+        float *y_top = planes->y + (size_t)(row * 2) * planes->width;
+        size_t chroma_index = (size_t)row * planes->chroma_width;
 
-        return one_pixel;
+        Dct2x2_rows_to_words(y_top, y_top + planes->width,
+                             planes->pbavg + chroma_index,
+                             planes->pravg + chroma_index,
+                             planes->chroma_width, words);
 }
 
+/**********compress_planes_block********
+ *
+ * Converts the 4 y values and the averaged pb and pr values of one 2x2 block
+ * into one 32 bit word
+ * Inputs:
+ *              CVS_planes planes: the planes holding the block
+ *              int col: the column of the block (in blocks, not pixels)
+ *              int row: the row of the block (in blocks, not pixels)
+ * Return: the 32 bit word that corresponds to the 2x2 block
+ * Expects:
+ *      planes to be nonnull
+ * Notes:
+ *      * uses the same discrete cosine transform as compress_one_block, so 
+ *        the resulting word is identical
+ *      * checked runtime error if
+ *              * planes is NULL
+ ************************/
+uint64_t compress_planes_block(CVS_planes planes, int col, int row)
+{
+        assert(planes != NULL);
+        struct block_values one_block;
+
+        float *y_top = planes->y + (size_t)(row * 2) * planes->width + col * 2;
+        float *y_bottom = y_top + planes->width;
+
+        /* start of the discrete cosine transform */
+        float Y1 = y_top[0];
+        float Y2 = y_top[1];
+        float Y3 = y_bottom[0];
+        float Y4 = y_bottom[1];
+
+        one_block.a = (Y4 + Y3 + Y2 + Y1) / 4.0;
+        one_block.b = (Y4 + Y3 - Y2 - Y1) / 4.0;
+        one_block.c = (Y4 - Y3 + Y2 - Y1) / 4.0;
+        one_block.d = (Y4 - Y3 - Y2 + Y1) / 4.0;
+        /* end of the discrete cosine transform */
+
+        size_t chroma_index = (size_t)row * planes->chroma_width + col;
+        one_block.pbavg = planes->pbavg[chroma_index];
+        one_block.pravg = planes->pravg[chroma_index];
+
+        return quantization(&one_block);
+}
+
+/**********decompressed_planes********
+ *
+ * Decompresses a buffer of 32-bit words into planar component video color
+ * space (CVS) values. Each 32-bit word gets converted into 4 y values and one
+ * pb and pr value for its 2x2 block.
+ * Inputs:
+ *              Codewords compressed_blocks: The buffer of 32-bit words
+ * Return: A CVS_planes holding the decompressed image
+ * Expects:
+ *      * compressed_blocks to be non NULL
+ *      * frees up the memory used for the inputted Codewords, and allocates 
+ *        memory for the returned CVS_planes. The caller assumes ownership of 
+ *        the returned CVS_planes
+ * Notes:
+ *      * Checked runtime error if:
+ *              * compressed_blocks is NULL
+ ************************/
+CVS_planes decompressed_planes(Codewords compressed_blocks)
+{
+        assert(compressed_blocks != NULL);
+
+        int width = compressed_blocks->width;
+        CVS_planes planes = CVS_planes_new(width * 2, 
+                                           compressed_blocks->height * 2);
+
+        /* one row of each field, all in one allocation */
+        int8_t *values = Pool_alloc((size_t)width * FIELD_COUNT);
+        int8_t *fields[FIELD_COUNT];
+        for (int i = 0; i < FIELD_COUNT; i++) {
+                fields[i] = values + (size_t)i * width;
+        }
+
+        for (int row = 0; row < compressed_blocks->height; row++) {
+                Bitbatch_unpack(&codeword_layout, 
+                                Codewords_row(compressed_blocks, row), 
+                                width, fields);
+                decompress_planes_row(planes, row, fields);
+        }
+        Pool_free(values);
+        Codewords_free(&compressed_blocks);
+
+        return planes;
+}
+
+/**********decompress_planes_row********
+ *
+ * Converts the unpacked fields of a row of 32-bit words to the y values and
+ * the pb and pr values of its 2x2 blocks, and stores them in planes
+ * Inputs:
+ *              CVS_planes planes: the planes where the results are put
+ *              int row: the row of the blocks (in blocks, not pixels)
+ *              int8_t *const fields[]: the values of each field of the
+ *                                      row's words, as unpacked by 
+ *                                      Bitbatch_unpack with the layout of
+ *                                      quantization.h
+ * Return: N/A
+ * Expects:
+ *      * planes and fields to be nonnull
+ * Notes:
+ *      * gives exactly the floats decompress_planes_block gives for each
+ *        word
+ *      * checked runtime error if
+ *              * planes or fields is NULL
+ ************************/
+void decompress_planes_row(CVS_planes planes, int row, 
+                           int8_t *const fields[])
+{
+        assert(planes != NULL && fields != NULL);
+
+        float *y_top = planes->y + (size_t)(row * 2) * planes->width;
+        float *y_bottom = y_top + planes->width;
+        float *pbavg = planes->pbavg + (size_t)row * planes->chroma_width;
+        float *pravg = planes->pravg + (size_t)row * planes->chroma_width;
+
+        for (int col = 0; col < planes->chroma_width; col++) {
+                float a = fields[FIELD_a][col] / A_CODE;
+                float b = unquantized_5bit(fields[FIELD_b][col]);
+                float c = unquantized_5bit(fields[FIELD_c][col]);
+                float d = unquantized_5bit(fields[FIELD_d][col]);
+
+                pbavg[col] = Chroma_of_index(fields[FIELD_pb][col]);
+                pravg[col] = Chroma_of_index(fields[FIELD_pr][col]);
+
+                /* inverse discrete cosine transform */
+                y_top[col * 2] = a - b - c + d;
+                y_top[col * 2 + 1] = a - b + c - d;
+                y_bottom[col * 2] = a + b - c - d;
+                y_bottom[col * 2 + 1] = a + b + c + d;
+        }
+}
+
+/**********decompress_planes_block********
+ *
+ * Converts one 32-bit word to the 4 y values and the pb and pr values of its
+ * 2x2 block, and stores them in planes
+ * Inputs:
+ *              CVS_planes planes: the planes where the results are put
+ *              int col: the column of the block (in blocks, not pixels)
+ *              int row: the row of the block (in blocks, not pixels)
+ *              uint32_t word: the 32-bit word of the block
+ * Return: N/A
+ * Expects:
+ *      planes to be nonnull
+ * Notes:
+ *      * checked runtime error if
+ *              * planes is NULL
+ ************************/
+void decompress_planes_block(CVS_planes planes, int col, int row, 
+                                                        uint32_t word)
+{
+        assert(planes != NULL);
+
+        struct block_values float_block_values = unpacked_floats(word);
+
+        float a = float_block_values.a;
+        float b = float_block_values.b;
+        float c = float_block_values.c;
+        float d = float_block_values.d;
+
+        size_t chroma_index = (size_t)row * planes->chroma_width + col;
+        planes->pbavg[chroma_index] = float_block_values.pbavg;
+        planes->pravg[chroma_index] = float_block_values.pravg;
+
+        /* inverse discrete cosine transform */
+        float *y_top = planes->y + (size_t)(row * 2) * planes->width + col * 2;
+        float *y_bottom = y_top + planes->width;
+
+        y_top[0] = a - b - c + d;
+        y_top[1] = a - b + c - d;
+        y_bottom[0] = a + b - c - d;
+        y_bottom[1] = a + b + c + d;
+}
+
+/**********compressed_fixed_planes********
+ *
+ * Compresses fixed-point planar component video color space (CVS) values 
+ * into a buffer of 32-bit words, using integer arithmetic only
+ * Inputs:
+ *              CVS_planes16 planes: the y, pbavg and pravg planes of an image,
+ *                                   with CVS_FIXED_SHIFT fractional bits
+ * Return: A Codewords buffer with each 2x2 block corresponding to one 32 bit 
+ *         word
+ * Expects:
+ *      * planes to be nonnull
+ *      * frees up the memory used for the inputted planes, and allocates 
+ *        memory for the returned Codewords. The caller assumes ownership of 
+ *        the returned Codewords
+ * Notes:
+ *      * the words can differ from compressed_planes near a rounding 
+ *        boundary; the rounding is documented in fixedcodec.c
+ *      * Checked runtime error if:
+ *              * planes is NULL
+ ************************/
+Codewords compressed_fixed_planes(CVS_planes16 planes)
+{
+        assert(planes != NULL);
+
+        Codewords compressed_blocks = Codewords_new(planes->chroma_width, 
+                                                    planes->chroma_height);
+
+        for (int row = 0; row < planes->chroma_height; row++) {
+                compress_fixed_planes_row(planes, row,
+                                          Codewords_row(compressed_blocks,
+                                                        row));
+        }
+
+        CVS_planes16_free(&planes);
+        return compressed_blocks;
+}
+
+/**********compress_fixed_planes_row********
+ *
+ * Converts one row of 2x2 blocks held in fixed-point planes into 32-bit
+ * words with the integer-only encoder
+ * Inputs:
+ *              CVS_planes16 planes: the y, pbavg and pravg planes of an
+ *                                   image
+ *              int row: the row of blocks (in blocks, not pixels)
+ *              uint32_t *words: where the chroma_width words of the row go
+ * Return: N/A
+ * Expects:
+ *      * planes and words to be nonnull
+ *      * row to be between 0 and chroma_height - 1
+ * Notes:
+ *      * only reads planes, so rows of one image can be converted by
+ *        several threads at once
+ *      * Checked runtime error if:
+ *              * planes or words is NULL
+ *              * row is out of range
+ ************************/
+void compress_fixed_planes_row(CVS_planes16 planes, int row, uint32_t *words)
+{
+        assert(planes != NULL && words != NULL);
+        assert(row >= 0 && row < planes->chroma_height);
+
+        int16_t *y_top = planes->y + (size_t)(row * 2) * planes->width;
+        size_t chroma_index = (size_t)row * planes->chroma_width;
+
+        Fixedcodec_rows_to_words(y_top, y_top + planes->width,
+                                 planes->pbavg + chroma_index,
+                                 planes->pravg + chroma_index,
+                                 planes->chroma_width, words);
+}
@@ -24,6 +24,20 @@ void decompress_one_block(int col, int row, UArray2b_T compressed_blocks,
                                         void *elem, void *componentUArray2b);
 
 uint64_t compress_one_block(UArray2b_T componentUArray2b, int col, int row);
-CVS CVS_populator(float y, float pbavg, float pravg);
+struct CVS CVS_populator(float y, float pbavg, float pravg);
+
+/* the same conversions, working on planar component video */
+Codewords compressed_planes(CVS_planes planes);
+void compress_planes_row(CVS_planes planes, int row, uint32_t *words);
+uint64_t compress_planes_block(CVS_planes planes, int col, int row);
+CVS_planes decompressed_planes(Codewords compressed_blocks);
+void decompress_planes_row(CVS_planes planes, int row, 
+                           int8_t *const fields[]);
+void decompress_planes_block(CVS_planes planes, int col, int row, 
+                                                        uint32_t word);
+
+/* the integer-only encoder, working on fixed-point planes */
+Codewords compressed_fixed_planes(CVS_planes16 planes);
+void compress_fixed_planes_row(CVS_planes16 planes, int row, uint32_t *words);
 
 #endif
\ No newline at end of file
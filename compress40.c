@@ -16,8 +16,31 @@
  * 
  *     Notes:
  *   - This file calls functions from modules rgbcomponent.h, compress2x2.h,
- *     readwritecompressed.h, a2methods.h, a2blocked.h, and uarray2b,
+ *     readwritecompressed.h, a2methods.h, a2blocked.h, cvsplanes.h, 
+ *     codewords.h, codecopts.h, decodetables.h, graymap.h, rgbview.h,
+ *     ppmwriter.h, wordview.h, outputmap.h, bands.h, pool.h and uarray2b,
  *     to compress and decompress the images as appropriate
+ *   - The YCoCg-R transform mode writes format COMPRESSED_YCOCG in the
+ *     header, and decompress40 picks the inverse from the header, whatever
+ *     the options say
+ *   - PPM input is read by rgbview.h, which parses a P6 image in place in
+ *     the mapped file instead of copying it into a blocked pixmap
+ *   - PGM input takes the graymap fast path whatever the options say, and
+ *     decompresses to P5
+ *   - Compressed images are read in place by wordview.h, and the table
+ *     decoder takes their code words a row at a time from the mapped file,
+ *     in either container of readwritecompressed.h
+ *   - --native writes compressed images in the native container
+ *   - Decompressed images are written by ppmwriter.h as they are decoded,
+ *     without building a pixmap for Pnm_ppmwrite
+ *   - With -o, the output file is sized and mapped before anything is
+ *     coded (see outputmap.h), and the table decoder's bands of rows are
+ *     decoded by the threads of bands.h straight into the file. The
+ *     planar encoders' rows of code words are encoded the same way,
+ *     straight into the compressed file by readwritecompressed.h. Other
+ *     outputs are made whole first and then written to the file
+ *   - Each image ends with Pool_reset, so the buffers of one image are
+ *     kept for the next one when many images are converted in one process
  *     
  *******************************************************************/
 #include <string.h>
@@ -29,9 +52,56 @@
 #include "a2methods.h"
 #include "a2blocked.h"
 #include "uarray2b.h"
+#include "cvsplanes.h"
+#include "codewords.h"
+#include "codecopts.h"
+#include "decodetables.h"
+#include "graymap.h"
+#include "rgbview.h"
+#include "ppmwriter.h"
+#include "pool.h"
+#include "readwritecompressed.h"
+#include "inputmap.h"
+#include "wordview.h"
+#include "outputmap.h"
+#include "bands.h"
 #include "rgbcomponent.h"
 #include "compress2x2.h"
-#include "readwritecompressed.h"
+
+/* the P6 header of a decompressed image, and room for the longest one */
+#define P6_FORMAT "P6\n%u %u\n%u\n"
+#define HEADER_BYTES 32
+#define DENOMINATOR 255
+/* the fewest rows of code words worth a thread when decoding */
+#define MIN_BAND_ROWS 32
+
+/*
+ * This is the struct definition of an image being decoded into a mapped
+ * file, which is shared by the bands of decode_to_file
+ * Elements:
+ *      Wordview view: the code words
+ *      const struct Decodetables *tables: the tables to decode with
+ *      unsigned char *raster: the first byte of the raster in the file
+ *
+ */
+struct decoding {
+        Wordview view;
+        const struct Decodetables *tables;
+        unsigned char *raster;
+};
+
+static void report_differences(Codewords float_blocks, 
+                                                Codewords fixed_blocks);
+static void write_words(Codewords compressed_blocks, Compressed_format format,
+                        struct Codec_options options);
+static void encode_to_file(Rgbview view, struct Codec_options options);
+static const uint32_t *planes_row(void *closure, int row, uint32_t *words);
+static const uint32_t *fixed_row(void *closure, int row, uint32_t *words);
+static void decode_to_file(Wordview view, const struct Decodetables *tables,
+                           const char *path);
+static void decode_band(void *closure, int first, int last);
+static FILE *open_output(const char *path);
+static void close_output(FILE *output);
 
 // TODO:
 // 1) FINISH LAST FUNCTION CONTRACTS - DONE
@@ -57,6 +127,17 @@
  * Expects:
  *      * pointer to input PPM file to be nonnull
  * Notes:
+ *      * uses the float or the integer-only pipeline, or the YCoCg-R
+ *        transform, as set in codecopts.h. The YCoCg-R transform ignores the
+ *        arithmetic and conformance options.
+ *      * PGM images are compressed by the graymap fast path instead, with no
+ *        chroma work, and written with format COMPRESSED_GRAY
+ *        In conformance mode both encoders run, every code word where they 
+ *        differ is reported to standard error, and the words of the chosen
+ *        pipeline are written
+ *      * the code words go to the file named by -o instead of standard
+ *        output if there is one (see codecopts.h). Then the planar encoders
+ *        encode bands of rows straight into the file (see encode_to_file)
  *      * Checked runtime error if:
  *              * pointer to input PPM file is NULL
  ************************/
@@ -65,14 +146,103 @@ void compress40(FILE *input)
         assert(input != NULL);
         A2Methods_T methods = uarray2_methods_blocked; 
         assert(methods != NULL);
+        struct Codec_options options = Codecopts_get();
 
-        Pnm_ppm og_image = Pnm_ppmread(input, methods);
-        Pnm_ppm image_trimmed = trimmed_image(og_image);
-        UArray2b_T componentUArray2b = RGBtoComponentVideo(image_trimmed);
-        UArray2b_T compressed_blocks = compressed2x2s(componentUArray2b);
-        print_to_stdout(compressed_blocks);
+        Inputmap map = Inputmap_new(input);
+
+        if (Graymap_is_next(map)) {
+                Graymap graymap = Graymap_map(map);
+                write_words(GraymaptoWords(graymap), COMPRESSED_GRAY,
+                            options);
+                Pool_reset();
+                return;
+        }
+
+        Rgbview view = Rgbview_map(map, methods);
+        Rgbview_trim(view);
+        if (options.output != NULL && !options.conformance &&
+            options.transform != CODEC_YCOCG) {
+                encode_to_file(view, options);
+                Pool_reset();
+                return;
+        }
+        Codewords compressed_blocks;
+        Compressed_format format = COMPRESSED_YPBPR;
+
+        if (options.transform == CODEC_YCOCG) {
+                compressed_blocks = RGBtoYcocgWords(view);
+                Rgbview_free(&view);
+                format = COMPRESSED_YCOCG;
+        } else if (options.conformance) {
+                Codewords fixed_blocks = compressed_fixed_planes(
+                                        RGBtoFixedPlanes(view));
+                CVS_planes component_planes = RGBtoComponentPlanes(view);
+                Rgbview_free(&view);
+                Codewords float_blocks = compressed_planes(component_planes);
+                report_differences(float_blocks, fixed_blocks);
+
+                if (options.arithmetic == CODEC_FIXED) {
+                        compressed_blocks = fixed_blocks;
+                        Codewords_free(&float_blocks);
+                } else {
+                        compressed_blocks = float_blocks;
+                        Codewords_free(&fixed_blocks);
+                }
+        } else if (options.arithmetic == CODEC_FIXED) {
+                CVS_planes16 fixed_planes = RGBtoFixedPlanes(view);
+                Rgbview_free(&view);
+                compressed_blocks = compressed_fixed_planes(fixed_planes);
+        } else {
+                CVS_planes component_planes = RGBtoComponentPlanes(view);
+                Rgbview_free(&view);
+                compressed_blocks = compressed_planes(component_planes);
+        }
+        write_words(compressed_blocks, format, options);
+        Pool_reset();
 } 
 
+/**********report_differences********
+ *
+ * Reports to standard error every code word where the integer-only encoder
+ * differs from the float encoder, followed by a count
+ * Inputs:
+ *              Codewords float_blocks: the words of the float encoder
+ *              Codewords fixed_blocks: the words of the integer-only encoder
+ * Return: N/A
+ * Expects:
+ *      * float_blocks and fixed_blocks to be nonnull and the same size
+ * Notes:
+ *      * does not free either buffer
+ *      * Checked runtime error if:
+ *              * either buffer is NULL
+ *              * the buffers are different sizes
+ ************************/
+static void report_differences(Codewords float_blocks, Codewords fixed_blocks)
+{
+        assert(float_blocks != NULL && fixed_blocks != NULL);
+        assert(float_blocks->width == fixed_blocks->width);
+        assert(float_blocks->height == fixed_blocks->height);
+        size_t differences = 0;
+
+        for (int row = 0; row < float_blocks->height; row++) {
+                uint32_t *float_words = Codewords_row(float_blocks, row);
+                uint32_t *fixed_words = Codewords_row(fixed_blocks, row);
+                for (int col = 0; col < float_blocks->width; col++) {
+                        if (float_words[col] != fixed_words[col]) {
+                                fprintf(stderr, "conformance: block (%d, %d)"
+                                        " float 0x%08x fixed 0x%08x\n", col, 
+                                        row, (unsigned)float_words[col], 
+                                        (unsigned)fixed_words[col]);
+                                differences++;
+                        }
+                }
+        }
+
+        fprintf(stderr, "conformance: %zu of %zu code words differ\n", 
+                differences, 
+                (size_t)float_blocks->width * float_blocks->height);
+}
+
 /**********decompress40********
  *
  * Reads in a compressed binary image, and writes an decompressed PPM image to
@@ -84,16 +254,267 @@ void compress40(FILE *input)
  * Expects:
  *      * pointer to input file to be nonnull
  * Notes:
+ *      * decodes with the tables of the float or the integer-only pipeline,
+ *        as set in codecopts.h. If this build's float arithmetic can't be
+ *        matched by tables, the float pipeline decodes through CVS_planes
+ *        instead
+ *      * images in format COMPRESSED_YCOCG always decode with the YCoCg-R
+ *        tables, and images in format COMPRESSED_GRAY decode to a P5 image
+ *      * the image goes to the file named by -o instead of standard output
+ *        if there is one (see codecopts.h)
  *      * Checked runtime error if:
  *              * pointer to input file is NULL
  ************************/
 void decompress40(FILE *input)
 {
         assert(input != NULL);
-        UArray2b_T compressed_blocks = read_compressed_file(input);
-        UArray2b_T decompressed_component = decompressed2x2s(compressed_blocks);
-        Pnm_ppm decompressed_to_rgb = 
-                                ComponentVideotoRGB(decompressed_component);
-        Pnm_ppmwrite(stdout, decompressed_to_rgb);
-        Pnm_ppmfree(&decompressed_to_rgb);
-}  
\ No newline at end of file
+        struct Codec_options options = Codecopts_get();
+        Wordview view = Wordview_read(input);
+
+        if (view->format == COMPRESSED_GRAY) {
+                Graymap graymap = WordstoGraymap(Wordview_codewords(view));
+                Wordview_free(&view);
+                FILE *output = open_output(options.output);
+                Graymap_write(output, graymap);
+                close_output(output);
+                Graymap_free(&graymap);
+                Pool_reset();
+                return;
+        }
+
+        const struct Decodetables *tables;
+
+        if (view->format == COMPRESSED_YCOCG) {
+                tables = Decodetables_ycocg();
+        } else if (options.arithmetic == CODEC_FIXED) {
+                tables = Decodetables_fixed();
+        } else {
+                tables = Decodetables_float();
+        }
+
+        if (tables != NULL && options.output != NULL) {
+                decode_to_file(view, tables, options.output);
+                Wordview_free(&view);
+                Pool_reset();
+                return;
+        }
+
+        FILE *output = open_output(options.output);
+        Ppmwriter writer = Ppmwriter_new(output, view->width * 2,
+                                         view->height * 2);
+        if (tables != NULL) {
+                TableViewtoP6(view, tables, writer);
+        } else {
+                CVS_planes decompressed_component = 
+                        decompressed_planes(Wordview_codewords(view));
+                ComponentPlanestoP6(decompressed_component, writer);
+        }
+        Wordview_free(&view);
+        Ppmwriter_finish(&writer);
+        close_output(output);
+        Pool_reset();
+}  
+
+/**********encode_to_file********
+ *
+ * Compresses an image with one of the planar encoders into the file named
+ * by -o, with bands of rows of code words encoded by their own threads
+ * straight into the mapped file
+ * Inputs:
+ *              Rgbview view: the trimmed image, which this frees
+ *              struct Codec_options options: the arithmetic, output and
+ *                                            container
+ * Return: N/A
+ * Expects:
+ *      * view to be nonnull and options.output to name a file
+ * Notes:
+ *      * the planes are built whole first, by one thread, and only read
+ *        while the rows are encoded
+ *      * writes the same bytes as compressing to standard output
+ *      * Checked runtime error if:
+ *              * view or options.output is NULL
+ ************************/
+static void encode_to_file(Rgbview view, struct Codec_options options)
+{
+        assert(view != NULL && options.output != NULL);
+        Compressed_container container = options.native ? COMPRESSED_NATIVE
+                                                        : COMPRESSED_TEXT;
+
+        if (options.arithmetic == CODEC_FIXED) {
+                CVS_planes16 planes = RGBtoFixedPlanes(view);
+                Rgbview_free(&view);
+                encode_compressed_file(planes->chroma_width,
+                                       planes->chroma_height,
+                                       COMPRESSED_YPBPR, container,
+                                       fixed_row, planes, options.output);
+                CVS_planes16_free(&planes);
+        } else {
+                CVS_planes planes = RGBtoComponentPlanes(view);
+                Rgbview_free(&view);
+                encode_compressed_file(planes->chroma_width,
+                                       planes->chroma_height,
+                                       COMPRESSED_YPBPR, container,
+                                       planes_row, planes, options.output);
+                CVS_planes_free(&planes);
+        }
+}
+
+/**********planes_row********
+ *
+ * Encodes one row of blocks of float planes for encode_compressed_file
+ * Inputs:
+ *              void *closure: the CVS_planes
+ *              int row: the row of blocks
+ *              uint32_t *words: where the row of code words goes
+ * Return: words
+ * Expects:
+ *      * closure and words to be nonnull and row in range
+ ************************/
+static const uint32_t *planes_row(void *closure, int row, uint32_t *words)
+{
+        compress_planes_row(closure, row, words);
+        return words;
+}
+
+/**********fixed_row********
+ *
+ * Encodes one row of blocks of fixed-point planes for
+ * encode_compressed_file
+ * Inputs:
+ *              void *closure: the CVS_planes16
+ *              int row: the row of blocks
+ *              uint32_t *words: where the row of code words goes
+ * Return: words
+ * Expects:
+ *      * closure and words to be nonnull and row in range
+ ************************/
+static const uint32_t *fixed_row(void *closure, int row, uint32_t *words)
+{
+        compress_fixed_planes_row(closure, row, words);
+        return words;
+}
+
+/**********write_words********
+ *
+ * Writes the code words of a compressed image to standard output, or to
+ * the file named by -o, in the container the options ask for
+ * Inputs:
+ *              Codewords compressed_blocks: the code words
+ *              Compressed_format format: the format number for the header
+ *              struct Codec_options options: the output and container
+ * Return: N/A
+ * Expects:
+ *      * compressed_blocks to be nonnull
+ * Notes:
+ *      * frees up memory for the inputted Codewords
+ ************************/
+static void write_words(Codewords compressed_blocks, Compressed_format format,
+                        struct Codec_options options)
+{
+        Compressed_container container = options.native ? COMPRESSED_NATIVE
+                                                        : COMPRESSED_TEXT;
+
+        if (options.output == NULL) {
+                print_to_stdout(compressed_blocks, format, container);
+        } else {
+                write_compressed_file(compressed_blocks, format, container,
+                                      options.output);
+        }
+}
+
+/**********decode_to_file********
+ *
+ * Decodes a compressed image with the table-driven decoder into a P6 file,
+ * with every band of rows decoded by its own thread straight into the
+ * mapped file
+ * Inputs:
+ *              Wordview view: the code words of the image
+ *              const struct Decodetables *tables: the tables to decode with
+ *              const char *path: the name of the file, which is created or
+ *                                replaced
+ * Return: N/A
+ * Expects:
+ *      * all arguments to be nonnull
+ * Notes:
+ *      * the file holds the same bytes the writer of ppmwriter.h would
+ *        write to standard output
+ ************************/
+static void decode_to_file(Wordview view, const struct Decodetables *tables,
+                           const char *path)
+{
+        unsigned width = view->width * 2;
+        unsigned height = view->height * 2;
+        char header[HEADER_BYTES];
+        int header_bytes = snprintf(header, HEADER_BYTES, P6_FORMAT, width,
+                                    height, DENOMINATOR);
+
+        Outputmap map = Outputmap_new(path, header_bytes +
+                                            (size_t)width * 3 * height);
+        memcpy(map->bytes, header, header_bytes);
+        struct decoding decoding = { view, tables,
+                                     map->bytes + header_bytes };
+        Bands_run(view->height, MIN_BAND_ROWS, decode_band, &decoding);
+        Outputmap_finish(&map);
+}
+
+/**********decode_band********
+ *
+ * Decodes a band of rows of code words into their place in a mapped file
+ * Inputs:
+ *              void *closure: the struct decoding
+ *              int first: the first row of the band
+ *              int last: one past the last row of the band
+ * Return: N/A
+ * Expects:
+ *      * closure to be nonnull
+ *      * the rows to be in range
+ ************************/
+static void decode_band(void *closure, int first, int last)
+{
+        struct decoding *decoding = closure;
+
+        TableViewtoRows(decoding->view, decoding->tables, first, last,
+                        decoding->raster);
+}
+
+/**********open_output********
+ *
+ * Opens where a decompressed image is written
+ * Inputs:
+ *              const char *path: the file named by -o, or NULL
+ * Return: the opened file, or stdout if path is NULL
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * checked runtime error if the file can't be opened
+ ************************/
+static FILE *open_output(const char *path)
+{
+        if (path == NULL) {
+                return stdout;
+        }
+
+        FILE *output = fopen(path, "wb");
+        assert(output != NULL);
+        return output;
+}
+
+/**********close_output********
+ *
+ * Closes what open_output opened
+ * Inputs:
+ *              FILE *output: the file from open_output
+ * Return: N/A
+ * Expects:
+ *      * output to be nonnull
+ * Notes:
+ *      * stdout is left open
+ *      * checked runtime error if the file can't be closed
+ ************************/
+static void close_output(FILE *output)
+{
+        if (output != stdout) {
+                int closed = fclose(output);
+                assert(closed == 0);
+        }
+}
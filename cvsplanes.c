@@ -0,0 +1,232 @@
+/********************************************************************
+ *
+ *                          cvsplanes.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for cvsplanes.h
+ *
+ *     Summary:
+ *      cvsplanes holds an image in component video color space (CVS) as
+ *      separate planes instead of an array of CVS structs. The Y plane keeps
+ *      one value per pixel, and the Pb and Pr planes keep one averaged value
+ *      per 2x2 block, since that average is all the 32-bit code word stores.
+ *      A 16-bit fixed-point version of the planes is also provided.
+ *
+ *     Notes:
+ *   - Every plane starts on a POOL_ALIGNMENT byte boundary so that vector
+ *     loops can use aligned loads on the first element of a plane
+ *   - The planes come from pool.h, so the planes of one image are reused
+ *     by the next
+ *   - This module uses functions from pool.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "assert.h"
+#include "pool.h"
+#include "cvsplanes.h"
+
+#define FIXED_MIN -32768
+#define FIXED_MAX 32767
+
+static void *plane_alloc(size_t count, size_t size);
+static int16_t to_fixed(float value);
+
+/**********plane_alloc********
+ *
+ * Allocates one aligned plane of count elements, each of size bytes
+ * Inputs:
+ *              size_t count: the number of elements in the plane
+ *              size_t size: the size (in bytes) of each element
+ * Return: a pointer to the new plane
+ * Expects:
+ *      * the allocation to succeed
+ * Notes:
+ *      * a plane with zero elements still gets a valid pointer, so it can be
+ *        freed like any other plane
+ *      * the plane comes from pool.h and must be freed with Pool_free
+ *      * checked runtime error if the memory can't be allocated
+ ************************/
+static void *plane_alloc(size_t count, size_t size)
+{
+        return Pool_alloc(count * size);
+}
+
+/**********CVS_planes_new********
+ *
+ * Allocates float planes for an image of width x height pixels
+ * Inputs:
+ *              int width: the width of the image in pixels
+ *              int height: the height of the image in pixels
+ * Return: a new CVS_planes with a full resolution y plane and half
+ *         resolution pbavg and pravg planes
+ * Expects:
+ *      * width and height to be even and nonnegative
+ * Notes:
+ *      * the contents of the planes are uninitialized
+ *      * the caller must free the planes with CVS_planes_free
+ *      * checked runtime error if:
+ *              * width or height is negative or odd
+ ************************/
+CVS_planes CVS_planes_new(int width, int height)
+{
+        assert(width >= 0 && width % 2 == 0);
+        assert(height >= 0 && height % 2 == 0);
+
+        CVS_planes planes = malloc(sizeof(struct CVS_planes));
+        assert(planes != NULL);
+
+        planes->width = width;
+        planes->height = height;
+        planes->chroma_width = width / 2;
+        planes->chroma_height = height / 2;
+
+        size_t chroma_count = (size_t)planes->chroma_width *
+                                                        planes->chroma_height;
+        planes->y = plane_alloc((size_t)width * height, sizeof(float));
+        planes->pbavg = plane_alloc(chroma_count, sizeof(float));
+        planes->pravg = plane_alloc(chroma_count, sizeof(float));
+
+        return planes;
+}
+
+/**********CVS_planes_free********
+ *
+ * Deallocates a CVS_planes and all three of its planes
+ * Inputs:
+ *              CVS_planes *planes: pointer to the CVS_planes to be freed
+ * Return: N/A
+ * Expects:
+ *      * planes and *planes to be nonnull
+ * Notes:
+ *      * sets *planes to NULL
+ *      * checked runtime error if planes or *planes is NULL
+ ************************/
+void CVS_planes_free(CVS_planes *planes)
+{
+        assert(planes != NULL && *planes != NULL);
+
+        Pool_free((*planes)->y);
+        Pool_free((*planes)->pbavg);
+        Pool_free((*planes)->pravg);
+        free(*planes);
+        *planes = NULL;
+}
+
+/**********CVS_planes16_new********
+ *
+ * Allocates fixed-point planes for an image of width x height pixels
+ * Inputs:
+ *              int width: the width of the image in pixels
+ *              int height: the height of the image in pixels
+ * Return: a new CVS_planes16 with a full resolution y plane and half
+ *         resolution pbavg and pravg planes
+ * Expects:
+ *      * width and height to be even and nonnegative
+ * Notes:
+ *      * the contents of the planes are uninitialized
+ *      * the caller must free the planes with CVS_planes16_free
+ *      * checked runtime error if:
+ *              * width or height is negative or odd
+ ************************/
+CVS_planes16 CVS_planes16_new(int width, int height)
+{
+        assert(width >= 0 && width % 2 == 0);
+        assert(height >= 0 && height % 2 == 0);
+
+        CVS_planes16 planes = malloc(sizeof(struct CVS_planes16));
+        assert(planes != NULL);
+
+        planes->width = width;
+        planes->height = height;
+        planes->chroma_width = width / 2;
+        planes->chroma_height = height / 2;
+
+        size_t chroma_count = (size_t)planes->chroma_width *
+                                                        planes->chroma_height;
+        planes->y = plane_alloc((size_t)width * height, sizeof(int16_t));
+        planes->pbavg = plane_alloc(chroma_count, sizeof(int16_t));
+        planes->pravg = plane_alloc(chroma_count, sizeof(int16_t));
+
+        return planes;
+}
+
+/**********CVS_planes16_free********
+ *
+ * Deallocates a CVS_planes16 and all three of its planes
+ * Inputs:
+ *              CVS_planes16 *planes: pointer to the CVS_planes16 to be freed
+ * Return: N/A
+ * Expects:
+ *      * planes and *planes to be nonnull
+ * Notes:
+ *      * sets *planes to NULL
+ *      * checked runtime error if planes or *planes is NULL
+ ************************/
+void CVS_planes16_free(CVS_planes16 *planes)
+{
+        assert(planes != NULL && *planes != NULL);
+
+        Pool_free((*planes)->y);
+        Pool_free((*planes)->pbavg);
+        Pool_free((*planes)->pravg);
+        free(*planes);
+        *planes = NULL;
+}
+
+/**********CVS_planes_to_fixed********
+ *
+ * Converts float planes into fixed-point planes
+ * Inputs:
+ *              CVS_planes planes: the float planes to be converted
+ * Return: a new CVS_planes16 holding every value of planes rounded to the
+ *         nearest multiple of 1 / (1 << CVS_FIXED_SHIFT)
+ * Expects:
+ *      * planes to be nonnull
+ * Notes:
+ *      * does not free the inputted planes. The caller assumes ownership of
+ *        the returned CVS_planes16
+ *      * values outside the range of an int16_t are saturated
+ *      * checked runtime error if planes is NULL
+ ************************/
+CVS_planes16 CVS_planes_to_fixed(CVS_planes planes)
+{
+        assert(planes != NULL);
+        CVS_planes16 fixed = CVS_planes16_new(planes->width, planes->height);
+
+        size_t luma_count = (size_t)planes->width * planes->height;
+        size_t chroma_count = (size_t)planes->chroma_width *
+                                                        planes->chroma_height;
+
+        for (size_t i = 0; i < luma_count; i++) {
+                fixed->y[i] = to_fixed(planes->y[i]);
+        }
+        for (size_t i = 0; i < chroma_count; i++) {
+                fixed->pbavg[i] = to_fixed(planes->pbavg[i]);
+                fixed->pravg[i] = to_fixed(planes->pravg[i]);
+        }
+
+        return fixed;
+}
+
+/**********to_fixed********
+ *
+ * Converts one float value into a saturated fixed-point value
+ * Inputs:
+ *              float value: the value to be converted
+ * Return: value * (1 << CVS_FIXED_SHIFT), rounded half away from zero and
+ *         clamped to the range of an int16_t
+ * Expects:
+ *      N/A
+ ************************/
+static int16_t to_fixed(float value)
+{
+        double scaled = round(value * (double)(1 << CVS_FIXED_SHIFT));
+
+        scaled = fmax(FIXED_MIN, fmin(FIXED_MAX, scaled));
+        return (int16_t)scaled;
+}
@@ -0,0 +1,85 @@
+/********************************************************************
+ *
+ *                          cvsplanes.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for cvsplanes.c
+ *
+ *     Summary:
+ *      cvsplanes holds an image in component video color space (CVS) as
+ *      separate planes instead of an array of CVS structs. The Y plane keeps
+ *      one value per pixel, and the Pb and Pr planes keep one averaged value
+ *      per 2x2 block, since that average is all the 32-bit code word stores.
+ *      A 16-bit fixed-point version of the planes is also provided.
+ *
+ *******************************************************************/
+#ifndef CVSPLANES_INCLUDED
+#define CVSPLANES_INCLUDED
+
+#include <stdint.h>
+
+/*
+ * number of fractional bits in the fixed-point planes, so 1.0 is stored as
+ * 1 << CVS_FIXED_SHIFT
+ */
+#define CVS_FIXED_SHIFT 14
+
+typedef struct CVS_planes *CVS_planes;
+typedef struct CVS_planes16 *CVS_planes16;
+
+/*
+ * This is the struct definition of the CVS_planes instance
+ * Elements:
+ *      int width: the number of pixels in each row of the y plane (even)
+ *      int height: the number of rows in the y plane (even)
+ *      int chroma_width: the number of 2x2 blocks in each row (width / 2)
+ *      int chroma_height: the number of rows of 2x2 blocks (height / 2)
+ *      float *y: width * height luminance values in row-major order
+ *      float *pbavg: chroma_width * chroma_height averaged pb values, one
+ *                    per 2x2 block, in row-major order
+ *      float *pravg: chroma_width * chroma_height averaged pr values, one
+ *                    per 2x2 block, in row-major order
+ *
+ */
+struct CVS_planes {
+        int width;
+        int height;
+        int chroma_width;
+        int chroma_height;
+        float *y;
+        float *pbavg;
+        float *pravg;
+};
+
+/*
+ * This is the struct definition of the CVS_planes16 instance. It has the same
+ * layout as CVS_planes, but every value is stored as a signed fixed-point
+ * number with CVS_FIXED_SHIFT fractional bits.
+ * Elements:
+ *      int width, height, chroma_width, chroma_height: as in CVS_planes
+ *      int16_t *y: fixed-point luminance values, one per pixel
+ *      int16_t *pbavg: fixed-point averaged pb values, one per 2x2 block
+ *      int16_t *pravg: fixed-point averaged pr values, one per 2x2 block
+ *
+ */
+struct CVS_planes16 {
+        int width;
+        int height;
+        int chroma_width;
+        int chroma_height;
+        int16_t *y;
+        int16_t *pbavg;
+        int16_t *pravg;
+};
+
+CVS_planes CVS_planes_new(int width, int height);
+void CVS_planes_free(CVS_planes *planes);
+
+CVS_planes16 CVS_planes16_new(int width, int height);
+void CVS_planes16_free(CVS_planes16 *planes);
+CVS_planes16 CVS_planes_to_fixed(CVS_planes planes);
+
+#endif
@@ -0,0 +1,492 @@
+/********************************************************************
+ *
+ *                          dct2x2.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for dct2x2.h
+ *
+ *     Summary:
+ *      dct2x2 turns a whole row of 2x2 blocks of planar component video into
+ *      32-bit code words at once. It does the discrete cosine transform,
+ *      quantization and packing of 8 blocks per step when the CPU has AVX2
+ *      (4 blocks with SSE4.1), and gives exactly the same words as
+ *      quantization() does one block at a time.
+ *
+ *     Notes:
+ *   - The vector versions follow the C expressions of compress_planes_block
+ *     and quantization: a, b, c and d are summed in float in the same order,
+ *     and then scaled, divided and rounded in double. Multiplying by 0.25 is
+ *     exact, so it gives the same float as the divide by 4.0
+ *   - round() rounds halfway cases away from zero, so the vector versions
+ *     truncate with a rounding instruction and then step away from zero when
+ *     what is left over is at least one half
+ *   - The chroma indices of each step come from Chroma_indices, which also
+ *     quantizes 8 values at a time with AVX2
+ *   - The vector versions are compiled with target attributes, so the
+ *     Makefile doesn't need any -m flags
+ *   - This module uses functions from these other modules: chroma.h,
+ *     quantization.h and kernels.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "assert.h"
+#include "chroma.h"
+#include "quantization.h"
+#include "kernels.h"
+#include "dct2x2.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+/* b, c and d outside of +-BCD_LIMIT are clamped to +-BCD_MAX */
+#define BCD_LIMIT 0.3
+#define BCD_MAX 31
+#define BCD_MASK ((1 << B_BIT_SIZE) - 1)
+
+typedef void rows_to_words_fun(const float *y_top, const float *y_bottom,
+                               const float *pbavg, const float *pravg,
+                               int count, uint32_t *words);
+
+static rows_to_words_fun rows_to_words_scalar;
+static rows_to_words_fun *rows_to_words_best(void);
+
+/**********Dct2x2_rows_to_words********
+ *
+ * Converts a row of 2x2 blocks into a row of 32-bit code words
+ * Inputs:
+ *              const float *y_top: the 2 * count y values of the top row of
+ *                                  pixels
+ *              const float *y_bottom: the 2 * count y values of the bottom
+ *                                     row of pixels
+ *              const float *pbavg: the count averaged pb values of the blocks
+ *              const float *pravg: the count averaged pr values of the blocks
+ *              int count: the number of blocks
+ *              uint32_t *words: where the count code words are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * count to be nonnegative
+ * Notes:
+ *      * gives the same words as compress_planes_block
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * count is negative
+ ************************/
+void Dct2x2_rows_to_words(const float *y_top, const float *y_bottom,
+                          const float *pbavg, const float *pravg,
+                          int count, uint32_t *words)
+{
+        assert(y_top != NULL && y_bottom != NULL);
+        assert(pbavg != NULL && pravg != NULL);
+        assert(words != NULL);
+        assert(count >= 0);
+
+        static rows_to_words_fun *best = NULL;
+        if (best == NULL) {
+                best = rows_to_words_best();
+        }
+        best(y_top, y_bottom, pbavg, pravg, count, words);
+}
+
+/**********rows_to_words_scalar********
+ *
+ * Scalar version of Dct2x2_rows_to_words, one block at a time
+ * Inputs and Expects: same as Dct2x2_rows_to_words
+ * Return: N/A
+ * Notes:
+ *      * the same discrete cosine transform as compress_planes_block
+ ************************/
+static void rows_to_words_scalar(const float *y_top, const float *y_bottom,
+                                 const float *pbavg, const float *pravg,
+                                 int count, uint32_t *words)
+{
+        for (int i = 0; i < count; i++) {
+                struct block_values one_block;
+
+                float Y1 = y_top[i * 2];
+                float Y2 = y_top[i * 2 + 1];
+                float Y3 = y_bottom[i * 2];
+                float Y4 = y_bottom[i * 2 + 1];
+
+                one_block.a = (Y4 + Y3 + Y2 + Y1) / 4.0;
+                one_block.b = (Y4 + Y3 - Y2 - Y1) / 4.0;
+                one_block.c = (Y4 - Y3 + Y2 - Y1) / 4.0;
+                one_block.d = (Y4 - Y3 - Y2 + Y1) / 4.0;
+                one_block.pbavg = pbavg[i];
+                one_block.pravg = pravg[i];
+
+                words[i] = quantization(&one_block);
+        }
+}
+
+#if X86_KERNELS
+
+/**********add_chroma********
+ *
+ * Adds the chroma indices of up to 8 blocks to their code words
+ * Inputs:
+ *              const float *pbavg: the averaged pb values of the blocks
+ *              const float *pravg: the averaged pr values of the blocks
+ *              int count: the number of blocks, at most 8
+ *              uint32_t *words: the code words, with their chroma bits zero
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ ************************/
+static void add_chroma(const float *pbavg, const float *pravg, int count,
+                       uint32_t *words)
+{
+        uint32_t pb_indices[8], pr_indices[8];
+
+        Chroma_indices(pbavg, count, pb_indices);
+        Chroma_indices(pravg, count, pr_indices);
+        for (int i = 0; i < count; i++) {
+                words[i] |= pb_indices[i] << PB_LSB | pr_indices[i] << PR_LSB;
+        }
+}
+
+/**********round_avx2********
+ *
+ * Rounds 4 doubles to the nearest integer, with halfway cases rounded away
+ * from zero like round()
+ * Inputs:
+ *              __m256d value: the 4 values to be rounded
+ * Return: the 4 rounded values as 32-bit ints
+ * Expects:
+ *      * every value to fit in an int
+ * Notes:
+ *      * value minus its truncation is exact, so comparing it with one half
+ *        decides the rounding exactly
+ ************************/
+__attribute__((target("avx2")))
+static __m128i round_avx2(__m256d value)
+{
+        __m256d truncated = _mm256_round_pd(value, _MM_FROUND_TO_ZERO |
+                                                        _MM_FROUND_NO_EXC);
+        __m256d left_over = _mm256_sub_pd(value, truncated);
+        __m256d one = _mm256_set1_pd(1.0);
+        __m256d up = _mm256_and_pd(_mm256_cmp_pd(left_over,
+                                                 _mm256_set1_pd(0.5),
+                                                 _CMP_GE_OQ), one);
+        __m256d down = _mm256_and_pd(_mm256_cmp_pd(left_over,
+                                                   _mm256_set1_pd(-0.5),
+                                                   _CMP_LE_OQ), one);
+
+        truncated = _mm256_sub_pd(_mm256_add_pd(truncated, up), down);
+        return _mm256_cvttpd_epi32(truncated);
+}
+
+/**********quantized_5bit_avx2********
+ *
+ * AVX2 version of quantized_5bit, for 4 values
+ * Inputs:
+ *              __m128 value: the 4 values to be quantized
+ * Return: the 4 quantized values as 32-bit ints
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the comparisons and the divide are done in double, like
+ *        quantized_5bit
+ ************************/
+__attribute__((target("avx2")))
+static __m128i quantized_5bit_avx2(__m128 value)
+{
+        __m256d wide = _mm256_cvtps_pd(value);
+        __m256d inside = _mm256_and_pd(
+                        _mm256_cmp_pd(wide, _mm256_set1_pd(BCD_LIMIT),
+                                      _CMP_LE_OQ),
+                        _mm256_cmp_pd(wide, _mm256_set1_pd(-BCD_LIMIT),
+                                      _CMP_GE_OQ));
+        __m256d clamped = _mm256_blendv_pd(_mm256_set1_pd(BCD_MAX),
+                                           _mm256_set1_pd(-BCD_MAX),
+                                           _mm256_cmp_pd(wide,
+                                                _mm256_set1_pd(-BCD_LIMIT),
+                                                _CMP_LT_OQ));
+        __m256d scaled = _mm256_div_pd(wide, _mm256_set1_pd(BCD_CODE));
+
+        return round_avx2(_mm256_blendv_pd(clamped, scaled, inside));
+}
+
+/**********combine_avx2********
+ *
+ * Puts two SSE registers of 4 ints into one AVX register of 8 ints
+ * Inputs:
+ *              __m128i lo: ints 0 to 3
+ *              __m128i hi: ints 4 to 7
+ * Return: the 8 ints
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("avx2")))
+static __m256i combine_avx2(__m128i lo, __m128i hi)
+{
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/**********quantized_avx2********
+ *
+ * Quantizes 8 values of b, c or d and moves them to their place in the word
+ * Inputs:
+ *              __m256 value: the 8 values
+ *              int lsb: the least significant bit of the value in the word
+ * Return: the 8 quantized values, masked to B_BIT_SIZE bits and shifted
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("avx2")))
+static __m256i quantized_avx2(__m256 value, int lsb)
+{
+        __m256i quantized = combine_avx2(
+                        quantized_5bit_avx2(_mm256_castps256_ps128(value)),
+                        quantized_5bit_avx2(_mm256_extractf128_ps(value, 1)));
+
+        quantized = _mm256_and_si256(quantized, _mm256_set1_epi32(BCD_MASK));
+        return _mm256_sll_epi32(quantized, _mm_cvtsi32_si128(lsb));
+}
+
+/**********evens_odds_avx2********
+ *
+ * Splits 16 consecutive floats into the 8 at even indices and the 8 at odd
+ * indices
+ * Inputs:
+ *              const float *values: the 16 floats
+ *              __m256 *evens, *odds: where the results are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ ************************/
+__attribute__((target("avx2")))
+static void evens_odds_avx2(const float *values, __m256 *evens, __m256 *odds)
+{
+        __m256 lo = _mm256_loadu_ps(values);
+        __m256 hi = _mm256_loadu_ps(values + 8);
+
+        /* the shuffles work within 128-bit lanes, so the halves need fixing */
+        __m256 even = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 odd = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+
+        *evens = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                        _mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+        *odds = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                        _mm256_castps_pd(odd), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+/**********rows_to_words_avx2********
+ *
+ * AVX2 version of Dct2x2_rows_to_words, converting 8 blocks per step
+ * Inputs and Expects: same as Dct2x2_rows_to_words
+ * Return: N/A
+ ************************/
+__attribute__((target("avx2")))
+static void rows_to_words_avx2(const float *y_top, const float *y_bottom,
+                               const float *pbavg, const float *pravg,
+                               int count, uint32_t *words)
+{
+        const __m256 quarter = _mm256_set1_ps(0.25f);
+        int col = 0;
+
+        for (; col + 8 <= count; col += 8) {
+                __m256 Y1, Y2, Y3, Y4;
+                evens_odds_avx2(y_top + col * 2, &Y1, &Y2);
+                evens_odds_avx2(y_bottom + col * 2, &Y3, &Y4);
+
+                /* start of the discrete cosine transform */
+                __m256 sum = _mm256_add_ps(Y4, Y3);
+                __m256 difference = _mm256_sub_ps(Y4, Y3);
+                __m256 a = _mm256_add_ps(_mm256_add_ps(sum, Y2), Y1);
+                __m256 b = _mm256_sub_ps(_mm256_sub_ps(sum, Y2), Y1);
+                __m256 c = _mm256_sub_ps(_mm256_add_ps(difference, Y2), Y1);
+                __m256 d = _mm256_add_ps(_mm256_sub_ps(difference, Y2), Y1);
+                /* end of the discrete cosine transform */
+
+                a = _mm256_mul_ps(a, quarter);
+                __m256d a_code = _mm256_set1_pd(A_CODE);
+                __m256i word = combine_avx2(
+                        round_avx2(_mm256_mul_pd(_mm256_cvtps_pd(
+                                _mm256_castps256_ps128(a)), a_code)),
+                        round_avx2(_mm256_mul_pd(_mm256_cvtps_pd(
+                                _mm256_extractf128_ps(a, 1)), a_code)));
+
+                word = _mm256_slli_epi32(word, A_LSB);
+                word = _mm256_or_si256(word, quantized_avx2(
+                                _mm256_mul_ps(b, quarter), B_LSB));
+                word = _mm256_or_si256(word, quantized_avx2(
+                                _mm256_mul_ps(c, quarter), C_LSB));
+                word = _mm256_or_si256(word, quantized_avx2(
+                                _mm256_mul_ps(d, quarter), D_LSB));
+
+                _mm256_storeu_si256((__m256i *)(words + col), word);
+                add_chroma(pbavg + col, pravg + col, 8, words + col);
+        }
+
+        rows_to_words_scalar(y_top + col * 2, y_bottom + col * 2,
+                             pbavg + col, pravg + col, count - col,
+                             words + col);
+}
+
+/**********round_sse41********
+ *
+ * SSE4.1 version of round_avx2, for 2 doubles
+ * Inputs:
+ *              __m128d value: the 2 values to be rounded
+ * Return: the 2 rounded values as 32-bit ints, in the low half
+ * Expects:
+ *      * every value to fit in an int
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i round_sse41(__m128d value)
+{
+        __m128d truncated = _mm_round_pd(value, _MM_FROUND_TO_ZERO |
+                                                        _MM_FROUND_NO_EXC);
+        __m128d left_over = _mm_sub_pd(value, truncated);
+        __m128d one = _mm_set1_pd(1.0);
+        __m128d up = _mm_and_pd(_mm_cmpge_pd(left_over, _mm_set1_pd(0.5)),
+                                one);
+        __m128d down = _mm_and_pd(_mm_cmple_pd(left_over, _mm_set1_pd(-0.5)),
+                                  one);
+
+        truncated = _mm_sub_pd(_mm_add_pd(truncated, up), down);
+        return _mm_cvttpd_epi32(truncated);
+}
+
+/**********quantized_5bit_sse41********
+ *
+ * SSE4.1 version of quantized_5bit, for 2 values
+ * Inputs:
+ *              __m128 value: the 2 values to be quantized, in the low half
+ * Return: the 2 quantized values as 32-bit ints, in the low half
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i quantized_5bit_sse41(__m128 value)
+{
+        __m128d wide = _mm_cvtps_pd(value);
+        __m128d inside = _mm_and_pd(
+                        _mm_cmple_pd(wide, _mm_set1_pd(BCD_LIMIT)),
+                        _mm_cmpge_pd(wide, _mm_set1_pd(-BCD_LIMIT)));
+        __m128d clamped = _mm_blendv_pd(_mm_set1_pd(BCD_MAX),
+                                        _mm_set1_pd(-BCD_MAX),
+                                        _mm_cmplt_pd(wide,
+                                                _mm_set1_pd(-BCD_LIMIT)));
+        __m128d scaled = _mm_div_pd(wide, _mm_set1_pd(BCD_CODE));
+
+        return round_sse41(_mm_blendv_pd(clamped, scaled, inside));
+}
+
+/**********quantized_sse41********
+ *
+ * SSE4.1 version of quantized_avx2, for 4 values
+ * Inputs:
+ *              __m128 value: the 4 values
+ *              int lsb: the least significant bit of the value in the word
+ * Return: the 4 quantized values, masked to B_BIT_SIZE bits and shifted
+ * Expects:
+ *      N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static __m128i quantized_sse41(__m128 value, int lsb)
+{
+        __m128i quantized = _mm_unpacklo_epi64(
+                        quantized_5bit_sse41(value),
+                        quantized_5bit_sse41(_mm_movehl_ps(value, value)));
+
+        quantized = _mm_and_si128(quantized, _mm_set1_epi32(BCD_MASK));
+        return _mm_sll_epi32(quantized, _mm_cvtsi32_si128(lsb));
+}
+
+/**********rows_to_words_sse41********
+ *
+ * SSE4.1 version of Dct2x2_rows_to_words, converting 4 blocks per step
+ * Inputs and Expects: same as Dct2x2_rows_to_words
+ * Return: N/A
+ ************************/
+__attribute__((target("sse4.1")))
+static void rows_to_words_sse41(const float *y_top, const float *y_bottom,
+                                const float *pbavg, const float *pravg,
+                                int count, uint32_t *words)
+{
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        int col = 0;
+
+        for (; col + 4 <= count; col += 4) {
+                __m128 top_lo = _mm_loadu_ps(y_top + col * 2);
+                __m128 top_hi = _mm_loadu_ps(y_top + col * 2 + 4);
+                __m128 bottom_lo = _mm_loadu_ps(y_bottom + col * 2);
+                __m128 bottom_hi = _mm_loadu_ps(y_bottom + col * 2 + 4);
+
+                __m128 Y1 = _mm_shuffle_ps(top_lo, top_hi,
+                                                _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 Y2 = _mm_shuffle_ps(top_lo, top_hi,
+                                                _MM_SHUFFLE(3, 1, 3, 1));
+                __m128 Y3 = _mm_shuffle_ps(bottom_lo, bottom_hi,
+                                                _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 Y4 = _mm_shuffle_ps(bottom_lo, bottom_hi,
+                                                _MM_SHUFFLE(3, 1, 3, 1));
+
+                /* start of the discrete cosine transform */
+                __m128 sum = _mm_add_ps(Y4, Y3);
+                __m128 difference = _mm_sub_ps(Y4, Y3);
+                __m128 a = _mm_add_ps(_mm_add_ps(sum, Y2), Y1);
+                __m128 b = _mm_sub_ps(_mm_sub_ps(sum, Y2), Y1);
+                __m128 c = _mm_sub_ps(_mm_add_ps(difference, Y2), Y1);
+                __m128 d = _mm_add_ps(_mm_sub_ps(difference, Y2), Y1);
+                /* end of the discrete cosine transform */
+
+                a = _mm_mul_ps(a, quarter);
+                __m128d a_code = _mm_set1_pd(A_CODE);
+                __m128i word = _mm_unpacklo_epi64(
+                        round_sse41(_mm_mul_pd(_mm_cvtps_pd(a), a_code)),
+                        round_sse41(_mm_mul_pd(_mm_cvtps_pd(
+                                        _mm_movehl_ps(a, a)), a_code)));
+
+                word = _mm_slli_epi32(word, A_LSB);
+                word = _mm_or_si128(word, quantized_sse41(
+                                _mm_mul_ps(b, quarter), B_LSB));
+                word = _mm_or_si128(word, quantized_sse41(
+                                _mm_mul_ps(c, quarter), C_LSB));
+                word = _mm_or_si128(word, quantized_sse41(
+                                _mm_mul_ps(d, quarter), D_LSB));
+
+                _mm_storeu_si128((__m128i *)(words + col), word);
+                add_chroma(pbavg + col, pravg + col, 4, words + col);
+        }
+
+        rows_to_words_scalar(y_top + col * 2, y_bottom + col * 2,
+                             pbavg + col, pravg + col, count - col,
+                             words + col);
+}
+
+#endif
+
+/**********rows_to_words_best********
+ *
+ * Picks the fastest version of Dct2x2_rows_to_words at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX2, SSE4.1 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static rows_to_words_fun *rows_to_words_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return rows_to_words_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return rows_to_words_sse41;
+        }
+#endif
+        return rows_to_words_scalar;
+}
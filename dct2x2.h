@@ -0,0 +1,28 @@
+/********************************************************************
+ *
+ *                          dct2x2.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for dct2x2.c
+ *
+ *     Summary:
+ *      dct2x2 turns a whole row of 2x2 blocks of planar component video into
+ *      32-bit code words at once. It does the discrete cosine transform,
+ *      quantization and packing of 8 blocks per step when the CPU has AVX2
+ *      (4 blocks with SSE4.1), and gives exactly the same words as
+ *      quantization() does one block at a time.
+ *
+ *******************************************************************/
+#ifndef DCT2X2_INCLUDED
+#define DCT2X2_INCLUDED
+
+#include <stdint.h>
+
+void Dct2x2_rows_to_words(const float *y_top, const float *y_bottom,
+                          const float *pbavg, const float *pravg,
+                          int count, uint32_t *words);
+
+#endif
@@ -0,0 +1,598 @@
+/********************************************************************
+ *
+ *                          decodetables.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for decodetables.h
+ *
+ *     Summary:
+ *      decodetables is the table-driven 2x2 block decoder. A code word only
+ *      has 64 values of a, 64 of each of b, c and d, and 256 pairs of chroma
+ *      indices, so what each field adds to a sample is looked up instead of
+ *      computed, and a row of code words becomes its two 8-bit RGB scanlines
+ *      with a few lookups, adds and saturating packs per block. There is one
+ *      set of tables that gives exactly the samples of the float decoder,
+ *      one that gives the samples of the integer-only pipeline, and one for
+ *      images encoded with YCoCg-R (see ycocg.h). Graymaps are decoded to
+ *      one 8-bit sample per pixel, without looking at the chroma at all.
+ *
+ *     Notes:
+ *   - a / 63 and b / 105 have the common denominator 315, so each y of a
+ *     block is an exact integer n over 315, and the a and bcd tables hold
+ *     the multiples of LUMA_STEP that add up to n * LUMA_STEP
+ *   - The samples of the float decoder only depend on n and the pair of
+ *     chroma indices, which was checked over every code word. So the float
+ *     tables are built by running every n and every pair through
+ *     Colorconvert_planes_to_row once, and picking for each pair and
+ *     channel an offset that gives the same sample for every n. If this
+ *     build's float arithmetic ever gives samples no offset can match,
+ *     Decodetables_float returns NULL and the float decoder must be used
+ *   - The integer-only tables add up the chroma terms of each coefficient
+ *     and level, rounded separately and built by the compiler from the
+ *     levels in chroma.h
+ *   - For a given Co and Cg, the YCoCg-R inverse adds a whole number to Y
+ *     in each channel, so the YCoCg tables hold those numbers as offsets.
+ *     They decode y to the nearest 255th, the way the integer-only tables
+ *     do, and then apply the inverse exactly
+ *   - The a and bcd tables are the same in every set, so a graymap decodes
+ *     to the same y with any of them
+ *   - The tables are built the first time they are asked for and never
+ *     freed
+ *   - This module uses functions from quantization.h, chroma.h,
+ *     colorconvert.h, ycocg.h and kernels.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "assert.h"
+#include "quantization.h"
+#include "chroma.h"
+#include "colorconvert.h"
+#include "fixedcodec.h"
+#include "ycocg.h"
+#include "kernels.h"
+#include "decodetables.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+#define A_MASK ((1 << A_BIT_SIZE) - 1)
+#define BCD_MASK ((1 << B_BIT_SIZE) - 1)
+#define PAIR_MASK ((1 << (PB_BIT_SIZE + PR_BIT_SIZE)) - 1)
+#define FIELD_MIN (-(1 << (B_BIT_SIZE - 1)))
+#define FIELD_MAX ((1 << (B_BIT_SIZE - 1)) - 1)
+
+/* y = (A_WEIGHT * a + BCD_WEIGHT * (+-b +-c +-d)) / LUMA_DENOMINATOR */
+#define LUMA_DENOMINATOR 315
+#define A_WEIGHT 5
+#define BCD_WEIGHT 3
+
+/* the range of n, the numerator of a y */
+#define LUMA_MIN (3 * BCD_WEIGHT * FIELD_MIN)
+#define LUMA_MAX (A_WEIGHT * A_MASK + 3 * BCD_WEIGHT * FIELD_MAX)
+#define LUMA_COUNT (LUMA_MAX - LUMA_MIN + 1)
+
+#define CHANNELS 3
+#define OUTPUT_MAX 255
+#define FIXED_ONE (1 << FIXEDCODEC_SHIFT)
+
+/* rounds a constant expression half away from zero */
+#define ROUNDED(x) ((int32_t)((x) < 0 ? (x) - 0.5 : (x) + 0.5))
+
+/* one step of n in the decoder's sums */
+#define LUMA_STEP ROUNDED((double)OUTPUT_MAX * FIXED_ONE / LUMA_DENOMINATOR)
+
+#define CHROMA_TERM(level, coefficient) \
+        ROUNDED((coefficient) * (double)(level) * OUTPUT_MAX * FIXED_ONE),
+
+/* what each chroma level adds to a red, green or blue sum */
+static const int32_t red_pr[CHROMA_LEVELS] = {
+        CHROMA_LEVEL_LIST(CHROMA_TERM, 1.402)
+};
+static const int32_t green_pb[CHROMA_LEVELS] = {
+        CHROMA_LEVEL_LIST(CHROMA_TERM, -0.344136)
+};
+static const int32_t green_pr[CHROMA_LEVELS] = {
+        CHROMA_LEVEL_LIST(CHROMA_TERM, -0.714136)
+};
+static const int32_t blue_pb[CHROMA_LEVELS] = {
+        CHROMA_LEVEL_LIST(CHROMA_TERM, 1.772)
+};
+
+typedef void words_to_rows_fun(const struct Decodetables *tables,
+                               const uint32_t *words, int count,
+                               unsigned char *top, unsigned char *bottom);
+
+static words_to_rows_fun words_to_rows_scalar;
+static words_to_rows_fun *words_to_rows_best(void);
+
+static void luma_tables(struct Decodetables *tables);
+static bool float_chroma(struct Decodetables *tables);
+static void luma_representatives(float *y, bool *realized);
+static bool offset_of(const unsigned char *samples, const bool *realized,
+                      int32_t *offset);
+static unsigned char sample_of(int32_t sum);
+
+/**********Decodetables_float********
+ *
+ * Returns the tables that give exactly the samples of the float decoder
+ * Inputs: N/A
+ * Return: a pointer to the tables, or NULL if they can't match this build's
+ *         float decoder
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the tables are built by the first call
+ ************************/
+const struct Decodetables *Decodetables_float(void)
+{
+        static struct Decodetables tables;
+        static bool built = false;
+        static bool exact = false;
+
+        if (!built) {
+                luma_tables(&tables);
+                exact = float_chroma(&tables);
+                built = true;
+        }
+        return exact ? &tables : NULL;
+}
+
+/**********Decodetables_fixed********
+ *
+ * Returns the tables of the integer-only pipeline
+ * Inputs: N/A
+ * Return: a pointer to the tables
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the tables are built by the first call, with no floating point
+ ************************/
+const struct Decodetables *Decodetables_fixed(void)
+{
+        static struct Decodetables tables;
+        static bool built = false;
+
+        if (!built) {
+                luma_tables(&tables);
+                for (int pb = 0; pb < CHROMA_LEVELS; pb++) {
+                        for (int pr = 0; pr < CHROMA_LEVELS; pr++) {
+                                struct Decodetables_offsets *offsets =
+                                      &tables.chroma[pb << PR_BIT_SIZE | pr];
+                                offsets->red = red_pr[pr];
+                                offsets->green = green_pb[pb] + green_pr[pr];
+                                offsets->blue = blue_pb[pb];
+                        }
+                }
+                built = true;
+        }
+        return &tables;
+}
+
+/**********Decodetables_ycocg********
+ *
+ * Returns the tables for code words encoded with YCoCg-R
+ * Inputs: N/A
+ * Return: a pointer to the tables
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the pb index of a word holds Co and the pr index Cg
+ *      * the tables are built by the first call
+ ************************/
+const struct Decodetables *Decodetables_ycocg(void)
+{
+        static struct Decodetables tables;
+        static bool built = false;
+
+        if (!built) {
+                luma_tables(&tables);
+                for (int co = 0; co < CHROMA_LEVELS; co++) {
+                        for (int cg = 0; cg < CHROMA_LEVELS; cg++) {
+                                struct Decodetables_offsets *offsets =
+                                      &tables.chroma[co << PR_BIT_SIZE | cg];
+                                int red, green, blue;
+                                Ycocg_to_rgb(0, Ycocg_chroma_of_index(co),
+                                             Ycocg_chroma_of_index(cg),
+                                             &red, &green, &blue);
+                                offsets->red = red * FIXED_ONE;
+                                offsets->green = green * FIXED_ONE;
+                                offsets->blue = blue * FIXED_ONE;
+                        }
+                }
+                built = true;
+        }
+        return &tables;
+}
+
+/**********Decodetables_words_to_rows********
+ *
+ * Converts a row of 32-bit code words into the two 8-bit RGB scanlines of
+ * its 2x2 blocks
+ * Inputs:
+ *              const struct Decodetables *tables: the tables to decode with
+ *              const uint32_t *words: the count code words
+ *              int count: the number of code words
+ *              unsigned char *top: where the 2 * count pixels of the top
+ *                                  scanline are written, 3 bytes each
+ *              unsigned char *bottom: where the 2 * count pixels of the
+ *                                     scanline below are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * count to be nonnegative
+ * Notes:
+ *      * the samples have a denominator of 255, like CVS_to_RGB
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * count is negative
+ ************************/
+void Decodetables_words_to_rows(const struct Decodetables *tables,
+                                const uint32_t *words, int count,
+                                unsigned char *top, unsigned char *bottom)
+{
+        assert(tables != NULL && words != NULL);
+        assert(top != NULL && bottom != NULL);
+        assert(count >= 0);
+
+        static words_to_rows_fun *best = NULL;
+        if (best == NULL) {
+                best = words_to_rows_best();
+        }
+        best(tables, words, count, top, bottom);
+}
+
+/**********Decodetables_words_to_gray********
+ *
+ * Converts a row of 32-bit code words into the two 8-bit gray scanlines of
+ * its 2x2 blocks
+ * Inputs:
+ *              const struct Decodetables *tables: the tables to decode with
+ *              const uint32_t *words: the count code words
+ *              int count: the number of code words
+ *              unsigned char *top: where the 2 * count samples of the top
+ *                                  scanline are written
+ *              unsigned char *bottom: where the 2 * count samples of the
+ *                                     scanline below are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * count to be nonnegative
+ * Notes:
+ *      * only the a and bcd tables are used; the chroma indices of the words
+ *        are ignored
+ *      * the samples have a denominator of 255
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * count is negative
+ ************************/
+void Decodetables_words_to_gray(const struct Decodetables *tables,
+                                const uint32_t *words, int count,
+                                unsigned char *top, unsigned char *bottom)
+{
+        assert(tables != NULL && words != NULL);
+        assert(top != NULL && bottom != NULL);
+        assert(count >= 0);
+
+        for (int i = 0; i < count; i++) {
+                uint32_t word = words[i];
+                int32_t a = tables->a[(word >> A_LSB) & A_MASK];
+                int32_t b = tables->bcd[(word >> B_LSB) & BCD_MASK];
+                int32_t c = tables->bcd[(word >> C_LSB) & BCD_MASK];
+                int32_t d = tables->bcd[(word >> D_LSB) & BCD_MASK];
+
+                /* inverse discrete cosine transform */
+                top[i * 2] = sample_of(a - b - c + d);
+                top[i * 2 + 1] = sample_of(a - b + c - d);
+                bottom[i * 2] = sample_of(a + b - c - d);
+                bottom[i * 2 + 1] = sample_of(a + b + c + d);
+        }
+}
+
+/**********words_to_rows_scalar********
+ *
+ * Scalar version of Decodetables_words_to_rows
+ * Inputs and Expects: same as Decodetables_words_to_rows
+ * Return: N/A
+ ************************/
+static void words_to_rows_scalar(const struct Decodetables *tables,
+                                 const uint32_t *words, int count,
+                                 unsigned char *top, unsigned char *bottom)
+{
+        for (int i = 0; i < count; i++) {
+                uint32_t word = words[i];
+                int32_t a = tables->a[(word >> A_LSB) & A_MASK];
+                int32_t b = tables->bcd[(word >> B_LSB) & BCD_MASK];
+                int32_t c = tables->bcd[(word >> C_LSB) & BCD_MASK];
+                int32_t d = tables->bcd[(word >> D_LSB) & BCD_MASK];
+                const struct Decodetables_offsets *offsets =
+                                &tables->chroma[(word >> PR_LSB) & PAIR_MASK];
+
+                /* inverse discrete cosine transform */
+                int32_t luma[4] = { a - b - c + d, a - b + c - d,
+                                    a + b - c - d, a + b + c + d };
+                /* top left, top right, bottom left, bottom right */
+                unsigned char *pixels[4] = { top + i * 6, top + i * 6 + 3,
+                                             bottom + i * 6,
+                                             bottom + i * 6 + 3 };
+
+                for (int j = 0; j < 4; j++) {
+                        pixels[j][0] = sample_of(luma[j] + offsets->red);
+                        pixels[j][1] = sample_of(luma[j] + offsets->green);
+                        pixels[j][2] = sample_of(luma[j] + offsets->blue);
+                }
+        }
+}
+
+#if X86_KERNELS
+
+/**********words_to_rows_ssse3********
+ *
+ * SSSE3 version of Decodetables_words_to_rows, which does the 12 samples of
+ * a block at once
+ * Inputs and Expects: same as Decodetables_words_to_rows
+ * Return: N/A
+ * Notes:
+ *      * the sums are shifted down and packed to bytes with saturation,
+ *        which rounds and clamps them just like sample_of
+ ************************/
+__attribute__((target("ssse3")))
+static void words_to_rows_ssse3(const struct Decodetables *tables,
+                                const uint32_t *words, int count,
+                                unsigned char *top, unsigned char *bottom)
+{
+        const __m128i half = _mm_set1_epi32(FIXED_ONE / 2);
+        /* r0 r1 r2 r3 g0 g1 g2 g3 b0 b1 b2 b3 -> r0 g0 b0 r1 g1 b1 ... */
+        const __m128i interleave = _mm_setr_epi8(0, 4, 8, 1, 5, 9, 2, 6, 10,
+                                                 3, 7, 11, -1, -1, -1, -1);
+        unsigned char pixels[16];
+
+        for (int i = 0; i < count; i++) {
+                uint32_t word = words[i];
+                int32_t a = tables->a[(word >> A_LSB) & A_MASK];
+                int32_t b = tables->bcd[(word >> B_LSB) & BCD_MASK];
+                int32_t c = tables->bcd[(word >> C_LSB) & BCD_MASK];
+                int32_t d = tables->bcd[(word >> D_LSB) & BCD_MASK];
+                const struct Decodetables_offsets *offsets =
+                                &tables->chroma[(word >> PR_LSB) & PAIR_MASK];
+
+                __m128i luma = _mm_add_epi32(_mm_setr_epi32(a - b - c + d,
+                                                            a - b + c - d,
+                                                            a + b - c - d,
+                                                            a + b + c + d),
+                                             half);
+                __m128i red = _mm_srai_epi32(_mm_add_epi32(luma,
+                                        _mm_set1_epi32(offsets->red)),
+                                             FIXEDCODEC_SHIFT);
+                __m128i green = _mm_srai_epi32(_mm_add_epi32(luma,
+                                        _mm_set1_epi32(offsets->green)),
+                                               FIXEDCODEC_SHIFT);
+                __m128i blue = _mm_srai_epi32(_mm_add_epi32(luma,
+                                        _mm_set1_epi32(offsets->blue)),
+                                              FIXEDCODEC_SHIFT);
+                __m128i samples = _mm_packus_epi16(
+                                        _mm_packs_epi32(red, green),
+                                        _mm_packs_epi32(blue, blue));
+
+                _mm_storeu_si128((__m128i *)pixels,
+                                 _mm_shuffle_epi8(samples, interleave));
+                memcpy(top + i * 6, pixels, 6);
+                memcpy(bottom + i * 6, pixels + 6, 6);
+        }
+}
+
+#endif
+
+/**********words_to_rows_best********
+ *
+ * Picks the fastest version of Decodetables_words_to_rows at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the SSSE3 or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static words_to_rows_fun *words_to_rows_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_SSE) {
+                return words_to_rows_ssse3;
+        }
+#endif
+        return words_to_rows_scalar;
+}
+
+/**********luma_tables********
+ *
+ * Fills in the a and bcd tables, which are the same for every set of tables
+ * Inputs:
+ *              struct Decodetables *tables: the tables to fill in
+ * Return: N/A
+ * Expects:
+ *      * tables to be nonnull
+ ************************/
+static void luma_tables(struct Decodetables *tables)
+{
+        for (int field = 0; field <= A_MASK; field++) {
+                tables->a[field] = A_WEIGHT * field * LUMA_STEP;
+        }
+        for (int field = 0; field <= BCD_MASK; field++) {
+                int32_t value = field > FIELD_MAX ? field - (BCD_MASK + 1)
+                                                  : field;
+                tables->bcd[field] = BCD_WEIGHT * value * LUMA_STEP;
+        }
+}
+
+/**********float_chroma********
+ *
+ * Fills in the chroma table so that the tables give the samples of the
+ * float decoder
+ * Inputs:
+ *              struct Decodetables *tables: the tables, with the a and bcd
+ *                                           tables filled in
+ * Return: true if every pair and channel has an offset that gives the float
+ *         decoder's sample for every n, false if not
+ * Expects:
+ *      * tables to be nonnull
+ * Notes:
+ *      * decodes a scanline with one pixel per value of n for each pair, in
+ *        the float decoder's arithmetic
+ *      * checked runtime error if memory can't be allocated
+ ************************/
+static bool float_chroma(struct Decodetables *tables)
+{
+        int width = LUMA_COUNT + LUMA_COUNT % 2;
+        float *y = calloc(width, sizeof(float));
+        bool *realized = calloc(width, sizeof(bool));
+        float *pbavg = malloc(width / 2 * sizeof(float));
+        float *pravg = malloc(width / 2 * sizeof(float));
+        unsigned char *rgb = malloc((size_t)width * CHANNELS);
+        assert(y != NULL && realized != NULL);
+        assert(pbavg != NULL && pravg != NULL && rgb != NULL);
+
+        luma_representatives(y, realized);
+
+        bool exact = true;
+        for (int pair = 0; pair <= PAIR_MASK && exact; pair++) {
+                float pb = Chroma_of_index(pair >> PR_BIT_SIZE);
+                float pr = Chroma_of_index(pair & (CHROMA_LEVELS - 1));
+                for (int i = 0; i < width / 2; i++) {
+                        pbavg[i] = pb;
+                        pravg[i] = pr;
+                }
+                Colorconvert_planes_to_row(y, pbavg, pravg, width, rgb);
+
+                struct Decodetables_offsets *offsets = &tables->chroma[pair];
+                exact = offset_of(rgb, realized, &offsets->red) &&
+                        offset_of(rgb + 1, realized, &offsets->green) &&
+                        offset_of(rgb + 2, realized, &offsets->blue);
+        }
+
+        free(y);
+        free(realized);
+        free(pbavg);
+        free(pravg);
+        free(rgb);
+        return exact;
+}
+
+/**********luma_representatives********
+ *
+ * Works out, for every n that a code word can give, a y the float decoder
+ * gives for it
+ * Inputs:
+ *              float *y: where the y of each n goes, at index n - LUMA_MIN
+ *              bool *realized: set to true at index n - LUMA_MIN for each n
+ *                              that some code word gives
+ * Return: N/A
+ * Expects:
+ *      * y and realized to have LUMA_COUNT elements
+ * Notes:
+ *      * uses the bottom right pixel, which is a + b + c + d, and unpacks
+ *        the code word with unpacked_floats like the float decoder
+ ************************/
+static void luma_representatives(float *y, bool *realized)
+{
+        for (int a = 0; a <= A_MASK; a++) {
+                for (int sum = 3 * FIELD_MIN; sum <= 3 * FIELD_MAX; sum++) {
+                        int n = A_WEIGHT * a + BCD_WEIGHT * sum;
+                        if (realized[n - LUMA_MIN]) {
+                                continue;
+                        }
+
+                        /* split the sum of b, c and d into 3 fields */
+                        int b = sum < FIELD_MIN ? FIELD_MIN :
+                                sum > FIELD_MAX ? FIELD_MAX : sum;
+                        int c = sum - b < FIELD_MIN ? FIELD_MIN :
+                                sum - b > FIELD_MAX ? FIELD_MAX : sum - b;
+                        int d = sum - b - c;
+                        uint32_t word = (uint32_t)a << A_LSB |
+                                        (uint32_t)(b & BCD_MASK) << B_LSB |
+                                        (uint32_t)(c & BCD_MASK) << C_LSB |
+                                        (uint32_t)(d & BCD_MASK) << D_LSB;
+
+                        struct block_values values = unpacked_floats(word);
+                        y[n - LUMA_MIN] = values.a + values.b + values.c +
+                                                                values.d;
+                        realized[n - LUMA_MIN] = true;
+                }
+        }
+}
+
+/**********offset_of********
+ *
+ * Finds an offset that turns n * LUMA_STEP into the given sample for
+ * every n
+ * Inputs:
+ *              const unsigned char *samples: the sample of each n, at index
+ *                                            (n - LUMA_MIN) * CHANNELS
+ *              const bool *realized: which values of n to match
+ *              int32_t *offset: where the offset goes
+ * Return: true if there is such an offset, false if not
+ * Expects:
+ *      * all pointers to be nonnull
+ * Notes:
+ *      * a sample of 0 or 255 only bounds the offset on one side, since
+ *        sample_of clamps
+ *      * picks the middle of the offsets that work, or the end that is
+ *        bounded
+ ************************/
+static bool offset_of(const unsigned char *samples, const bool *realized,
+                      int32_t *offset)
+{
+        int64_t low = INT32_MIN;
+        int64_t high = INT32_MAX;
+
+        for (int i = 0; i < LUMA_COUNT; i++) {
+                if (!realized[i]) {
+                        continue;
+                }
+                int64_t luma = (int64_t)(i + LUMA_MIN) * LUMA_STEP;
+                int64_t sample = samples[i * CHANNELS];
+
+                if (sample > 0) {
+                        int64_t least = sample * FIXED_ONE - FIXED_ONE / 2;
+                        low = least - luma > low ? least - luma : low;
+                }
+                if (sample < OUTPUT_MAX) {
+                        int64_t most = sample * FIXED_ONE + FIXED_ONE / 2 - 1;
+                        high = most - luma < high ? most - luma : high;
+                }
+        }
+
+        if (low > high) {
+                return false;
+        }
+        *offset = low == INT32_MIN ? high :
+                  high == INT32_MAX ? low : (low + high) / 2;
+        return true;
+}
+
+/**********sample_of********
+ *
+ * Turns one sum of the decoder into an 8-bit sample
+ * Inputs:
+ *              int32_t sum: the sample scaled by 1 << FIXEDCODEC_SHIFT
+ * Return: sum rounded half up and clamped to 0..255
+ * Expects:
+ *      N/A
+ ************************/
+static unsigned char sample_of(int32_t sum)
+{
+        if (sum <= 0) {
+                return 0;
+        }
+
+        int32_t sample = (sum + FIXED_ONE / 2) >> FIXEDCODEC_SHIFT;
+        return sample > OUTPUT_MAX ? OUTPUT_MAX : sample;
+}
@@ -0,0 +1,78 @@
+/********************************************************************
+ *
+ *                          decodetables.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for decodetables.c
+ *
+ *     Summary:
+ *      decodetables is the table-driven 2x2 block decoder. A code word only
+ *      has 64 values of a, 64 of each of b, c and d, and 256 pairs of chroma
+ *      indices, so what each field adds to a sample is looked up instead of
+ *      computed, and a row of code words becomes its two 8-bit RGB scanlines
+ *      with a few lookups, adds and saturating packs per block. There is one
+ *      set of tables that gives exactly the samples of the float decoder,
+ *      one that gives the samples of the integer-only pipeline, and one for
+ *      images encoded with YCoCg-R (see ycocg.h). Graymaps are decoded to
+ *      one 8-bit sample per pixel, without looking at the chroma at all.
+ *
+ *******************************************************************/
+#ifndef DECODETABLES_INCLUDED
+#define DECODETABLES_INCLUDED
+
+#include <stdint.h>
+#include "quantization.h"
+
+/*
+ * This is the struct definition of the Decodetables_offsets instance, which
+ * holds what one pair of chroma indices adds to each channel
+ * Elements:
+ *      int32_t red, green, blue: the offsets, scaled by 255 with
+ *                                FIXEDCODEC_SHIFT fractional bits
+ *
+ */
+struct Decodetables_offsets {
+        int32_t red;
+        int32_t green;
+        int32_t blue;
+};
+
+/*
+ * This is the struct definition of the Decodetables instance
+ * Elements:
+ *      int32_t a[]: what each value of the a field adds to every y of its
+ *                   block
+ *      int32_t bcd[]: what each value of a b, c or d field adds to a y,
+ *                     indexed by the field's 6 bits before sign extension
+ *      struct Decodetables_offsets chroma[]: the offsets of each pair of
+ *                                            chroma indices, indexed by the
+ *                                            pb index times 16 plus the pr
+ *                                            index (the low byte of a code
+ *                                            word)
+ * Notes:
+ *      * every entry is scaled by 255 with FIXEDCODEC_SHIFT fractional bits,
+ *        so a sample is the sum of the entries of its fields, rounded and
+ *        clamped to 0..255
+ *
+ */
+struct Decodetables {
+        int32_t a[1 << A_BIT_SIZE];
+        int32_t bcd[1 << B_BIT_SIZE];
+        struct Decodetables_offsets chroma[1 << (PB_BIT_SIZE + PR_BIT_SIZE)];
+};
+
+const struct Decodetables *Decodetables_float(void);
+const struct Decodetables *Decodetables_fixed(void);
+const struct Decodetables *Decodetables_ycocg(void);
+
+void Decodetables_words_to_rows(const struct Decodetables *tables,
+                                const uint32_t *words, int count,
+                                unsigned char *top, unsigned char *bottom);
+void Decodetables_words_to_gray(const struct Decodetables *tables,
+                                const uint32_t *words, int count,
+                                unsigned char *top, unsigned char *bottom);
+
+#endif
@@ -0,0 +1,197 @@
+/********************************************************************
+ *
+ *                          fixedcodec.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for fixedcodec.h
+ *
+ *     Summary:
+ *      fixedcodec is the integer-only version of the 2x2 block encoder. It
+ *      turns rows of fixed-point planes (CVS_planes16) into 32-bit code
+ *      words with no floating point at all, so its output is the same on
+ *      every compiler and every set of flags. Its decoder is the one in
+ *      decodetables.h, with the tables from Decodetables_fixed.
+ *
+ *     Notes:
+ *   - Rounding, everywhere in the encoder: a, b, c and d are computed from
+ *     the sums of the 4 y values with the divide by 4 folded into the
+ *     shift, and are rounded once, half away from zero, like round() in
+ *     quantization(). a is clamped to 0..63 and b, c and d to -31..31
+ *   - 1 / BCD_CODE is exactly 105, so b, c and d are quantized with a
+ *     multiply by 105 instead of a divide
+ *   - Chroma is quantized to the nearest level, with the levels rounded to
+ *     CVS_FIXED_SHIFT fractional bits; a value exactly between two levels
+ *     takes the higher one, like Arith40_index_of_chroma
+ *   - The encoder can differ from the float path by one step in rare cases
+ *     near a rounding boundary. Conformance mode in compress40.c reports
+ *     any code word where the encoders disagree
+ *   - This module uses functions from cvsplanes.h and the layout of the
+ *     code word from quantization.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "assert.h"
+#include "cvsplanes.h"
+#include "chroma.h"
+#include "quantization.h"
+#include "fixedcodec.h"
+
+/* a is quantized to A_STEPS steps, and b, c and d to 1 / BCD_CODE steps */
+#define A_STEPS 63
+#define BCD_STEPS 105
+#define A_MAX 63
+#define BCD_MAX 31
+
+/* rounds a constant expression half away from zero */
+#define ROUNDED(x) ((int32_t)((x) < 0 ? (x) - 0.5 : (x) + 0.5))
+
+#define LEVEL_FIXED(level, unused) \
+        ROUNDED((double)(level) * (1 << CVS_FIXED_SHIFT)),
+
+/* the chroma levels with CVS_FIXED_SHIFT fractional bits */
+static const int32_t levels_fixed[CHROMA_LEVELS] = {
+        CHROMA_LEVEL_LIST(LEVEL_FIXED, 0)
+};
+
+static int32_t rounded_shift(int32_t value, int shift);
+static int32_t clamped(int32_t value, int32_t low, int32_t high);
+
+/**********Fixedcodec_rows_to_words********
+ *
+ * Converts a row of 2x2 blocks of fixed-point planes into a row of 32-bit
+ * code words
+ * Inputs:
+ *              const int16_t *y_top: the 2 * count y values of the top row of
+ *                                    pixels
+ *              const int16_t *y_bottom: the 2 * count y values of the bottom
+ *                                       row of pixels
+ *              const int16_t *pbavg: the count averaged pb values
+ *              const int16_t *pravg: the count averaged pr values
+ *              int count: the number of blocks
+ *              uint32_t *words: where the count code words are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * count to be nonnegative
+ *      * the values to have CVS_FIXED_SHIFT fractional bits
+ * Notes:
+ *      * the same discrete cosine transform as compress_planes_block, in
+ *        integers
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * count is negative
+ ************************/
+void Fixedcodec_rows_to_words(const int16_t *y_top, const int16_t *y_bottom,
+                              const int16_t *pbavg, const int16_t *pravg,
+                              int count, uint32_t *words)
+{
+        assert(y_top != NULL && y_bottom != NULL);
+        assert(pbavg != NULL && pravg != NULL);
+        assert(words != NULL);
+        assert(count >= 0);
+
+        /* the sums are 4 times a, b, c and d */
+        const int shift = CVS_FIXED_SHIFT + 2;
+
+        for (int i = 0; i < count; i++) {
+                int32_t Y1 = y_top[i * 2];
+                int32_t Y2 = y_top[i * 2 + 1];
+                int32_t Y3 = y_bottom[i * 2];
+                int32_t Y4 = y_bottom[i * 2 + 1];
+
+                int32_t a = rounded_shift((Y4 + Y3 + Y2 + Y1) * A_STEPS,
+                                                                        shift);
+                int32_t b = rounded_shift((Y4 + Y3 - Y2 - Y1) * BCD_STEPS,
+                                                                        shift);
+                int32_t c = rounded_shift((Y4 - Y3 + Y2 - Y1) * BCD_STEPS,
+                                                                        shift);
+                int32_t d = rounded_shift((Y4 - Y3 - Y2 + Y1) * BCD_STEPS,
+                                                                        shift);
+
+                a = clamped(a, 0, A_MAX);
+                b = clamped(b, -BCD_MAX, BCD_MAX);
+                c = clamped(c, -BCD_MAX, BCD_MAX);
+                d = clamped(d, -BCD_MAX, BCD_MAX);
+
+                /* every value is clamped, so the fields aren't checked */
+                struct Codeword_fields fields = {
+                        .a = a, .b = b, .c = c, .d = d,
+                        .pb = Fixedcodec_chroma_index(pbavg[i]),
+                        .pr = Fixedcodec_chroma_index(pravg[i])
+                };
+                words[i] = Codeword_pack(fields);
+        }
+}
+
+/**********Fixedcodec_chroma_index********
+ *
+ * Quantizes one fixed-point chroma value to the index of its nearest level
+ * Inputs:
+ *              int16_t chroma: the averaged pb or pr value, with
+ *                              CVS_FIXED_SHIFT fractional bits
+ * Return: the index of the level, from 0 to CHROMA_LEVELS - 1
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * counts the midpoints between levels that chroma is at or above,
+ *        which compilers turn into branch-free code. The midpoints are
+ *        compared at twice the scale, so they are exact
+ ************************/
+unsigned Fixedcodec_chroma_index(int16_t chroma)
+{
+        int32_t doubled = 2 * (int32_t)chroma;
+        unsigned index = 0;
+
+        for (int i = 0; i < CHROMA_LEVELS - 1; i++) {
+                index += doubled >= levels_fixed[i] + levels_fixed[i + 1];
+        }
+        return index;
+}
+
+/**********rounded_shift********
+ *
+ * Divides by a power of two, rounding half away from zero
+ * Inputs:
+ *              int32_t value: the value to be divided
+ *              int shift: the power of two
+ * Return: value / (1 << shift), rounded
+ * Expects:
+ *      * shift to be positive
+ * Notes:
+ *      * only shifts nonnegative values, since shifting a negative value
+ *        right isn't defined the same way by every compiler
+ ************************/
+static int32_t rounded_shift(int32_t value, int shift)
+{
+        int32_t half = (int32_t)1 << (shift - 1);
+
+        if (value >= 0) {
+                return (value + half) >> shift;
+        }
+        return -((-value + half) >> shift);
+}
+
+/**********clamped********
+ *
+ * Clamps a value to a range
+ * Inputs:
+ *              int32_t value: the value to be clamped
+ *              int32_t low, high: the ends of the range
+ * Return: value, moved into [low, high]
+ * Expects:
+ *      * low to be at most high
+ ************************/
+static int32_t clamped(int32_t value, int32_t low, int32_t high)
+{
+        if (value < low) {
+                return low;
+        } else if (value > high) {
+                return high;
+        }
+        return value;
+}
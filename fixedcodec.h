@@ -0,0 +1,36 @@
+/********************************************************************
+ *
+ *                          fixedcodec.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for fixedcodec.c
+ *
+ *     Summary:
+ *      fixedcodec is the integer-only version of the 2x2 block encoder. It
+ *      turns rows of fixed-point planes (CVS_planes16) into 32-bit code
+ *      words with no floating point at all, so its output is the same on
+ *      every compiler and every set of flags. Its decoder is the one in
+ *      decodetables.h, with the tables from Decodetables_fixed.
+ *
+ *******************************************************************/
+#ifndef FIXEDCODEC_INCLUDED
+#define FIXEDCODEC_INCLUDED
+
+#include <stdint.h>
+
+/*
+ * number of fractional bits in the sums of the table-driven decoder
+ * (decodetables.h), which are scaled so that 1 << FIXEDCODEC_SHIFT is one
+ * step of an 8-bit sample
+ */
+#define FIXEDCODEC_SHIFT 16
+
+void Fixedcodec_rows_to_words(const int16_t *y_top, const int16_t *y_bottom,
+                              const int16_t *pbavg, const int16_t *pravg,
+                              int count, uint32_t *words);
+unsigned Fixedcodec_chroma_index(int16_t chroma);
+
+#endif
@@ -0,0 +1,602 @@
+/********************************************************************
+ *
+ *                          graymap.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for graymap.h
+ *
+ *     Summary:
+ *      graymap reads PGM images and writes P5 images, and compresses and
+ *      decompresses them without doing any chroma work.
+ *
+ *     Notes:
+ *   - A gray pixel has a y equal to its sample over the denominator, and a
+ *     Pb and Pr of 0, so a block's a, b, c and d come straight from sums of
+ *     its 4 samples, quantized like the float encoder quantizes them.
+ *     Every sum has at most 4 * 255 + 1 values, so each field is one lookup
+ *     in a table built for the denominator of the image
+ *   - Both chroma indices of every code word are the index of a chroma of
+ *     0, so a graymap's code words are what the float encoder gives for the
+ *     same image stored as a PPM, give or take float rounding
+ *   - Samples of images with a denominator over 255 are scaled to 0..255 as
+ *     they are read; the 6 bits of a can't tell the difference
+ *   - The magic number is looked at in the bytes of inputmap.h, so
+ *     nothing is pushed back onto a stream
+ *   - A P5 image with samples of one byte is parsed in place in those
+ *     bytes, like rgbview.h parses P6, so its samples are never copied.
+ *     P2 images, samples of two bytes and anything the parser doesn't take
+ *     are read from a stream over the same bytes, so bad images fail just
+ *     as they did before
+ *   - This module uses functions from codewords.h, chroma.h, decodetables.h
+ *     and pool.h, the Inputmap of inputmap.h, and the layout of the code
+ *     word from quantization.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include "assert.h"
+#include "codewords.h"
+#include "chroma.h"
+#include "quantization.h"
+#include "decodetables.h"
+#include "pool.h"
+#include "inputmap.h"
+#include "graymap.h"
+
+#define DENOMINATOR 255
+#define MAX_DENOMINATOR 65535
+
+/* a is quantized to A_STEPS steps, and b, c and d to BCD_STEPS steps */
+#define A_STEPS 63
+#define BCD_STEPS 105
+#define BCD_MAX 31
+
+static bool parsed_raster(Inputmap map, Graymap graymap);
+static bool parsed_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number);
+static void read_stream(FILE *input, Graymap graymap);
+static unsigned header_number(FILE *input);
+static void read_raw(FILE *input, unsigned denominator, Graymap graymap,
+                     unsigned char *samples);
+static void read_plain(FILE *input, unsigned denominator, Graymap graymap,
+                       unsigned char *samples);
+static unsigned scaled(unsigned sample, unsigned denominator);
+static int rounded_ratio(int numerator, int denominator);
+
+/**********Graymap_is_next********
+ *
+ * Tells whether an image in memory is a PGM image
+ * Inputs:
+ *              Inputmap input: the bytes of the image
+ * Return: true if the image starts with the magic number P5 or P2, false if
+ *         not
+ * Expects:
+ *      * input to be nonnull
+ * Notes:
+ *      * only looks at the bytes, so the image can still be read by any
+ *        reader
+ *      * checked runtime error if input is NULL
+ ************************/
+bool Graymap_is_next(Inputmap input)
+{
+        assert(input != NULL);
+
+        return input->size >= 2 && input->bytes[0] == 'P' &&
+               (input->bytes[1] == '5' || input->bytes[1] == '2');
+}
+
+/**********Graymap_map********
+ *
+ * Reads a PGM image from bytes already in memory
+ * Inputs:
+ *              Inputmap input: the bytes of the image
+ * Return: the graymap, with a denominator of at most 255
+ * Expects:
+ *      * input to be nonnull and hold a P5 or P2 image
+ * Notes:
+ *      * takes ownership of input, which is freed with the graymap or
+ *        before it is returned
+ *      * samples of images with a denominator over 255 are scaled to 0..255
+ *      * the caller assumes ownership of the returned graymap, and frees it
+ *        with Graymap_free
+ *      * checked runtime error if:
+ *              * input is NULL
+ *              * the image isn't a well-formed P5 or P2 image
+ *              * memory can't be allocated
+ ************************/
+Graymap Graymap_map(Inputmap input)
+{
+        assert(input != NULL);
+        Graymap graymap = malloc(sizeof(*graymap));
+        assert(graymap != NULL);
+        Inputmap map = input;
+
+        if (parsed_raster(map, graymap)) {
+                graymap->input = map;
+                return graymap;
+        }
+
+        FILE *stream = Inputmap_stream(map);
+        read_stream(stream, graymap);
+        fclose(stream);
+        Inputmap_free(&map);
+        graymap->input = NULL;
+        return graymap;
+}
+
+/**********Graymap_write********
+ *
+ * Writes a graymap as a P5 image
+ * Inputs:
+ *              FILE *output: where the image is written
+ *              Graymap graymap: the image
+ * Return: N/A
+ * Expects:
+ *      * output and graymap to be nonnull
+ * Notes:
+ *      * checked runtime error if:
+ *              * output or graymap is NULL
+ *              * the samples can't all be written
+ ************************/
+void Graymap_write(FILE *output, Graymap graymap)
+{
+        assert(output != NULL && graymap != NULL);
+        size_t count = (size_t)graymap->width * graymap->height;
+
+        fprintf(output, "P5\n%u %u\n%u\n", graymap->width, graymap->height,
+                graymap->denominator);
+        size_t written = fwrite(graymap->samples, 1, count, output);
+        assert(written == count);
+}
+
+/**********Graymap_free********
+ *
+ * Frees a graymap, along with its samples or the input they are in
+ * Inputs:
+ *              Graymap *graymap: a pointer to the graymap to be freed
+ * Return: N/A
+ * Expects:
+ *      * graymap and *graymap to be nonnull
+ * Notes:
+ *      * sets *graymap to NULL
+ *      * checked runtime error if graymap or *graymap is NULL
+ ************************/
+void Graymap_free(Graymap *graymap)
+{
+        assert(graymap != NULL && *graymap != NULL);
+        if ((*graymap)->input != NULL) {
+                Inputmap_free(&(*graymap)->input);
+        } else {
+                Pool_free((void *)(*graymap)->samples);
+        }
+        free(*graymap);
+        *graymap = NULL;
+}
+
+/**********GraymaptoWords********
+ *
+ * Compresses a graymap into a buffer of 32-bit words
+ * Inputs:
+ *              Graymap graymap: the graymap that is to be compressed
+ * Return: A Codewords buffer with each 2x2 block corresponding to one 32 bit
+ *         word
+ * Expects:
+ *      * graymap to be nonnull
+ * Notes:
+ *      * a last odd column or row is left out, like Rgbview_trim does
+ *      * both chroma indices of every word are the index of a chroma of 0
+ *      * frees up memory for the inputted graymap, and allocates memory for
+ *        the returned Codewords. The caller assumes ownership of the
+ *        returned Codewords
+ *      * checked runtime error if graymap is NULL
+ ************************/
+Codewords GraymaptoWords(Graymap graymap)
+{
+        assert(graymap != NULL);
+        int denominator = graymap->denominator;
+        int sum_max = 4 * denominator;
+        size_t width = graymap->width;
+        Codewords compressed_blocks = Codewords_new(graymap->width / 2,
+                                                    graymap->height / 2);
+
+        /* a of each sum of 4 samples, and b, c or d of each difference */
+        uint8_t *a = Pool_alloc(2 * (size_t)sum_max + 2);
+        int8_t *bcd = (int8_t *)a + sum_max + 1 + sum_max / 2;
+        for (int sum = 0; sum <= sum_max; sum++) {
+                a[sum] = rounded_ratio(sum * A_STEPS, sum_max);
+        }
+        for (int difference = -sum_max / 2; difference <= sum_max / 2;
+             difference++) {
+                int field = rounded_ratio(difference * BCD_STEPS, sum_max);
+                if (field > BCD_MAX) {
+                        field = BCD_MAX;
+                } else if (field < -BCD_MAX) {
+                        field = -BCD_MAX;
+                }
+                bcd[difference] = field;
+        }
+        unsigned neutral = Chroma_index_of(0.0f);
+
+        for (int row = 0; row < compressed_blocks->height; row++) {
+                const unsigned char *top = graymap->samples +
+                                           2 * (size_t)row * width;
+                const unsigned char *bottom = top + width;
+                uint32_t *words = Codewords_row(compressed_blocks, row);
+
+                for (int i = 0; i < compressed_blocks->width; i++) {
+                        int y0 = top[i * 2];
+                        int y1 = top[i * 2 + 1];
+                        int y2 = bottom[i * 2];
+                        int y3 = bottom[i * 2 + 1];
+
+                        /* the discrete cosine transform, on sums of 4 */
+                        struct Codeword_fields fields = {
+                                .a = a[y3 + y2 + y1 + y0],
+                                .b = bcd[y3 + y2 - y1 - y0],
+                                .c = bcd[y3 - y2 + y1 - y0],
+                                .d = bcd[y3 - y2 - y1 + y0],
+                                .pb = neutral,
+                                .pr = neutral
+                        };
+                        words[i] = Codeword_pack(fields);
+                }
+        }
+
+        Pool_free(a);
+        Graymap_free(&graymap);
+        return compressed_blocks;
+}
+
+/**********WordstoGraymap********
+ *
+ * Decompresses a buffer of 32-bit words into a graymap
+ * Inputs:
+ *              Codewords compressed_blocks: the code words, one per 2x2 block
+ * Return: a graymap with a denominator of 255
+ * Expects:
+ *      * compressed_blocks to be nonnull
+ * Notes:
+ *      * the chroma indices of the words are ignored
+ *      * frees up the memory used for the inputted Codewords, and allocates
+ *        memory for the returned graymap. The caller assumes ownership of
+ *        the returned graymap
+ *      * checked runtime error if:
+ *              * compressed_blocks is NULL
+ *              * memory can't be allocated
+ ************************/
+Graymap WordstoGraymap(Codewords compressed_blocks)
+{
+        assert(compressed_blocks != NULL);
+        const struct Decodetables *tables = Decodetables_fixed();
+        Graymap graymap = malloc(sizeof(*graymap));
+        assert(graymap != NULL);
+
+        graymap->width = compressed_blocks->width * 2;
+        graymap->height = compressed_blocks->height * 2;
+        graymap->denominator = DENOMINATOR;
+        unsigned char *samples = Pool_alloc((size_t)graymap->width *
+                                            graymap->height);
+        graymap->samples = samples;
+        graymap->input = NULL;
+
+        for (int row = 0; row < compressed_blocks->height; row++) {
+                unsigned char *top = samples +
+                                     2 * (size_t)row * graymap->width;
+                Decodetables_words_to_gray(tables,
+                                           Codewords_row(compressed_blocks,
+                                                         row),
+                                           compressed_blocks->width, top,
+                                           top + graymap->width);
+        }
+
+        Codewords_free(&compressed_blocks);
+        return graymap;
+}
+
+/**********parsed_raster********
+ *
+ * Parses a P5 image with samples of one byte in place
+ * Inputs:
+ *              Inputmap map: the bytes of the image
+ *              Graymap graymap: where the size, denominator and samples go
+ * Return: true if the image was parsed, false if it has to be read from a
+ *         stream instead
+ * Expects:
+ *      * map and graymap to be nonnull
+ * Notes:
+ *      * the samples point into map, so map must outlive graymap
+ *      * gives up, leaving the error to the stream reader, on anything but
+ *        a well-formed P5 image whose samples all fit its denominator
+ ************************/
+static bool parsed_raster(Inputmap map, Graymap graymap)
+{
+        const unsigned char *cursor = map->bytes;
+        const unsigned char *end = map->bytes + map->size;
+        unsigned width, height, denominator;
+
+        if (map->size < 2 || cursor[0] != 'P' || cursor[1] != '5') {
+                return false;
+        }
+        cursor += 2;
+        if (!parsed_number(&cursor, end, &width) ||
+            !parsed_number(&cursor, end, &height) ||
+            !parsed_number(&cursor, end, &denominator)) {
+                return false;
+        }
+        /* exactly one whitespace character ends the header */
+        if (cursor == end || !isspace(*cursor) || denominator == 0 ||
+            denominator > DENOMINATOR) {
+                return false;
+        }
+        cursor++;
+
+        if (height != 0 && width > SIZE_MAX / height) {
+                return false;
+        }
+        size_t count = (size_t)width * height;
+        if ((size_t)(end - cursor) < count) {
+                return false;
+        }
+        if (denominator < DENOMINATOR) {
+                for (size_t i = 0; i < count; i++) {
+                        if (cursor[i] > denominator) {
+                                return false;
+                        }
+                }
+        }
+
+        graymap->width = width;
+        graymap->height = height;
+        graymap->denominator = denominator;
+        graymap->samples = cursor;
+        return true;
+}
+
+/**********parsed_number********
+ *
+ * Parses one number of a PGM header in memory, skipping whitespace and
+ * comments
+ * Inputs:
+ *              const unsigned char **cursor: where to start, which is moved
+ *                                            past the number
+ *              const unsigned char *end: the end of the bytes
+ *              unsigned *number: where the number goes
+ * Return: true if there was a number that fits in an int, false if not
+ * Expects:
+ *      * cursor, *cursor, end and number to be nonnull
+ ************************/
+static bool parsed_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number)
+{
+        const unsigned char *at = *cursor;
+
+        while (at < end && (*at == '#' || isspace(*at))) {
+                if (*at == '#') {
+                        while (at < end && *at != '\n') {
+                                at++;
+                        }
+                } else {
+                        at++;
+                }
+        }
+        if (at == end || !isdigit(*at)) {
+                return false;
+        }
+
+        unsigned value = 0;
+        while (at < end && isdigit(*at)) {
+                unsigned digit = *at - '0';
+                if (value > (INT_MAX - digit) / 10) {
+                        return false;
+                }
+                value = value * 10 + digit;
+                at++;
+        }
+        *cursor = at;
+        *number = value;
+        return true;
+}
+
+/**********read_stream********
+ *
+ * Reads a PGM image from a stream into a graymap
+ * Inputs:
+ *              FILE *input: the stream, positioned at the start of the image
+ *              Graymap graymap: where the size, denominator and samples go
+ * Return: N/A
+ * Expects:
+ *      * input and graymap to be nonnull, and input to hold a P5 or P2
+ *        image
+ * Notes:
+ *      * the samples go in a block from pool.h
+ *      * checked runtime error if the image isn't a well-formed P5 or P2
+ *        image
+ ************************/
+static void read_stream(FILE *input, Graymap graymap)
+{
+        int first = getc(input);
+        int kind = getc(input);
+        assert(first == 'P' && (kind == '5' || kind == '2'));
+
+        graymap->width = header_number(input);
+        graymap->height = header_number(input);
+        unsigned denominator = header_number(input);
+        assert(denominator > 0 && denominator <= MAX_DENOMINATOR);
+        graymap->denominator = denominator > DENOMINATOR ? DENOMINATOR
+                                                         : denominator;
+
+        assert(graymap->height == 0 ||
+               graymap->width <= SIZE_MAX / graymap->height);
+        unsigned char *samples = Pool_alloc((size_t)graymap->width *
+                                            graymap->height);
+        graymap->samples = samples;
+
+        if (kind == '5') {
+                /* exactly one whitespace character ends the header */
+                int c = getc(input);
+                assert(c != EOF && isspace(c));
+                read_raw(input, denominator, graymap, samples);
+        } else {
+                read_plain(input, denominator, graymap, samples);
+        }
+}
+
+/**********header_number********
+ *
+ * Reads one number from a PGM image, skipping whitespace and comments
+ * Inputs:
+ *              FILE *input: the file
+ * Return: the number
+ * Expects:
+ *      * input to be nonnull
+ * Notes:
+ *      * the character after the number is left in the file
+ *      * checked runtime error if there is no number, or it is bigger than
+ *        an int
+ ************************/
+static unsigned header_number(FILE *input)
+{
+        int c = getc(input);
+        while (c == '#' || isspace(c)) {
+                if (c == '#') {
+                        while (c != '\n' && c != EOF) {
+                                c = getc(input);
+                        }
+                }
+                c = getc(input);
+        }
+        assert(c != EOF && isdigit(c));
+
+        unsigned number = 0;
+        while (c != EOF && isdigit(c)) {
+                unsigned digit = c - '0';
+                assert(number <= (INT_MAX - digit) / 10);
+                number = number * 10 + digit;
+                c = getc(input);
+        }
+        if (c != EOF) {
+                ungetc(c, input);
+        }
+        return number;
+}
+
+/**********read_raw********
+ *
+ * Reads the binary samples of a P5 image into a graymap
+ * Inputs:
+ *              FILE *input: the file, positioned at the first sample
+ *              unsigned denominator: the denominator in the image's header
+ *              Graymap graymap: the graymap, with its size set
+ *              unsigned char *samples: where the samples go
+ * Return: N/A
+ * Expects:
+ *      * input, graymap and samples to be nonnull
+ * Notes:
+ *      * samples take two bytes, most significant first, if the
+ *        denominator is over 255
+ *      * checked runtime error if the file is too short or a sample is
+ *        bigger than the denominator
+ ************************/
+static void read_raw(FILE *input, unsigned denominator, Graymap graymap,
+                     unsigned char *samples)
+{
+        size_t count = (size_t)graymap->width * graymap->height;
+
+        if (denominator <= DENOMINATOR) {
+                size_t got = fread(samples, 1, count, input);
+                assert(got == count);
+                if (denominator < DENOMINATOR) {
+                        for (size_t i = 0; i < count; i++) {
+                                assert(samples[i] <= denominator);
+                        }
+                }
+                return;
+        }
+
+        size_t row_bytes = (size_t)graymap->width * 2;
+        unsigned char *row_buffer = Pool_alloc(row_bytes);
+        for (unsigned row = 0; row < graymap->height; row++) {
+                unsigned char *row_samples = samples +
+                                             (size_t)row * graymap->width;
+                size_t got = fread(row_buffer, 1, row_bytes, input);
+                assert(got == row_bytes);
+                for (unsigned col = 0; col < graymap->width; col++) {
+                        row_samples[col] = scaled(row_buffer[col * 2] << 8 |
+                                              row_buffer[col * 2 + 1],
+                                              denominator);
+                }
+        }
+        Pool_free(row_buffer);
+}
+
+/**********read_plain********
+ *
+ * Reads the decimal samples of a P2 image into a graymap
+ * Inputs:
+ *              FILE *input: the file, positioned after the denominator
+ *              unsigned denominator: the denominator in the image's header
+ *              Graymap graymap: the graymap, with its size set
+ *              unsigned char *samples: where the samples go
+ * Return: N/A
+ * Expects:
+ *      * input, graymap and samples to be nonnull
+ * Notes:
+ *      * checked runtime error if the file is too short or a sample is
+ *        bigger than the denominator
+ ************************/
+static void read_plain(FILE *input, unsigned denominator, Graymap graymap,
+                       unsigned char *samples)
+{
+        size_t count = (size_t)graymap->width * graymap->height;
+
+        for (size_t i = 0; i < count; i++) {
+                samples[i] = scaled(header_number(input), denominator);
+        }
+}
+
+/**********scaled********
+ *
+ * Scales a sample to the denominator of a graymap
+ * Inputs:
+ *              unsigned sample: the sample from the file
+ *              unsigned denominator: the denominator in the file's header
+ * Return: the sample over 255 if the denominator is over 255, rounded, or
+ *         else the sample itself
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * checked runtime error if sample is bigger than denominator
+ ************************/
+static unsigned scaled(unsigned sample, unsigned denominator)
+{
+        assert(sample <= denominator);
+        if (denominator <= DENOMINATOR) {
+                return sample;
+        }
+        return (sample * DENOMINATOR + denominator / 2) / denominator;
+}
+
+/**********rounded_ratio********
+ *
+ * Divides two ints, rounding half away from zero
+ * Inputs:
+ *              int numerator: the value to be divided
+ *              int denominator: the value to divide by
+ * Return: numerator / denominator, rounded
+ * Expects:
+ *      * denominator to be positive
+ ************************/
+static int rounded_ratio(int numerator, int denominator)
+{
+        if (numerator >= 0) {
+                return (2 * numerator + denominator) / (2 * denominator);
+        }
+        return -((-2 * numerator + denominator) / (2 * denominator));
+}
@@ -0,0 +1,59 @@
+/********************************************************************
+ *
+ *                          graymap.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for graymap.c
+ *
+ *     Summary:
+ *      graymap reads PGM images (P5 and P2) and writes P5 images, and is
+ *      the fast path for grayscale images. A graymap is compressed straight
+ *      from its samples to code words, with both chroma indices fixed at
+ *      the neutral index, and decompressed straight back to one sample per
+ *      pixel, so no Pb or Pr is ever computed, quantized or converted back
+ *      to three channels. Compressed graymaps have their own format number
+ *      (see readwritecompressed.h) and decompress to P5.
+ *
+ *******************************************************************/
+#ifndef GRAYMAP_INCLUDED
+#define GRAYMAP_INCLUDED
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "codewords.h"
+#include "inputmap.h"
+
+typedef struct Graymap *Graymap;
+
+/*
+ * This is the struct definition of the Graymap instance
+ * Elements:
+ *      unsigned width: the number of samples in each row
+ *      unsigned height: the number of rows
+ *      unsigned denominator: the largest sample, at most 255
+ *      const unsigned char *samples: width * height samples in row-major
+ *                                    order
+ *      Inputmap input: the input the samples are in, if they were parsed in
+ *                      place, or NULL if they are in a block from pool.h
+ *
+ */
+struct Graymap {
+        unsigned width;
+        unsigned height;
+        unsigned denominator;
+        const unsigned char *samples;
+        Inputmap input;
+};
+
+bool Graymap_is_next(Inputmap input);
+Graymap Graymap_map(Inputmap input);
+void Graymap_write(FILE *output, Graymap graymap);
+void Graymap_free(Graymap *graymap);
+
+Codewords GraymaptoWords(Graymap graymap);
+Graymap WordstoGraymap(Codewords compressed_blocks);
+
+#endif
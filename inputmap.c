@@ -0,0 +1,189 @@
+/********************************************************************
+ *
+ *                          inputmap.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for inputmap.h
+ *
+ *     Summary:
+ *      inputmap puts the rest of an input file in memory, by mapping it if
+ *      it is a regular file and by reading it into a buffer if not.
+ *
+ *     Notes:
+ *   - The mapping covers the whole file and bytes starts at the stream's
+ *     position, so characters a reader already peeked at and pushed back
+ *     are still seen. The stream is then moved to the end of the file, as
+ *     if it had been read
+ *   - The kernel is told the mapping will be read in order, so it reads
+ *     ahead
+ *   - A buffer starts at BUFFER_START bytes and doubles as it fills
+ *   - This module does not use functions from other modules
+ *******************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "assert.h"
+#include "inputmap.h"
+
+#define BUFFER_START 65536
+
+static bool mapped_file(FILE *input, Inputmap map);
+static void read_all(FILE *input, Inputmap map);
+
+/**********Inputmap_new********
+ *
+ * Puts the rest of an input file in memory
+ * Inputs:
+ *              FILE *input: the file, positioned where reading is to start
+ * Return: the bytes from the stream's position to the end of the file
+ * Expects:
+ *      * input to be nonnull
+ * Notes:
+ *      * leaves input at the end of the file
+ *      * the caller assumes ownership of the returned Inputmap, and frees it
+ *        with Inputmap_free
+ *      * checked runtime error if:
+ *              * input is NULL
+ *              * the file can't be read or memory can't be allocated
+ ************************/
+Inputmap Inputmap_new(FILE *input)
+{
+        assert(input != NULL);
+        Inputmap map = malloc(sizeof(*map));
+        assert(map != NULL);
+
+        if (!mapped_file(input, map)) {
+                read_all(input, map);
+        }
+        return map;
+}
+
+/**********Inputmap_stream********
+ *
+ * Opens the bytes of an Inputmap as a read-only stream
+ * Inputs:
+ *              Inputmap map: the bytes to read
+ * Return: a stream positioned at the first byte
+ * Expects:
+ *      * map to be nonnull
+ * Notes:
+ *      * the stream must be closed with fclose before map is freed
+ *      * checked runtime error if map is NULL or the stream can't be opened,
+ *        which some C libraries do for an empty input
+ ************************/
+FILE *Inputmap_stream(Inputmap map)
+{
+        assert(map != NULL);
+
+        FILE *stream = fmemopen((void *)map->bytes, map->size, "r");
+        assert(stream != NULL);
+        return stream;
+}
+
+/**********Inputmap_free********
+ *
+ * Unmaps or frees the bytes of an Inputmap, and frees the Inputmap
+ * Inputs:
+ *              Inputmap *map: a pointer to the Inputmap to be freed
+ * Return: N/A
+ * Expects:
+ *      * map and *map to be nonnull
+ * Notes:
+ *      * sets *map to NULL
+ *      * checked runtime error if map or *map is NULL
+ ************************/
+void Inputmap_free(Inputmap *map)
+{
+        assert(map != NULL && *map != NULL);
+
+        if ((*map)->mapped) {
+                munmap((*map)->base, (*map)->length);
+        } else {
+                free((*map)->base);
+        }
+        free(*map);
+        *map = NULL;
+}
+
+/**********mapped_file********
+ *
+ * Maps the rest of an input file, if it is a regular file
+ * Inputs:
+ *              FILE *input: the file
+ *              Inputmap map: where the mapping is recorded
+ * Return: true if the file was mapped, false if it must be read instead
+ * Expects:
+ *      * input and map to be nonnull
+ ************************/
+static bool mapped_file(FILE *input, Inputmap map)
+{
+        struct stat info;
+        off_t offset = ftello(input);
+
+        if (offset < 0 || fstat(fileno(input), &info) != 0 ||
+            !S_ISREG(info.st_mode) || info.st_size <= offset) {
+                return false;
+        }
+
+        size_t length = (size_t)info.st_size;
+        void *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE,
+                          fileno(input), 0);
+        if (base == MAP_FAILED) {
+                return false;
+        }
+        posix_madvise(base, length, POSIX_MADV_SEQUENTIAL);
+
+        map->bytes = (const unsigned char *)base + offset;
+        map->size = length - (size_t)offset;
+        map->mapped = true;
+        map->base = base;
+        map->length = length;
+        fseeko(input, 0, SEEK_END);
+        return true;
+}
+
+/**********read_all********
+ *
+ * Reads the rest of an input file into a buffer
+ * Inputs:
+ *              FILE *input: the file
+ *              Inputmap map: where the buffer is recorded
+ * Return: N/A
+ * Expects:
+ *      * input and map to be nonnull
+ * Notes:
+ *      * checked runtime error if the file can't be read or memory can't be
+ *        allocated
+ ************************/
+static void read_all(FILE *input, Inputmap map)
+{
+        size_t capacity = BUFFER_START;
+        size_t size = 0;
+        unsigned char *buffer = malloc(capacity);
+        assert(buffer != NULL);
+
+        for (;;) {
+                size += fread(buffer + size, 1, capacity - size, input);
+                if (size < capacity) {
+                        break;
+                }
+                capacity *= 2;
+                buffer = realloc(buffer, capacity);
+                assert(buffer != NULL);
+        }
+        assert(!ferror(input));
+
+        map->bytes = buffer;
+        map->size = size;
+        map->mapped = false;
+        map->base = buffer;
+        map->length = capacity;
+}
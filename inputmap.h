@@ -0,0 +1,51 @@
+/********************************************************************
+ *
+ *                          inputmap.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for inputmap.c
+ *
+ *     Summary:
+ *      inputmap puts the rest of an input file in memory so that readers
+ *      can parse it in place. A regular file is memory-mapped, so nothing
+ *      is copied; anything else, like a pipe, is read into a buffer.
+ *      Readers that only take a FILE can still read the bytes through
+ *      Inputmap_stream.
+ *
+ *******************************************************************/
+#ifndef INPUTMAP_INCLUDED
+#define INPUTMAP_INCLUDED
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Inputmap *Inputmap;
+
+/*
+ * This is the struct definition of the Inputmap instance
+ * Elements:
+ *      const unsigned char *bytes: the rest of the input
+ *      size_t size: the number of bytes
+ *      bool mapped: true if bytes are in a mapping of the file, false if
+ *                   they were read into a buffer
+ *      void *base: the start of the mapping or the buffer
+ *      size_t length: the length of the mapping
+ *
+ */
+struct Inputmap {
+        const unsigned char *bytes;
+        size_t size;
+        bool mapped;
+        void *base;
+        size_t length;
+};
+
+Inputmap Inputmap_new(FILE *input);
+FILE *Inputmap_stream(Inputmap map);
+void Inputmap_free(Inputmap *map);
+
+#endif
@@ -0,0 +1,209 @@
+/********************************************************************
+ *
+ *                          kernels.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for kernels.h
+ *
+ *     Summary:
+ *      kernels decides, once per run, which instruction set the vector
+ *      kernels of the other modules (colorconvert.h, dct2x2.h, chroma.h,
+ *      decodetables.h, bitbatch.h, plainppm.h, codewords.h) may use. It
+ *      detects what the CPU can run, and the choice can be lowered for
+ *      benchmarking or for finding which kernel gives a different result,
+ *      with the ARITH_KERNEL environment variable or 40image's --kernel
+ *      option.
+ *
+ *     Notes:
+ *   - The level is fixed the first time Kernels_level is called, which is
+ *     when the first module binds its kernels, so Kernels_force has to be
+ *     called before any image is converted
+ *   - Kernels_force wins over ARITH_KERNEL. A value of ARITH_KERNEL that
+ *     isn't a level, or that this CPU can't run, is reported on stderr and
+ *     the detected level is used instead
+ *   - Every level gives exactly the same output; only the speed differs
+ *   - This module does not use functions from other modules
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "assert.h"
+#include "kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#else
+#define X86_KERNELS 0
+#endif
+
+/* the name of each level, for ARITH_KERNEL and --kernel */
+static const char *const names[] = { "scalar", "sse", "avx2", "avx512" };
+#define LEVELS ((int)(sizeof(names) / sizeof(names[0])))
+
+static bool bound = false;
+static bool forced = false;
+static Kernel_level forced_level = KERNEL_SCALAR;
+
+static Kernel_level environment_level(void);
+
+/**********Kernels_detected********
+ *
+ * Returns the fastest level of kernels this CPU can run
+ * Inputs: N/A
+ * Return: the level
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * a level is only detected if the CPU has every instruction set of
+ *        it and of the levels below it
+ ************************/
+Kernel_level Kernels_detected(void)
+{
+        static bool detected = false;
+        static Kernel_level level = KERNEL_SCALAR;
+
+        if (!detected) {
+#if X86_KERNELS
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("ssse3") &&
+                    __builtin_cpu_supports("sse4.1")) {
+                        level = KERNEL_SSE;
+                }
+                if (level == KERNEL_SSE && __builtin_cpu_supports("avx2") &&
+                    __builtin_cpu_supports("bmi2")) {
+                        level = KERNEL_AVX2;
+                }
+                if (level == KERNEL_AVX2 &&
+                    __builtin_cpu_supports("avx512f") &&
+                    __builtin_cpu_supports("avx512bw")) {
+                        level = KERNEL_AVX512;
+                }
+#endif
+                detected = true;
+        }
+        return level;
+}
+
+/**********Kernels_level********
+ *
+ * Returns the level of kernels every module should bind to
+ * Inputs: N/A
+ * Return: the forced level, or else the level in ARITH_KERNEL, or else the
+ *         detected level
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the first call fixes the level for the rest of the run
+ ************************/
+Kernel_level Kernels_level(void)
+{
+        static Kernel_level level = KERNEL_SCALAR;
+
+        if (!bound) {
+                level = forced ? forced_level : environment_level();
+                bound = true;
+        }
+        return level;
+}
+
+/**********Kernels_force********
+ *
+ * Makes every module use the given level of kernels, instead of the
+ * detected one
+ * Inputs:
+ *              Kernel_level level: the level to use
+ * Return: true if this CPU can run the level, false if not, in which case
+ *         nothing changes
+ * Expects:
+ *      * to be called before Kernels_level
+ * Notes:
+ *      * checked runtime error if Kernels_level has already been called
+ ************************/
+bool Kernels_force(Kernel_level level)
+{
+        assert(!bound);
+
+        if (level > Kernels_detected()) {
+                return false;
+        }
+        forced = true;
+        forced_level = level;
+        return true;
+}
+
+/**********Kernels_parse********
+ *
+ * Finds the level with the given name
+ * Inputs:
+ *              const char *name: "scalar", "sse", "avx2" or "avx512"
+ *              Kernel_level *level: where the level goes
+ * Return: true if name is a level, false if not
+ * Expects:
+ *      * name and level to be nonnull
+ * Notes:
+ *      * checked runtime error if name or level is NULL
+ ************************/
+bool Kernels_parse(const char *name, Kernel_level *level)
+{
+        assert(name != NULL && level != NULL);
+
+        for (int i = 0; i < LEVELS; i++) {
+                if (strcmp(name, names[i]) == 0) {
+                        *level = (Kernel_level)i;
+                        return true;
+                }
+        }
+        return false;
+}
+
+/**********Kernels_name********
+ *
+ * Returns the name of a level
+ * Inputs:
+ *              Kernel_level level: the level
+ * Return: its name, as accepted by Kernels_parse
+ * Expects:
+ *      * level to be a Kernel_level
+ * Notes:
+ *      * checked runtime error if level isn't a Kernel_level
+ ************************/
+const char *Kernels_name(Kernel_level level)
+{
+        assert((int)level >= 0 && (int)level < LEVELS);
+        return names[level];
+}
+
+/**********environment_level********
+ *
+ * Works out the level from ARITH_KERNEL and the detected level
+ * Inputs: N/A
+ * Return: the level in ARITH_KERNEL if it is set to a level this CPU can
+ *         run, or else the detected level
+ * Expects:
+ *      N/A
+ ************************/
+static Kernel_level environment_level(void)
+{
+        Kernel_level detected = Kernels_detected();
+        const char *name = getenv(KERNELS_ENVIRONMENT);
+        Kernel_level level;
+
+        if (name == NULL || *name == '\0') {
+                return detected;
+        }
+        if (!Kernels_parse(name, &level)) {
+                fprintf(stderr, "%s=%s isn't a kernel level, using %s\n",
+                        KERNELS_ENVIRONMENT, name, Kernels_name(detected));
+                return detected;
+        }
+        if (level > detected) {
+                fprintf(stderr, "%s=%s can't run on this CPU, using %s\n",
+                        KERNELS_ENVIRONMENT, name, Kernels_name(detected));
+                return detected;
+        }
+        return level;
+}
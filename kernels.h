@@ -0,0 +1,51 @@
+/********************************************************************
+ *
+ *                          kernels.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for kernels.c
+ *
+ *     Summary:
+ *      kernels decides, once per run, which instruction set the vector
+ *      kernels of the other modules (colorconvert.h, dct2x2.h, chroma.h,
+ *      decodetables.h, bitbatch.h, plainppm.h, codewords.h) may use. It
+ *      detects what the CPU can run, and the choice can be lowered for
+ *      benchmarking or for finding which kernel gives a different result,
+ *      with the ARITH_KERNEL environment variable or 40image's --kernel
+ *      option.
+ *
+ *******************************************************************/
+#ifndef KERNELS_INCLUDED
+#define KERNELS_INCLUDED
+
+#include <stdbool.h>
+
+/* the environment variable that overrides the detected level */
+#define KERNELS_ENVIRONMENT "ARITH_KERNEL"
+
+/*
+ * the levels of kernels, from slowest to fastest; each level can also use
+ * the kernels of every level below it
+ *      KERNEL_SCALAR: plain C only, the reference
+ *      KERNEL_SSE: SSSE3 and SSE4.1
+ *      KERNEL_AVX2: AVX2 and BMI2
+ *      KERNEL_AVX512: AVX-512 F and BW
+ */
+typedef enum Kernel_level {
+        KERNEL_SCALAR,
+        KERNEL_SSE,
+        KERNEL_AVX2,
+        KERNEL_AVX512
+} Kernel_level;
+
+Kernel_level Kernels_detected(void);
+Kernel_level Kernels_level(void);
+bool Kernels_force(Kernel_level level);
+
+bool Kernels_parse(const char *name, Kernel_level *level);
+const char *Kernels_name(Kernel_level level);
+
+#endif
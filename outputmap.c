@@ -0,0 +1,109 @@
+/********************************************************************
+ *
+ *                          outputmap.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for outputmap.h
+ *
+ *     Summary:
+ *      outputmap sizes an output file, reserves its blocks and maps it
+ *      shared, so that what is written to the mapping is the file.
+ *
+ *     Notes:
+ *   - The file is truncated to its size and its blocks are reserved with
+ *     posix_fallocate, so running out of space fails before anything is
+ *     coded instead of as a SIGBUS in the middle of a store. A file system
+ *     that can't reserve blocks still gets a file of the right size
+ *   - The file is truncated first, so an old file at the path that was
+ *     longer doesn't leave its tail behind
+ *   - Nothing is written with write calls, so there is no stream to flush;
+ *     Outputmap_finish unmaps the file and closes it, and the kernel writes
+ *     the pages back
+ *   - This module does not use functions from other modules
+ *******************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "assert.h"
+#include "outputmap.h"
+
+#define FILE_MODE 0666
+
+/**********Outputmap_new********
+ *
+ * Creates an output file of a given size and maps it for writing
+ * Inputs:
+ *              const char *path: the name of the file, which is created or
+ *                                replaced
+ *              size_t size: the size of the file in bytes
+ * Return: the mapped file, with size bytes to be filled in
+ * Expects:
+ *      * path to be nonnull
+ *      * size to be positive
+ * Notes:
+ *      * the caller assumes ownership of the returned map, which is freed
+ *        by Outputmap_finish
+ *      * checked runtime error if:
+ *              * path is NULL or size is 0
+ *              * the file can't be created, sized or mapped
+ *              * there isn't room for the file
+ ************************/
+Outputmap Outputmap_new(const char *path, size_t size)
+{
+        assert(path != NULL && size > 0);
+        assert((off_t)size > 0 && (size_t)(off_t)size == size);
+
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, FILE_MODE);
+        assert(fd >= 0);
+        int sized = ftruncate(fd, (off_t)size);
+        assert(sized == 0);
+        int reserved = posix_fallocate(fd, 0, (off_t)size);
+        assert(reserved == 0 || reserved == EINVAL ||
+               reserved == EOPNOTSUPP);
+
+        void *bytes = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0);
+        assert(bytes != MAP_FAILED);
+
+        Outputmap map = malloc(sizeof(*map));
+        assert(map != NULL);
+        map->bytes = bytes;
+        map->size = size;
+        map->fd = fd;
+        return map;
+}
+
+/**********Outputmap_finish********
+ *
+ * Unmaps and closes an output file, and frees its Outputmap
+ * Inputs:
+ *              Outputmap *map: a pointer to the map
+ * Return: N/A
+ * Expects:
+ *      * map and *map to be nonnull
+ *      * every byte of the file to have been written
+ * Notes:
+ *      * sets *map to NULL
+ *      * checked runtime error if map or *map is NULL, or the file can't be
+ *        unmapped or closed
+ ************************/
+void Outputmap_finish(Outputmap *map)
+{
+        assert(map != NULL && *map != NULL);
+
+        int unmapped = munmap((*map)->bytes, (*map)->size);
+        assert(unmapped == 0);
+        int closed = close((*map)->fd);
+        assert(closed == 0);
+        free(*map);
+        *map = NULL;
+}
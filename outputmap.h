@@ -0,0 +1,42 @@
+/********************************************************************
+ *
+ *                          outputmap.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for outputmap.c
+ *
+ *     Summary:
+ *      outputmap creates an output file of a size known in advance, with
+ *      its blocks reserved up front, and maps it, so that the parts of the
+ *      output can be written straight to where they go in the file, in any
+ *      order and from any thread, with no write calls at all.
+ *
+ *******************************************************************/
+#ifndef OUTPUTMAP_INCLUDED
+#define OUTPUTMAP_INCLUDED
+
+#include <stddef.h>
+
+typedef struct Outputmap *Outputmap;
+
+/*
+ * This is the struct definition of the Outputmap instance
+ * Elements:
+ *      unsigned char *bytes: the contents of the file, to be written
+ *      size_t size: the size of the file
+ *      int fd: the file descriptor of the file
+ *
+ */
+struct Outputmap {
+        unsigned char *bytes;
+        size_t size;
+        int fd;
+};
+
+Outputmap Outputmap_new(const char *path, size_t size);
+void Outputmap_finish(Outputmap *map);
+
+#endif
@@ -0,0 +1,422 @@
+/********************************************************************
+ *
+ *                          plainppm.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for plainppm.h
+ *
+ *     Summary:
+ *      plainppm turns the decimal samples of a P3 raster into bytes, 16
+ *      (SSE) or 32 (AVX2) bytes of text per step, or a character at a time
+ *      in the scalar version.
+ *
+ *     Notes:
+ *   - A block is classified into a mask of digits and a mask of whitespace.
+ *     A number starts at every digit that doesn't follow a digit, and its
+ *     length is the run of ones in the digit mask from there. The masks of
+ *     the next block are made at the same time, so a number that runs into
+ *     it is still read from the masks, and its end is already checked
+ *   - A number of up to three digits is the dot product of its bytes with
+ *     the place values for its length, with no loop over its digits. A
+ *     longer one, like 0255, is read by the scalar code
+ *   - A byte that isn't a digit or whitespace, a number over the
+ *     denominator, or a raster with too few numbers makes the parse fail.
+ *     When a block has such a byte, the scalar code goes on from the end of
+ *     the last number read, and decides
+ *   - Every version gives the same samples, and fails on the same text
+ *   - This module uses kernels.h to pick the version
+ *******************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "assert.h"
+#include "kernels.h"
+#include "plainppm.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define X86_KERNELS 0
+#endif
+
+#define SSE_BYTES 16
+#define AVX2_BYTES 32
+#define MAX_SHORT_DIGITS 3
+
+/*
+ * This is the struct definition of a parse in progress
+ * Elements:
+ *      const unsigned char *text: the raster, as text
+ *      size_t size: the number of bytes of text
+ *      unsigned denominator: the largest sample allowed
+ *      unsigned char *samples: where the samples go
+ *      size_t count: the number of samples in the raster
+ *      size_t parsed: the number of samples read so far
+ *      size_t at: the offset in text just past the last number read
+ *
+ */
+struct parse {
+        const unsigned char *text;
+        size_t size;
+        unsigned denominator;
+        unsigned char *samples;
+        size_t count;
+        size_t parsed;
+        size_t at;
+};
+
+typedef bool parse_fun(struct parse *parse);
+
+static parse_fun *parse_best(void);
+static bool parse_scalar(struct parse *parse);
+static bool take_number(struct parse *parse, size_t start);
+static bool is_space(unsigned char c);
+static bool is_digit(unsigned char c);
+
+/**********Plainppm_samples********
+ *
+ * Parses the raster of a P3 image
+ * Inputs:
+ *              const unsigned char *text: the raster, from just after the
+ *                                         header
+ *              size_t size: the number of bytes of text
+ *              unsigned denominator: the denominator of the image
+ *              unsigned char *samples: where the samples go, in the order
+ *                                      of the text
+ *              size_t count: the number of samples, 3 * width * height
+ * Return: true if text starts with count numbers, each at most
+ *         denominator and separated by whitespace, and false if not
+ * Expects:
+ *      * text and samples to be nonnull if count is positive
+ *      * denominator to be at most 255
+ * Notes:
+ *      * what follows the last sample is ignored
+ *      * samples may have been partly written when it fails
+ *      * checked runtime error if a pointer is NULL or denominator is
+ *        over 255
+ ************************/
+bool Plainppm_samples(const unsigned char *text, size_t size,
+                      unsigned denominator, unsigned char *samples,
+                      size_t count)
+{
+        assert(count == 0 || (text != NULL && samples != NULL));
+        assert(denominator <= UINT8_MAX);
+        struct parse parse = { text, size, denominator, samples, count, 0, 0 };
+
+        static parse_fun *best = NULL;
+        if (best == NULL) {
+                best = parse_best();
+        }
+        return best(&parse);
+}
+
+/**********parse_scalar********
+ *
+ * Scalar version of Plainppm_samples, and the end of the other versions
+ * Inputs:
+ *              struct parse *parse: the parse, which goes on from its at
+ * Return: true if every sample was read, false if the text is bad
+ * Expects:
+ *      * parse to be nonnull
+ ************************/
+static bool parse_scalar(struct parse *parse)
+{
+        while (parse->parsed < parse->count) {
+                size_t at = parse->at;
+                while (at < parse->size && is_space(parse->text[at])) {
+                        at++;
+                }
+                if (!take_number(parse, at)) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/**********take_number********
+ *
+ * Reads one number of any length as the next sample
+ * Inputs:
+ *              struct parse *parse: the parse
+ *              size_t start: the offset of the number's first digit
+ * Return: true if there was a number, at most the denominator and followed
+ *         by whitespace or the end of the text
+ * Expects:
+ *      * parse to be nonnull, with samples still to read
+ * Notes:
+ *      * moves at past the number
+ ************************/
+static bool take_number(struct parse *parse, size_t start)
+{
+        size_t at = start;
+        unsigned value = 0;
+
+        if (at == parse->size || !is_digit(parse->text[at])) {
+                return false;
+        }
+        while (at < parse->size && is_digit(parse->text[at])) {
+                value = value * 10 + (parse->text[at] - '0');
+                if (value > parse->denominator) {
+                        return false;
+                }
+                at++;
+        }
+        if (at < parse->size && !is_space(parse->text[at])) {
+                return false;
+        }
+
+        parse->samples[parse->parsed++] = value;
+        parse->at = at;
+        return true;
+}
+
+/**********is_space********
+ *
+ * Tells whether a byte is whitespace, as isspace does in the C locale
+ * Inputs:
+ *              unsigned char c: the byte
+ * Return: true for ' ', '\t', '\n', '\v', '\f' and '\r'
+ * Expects:
+ *      N/A
+ ************************/
+static bool is_space(unsigned char c)
+{
+        return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/**********is_digit********
+ *
+ * Tells whether a byte is a decimal digit
+ * Inputs:
+ *              unsigned char c: the byte
+ * Return: true for '0' to '9'
+ * Expects:
+ *      N/A
+ ************************/
+static bool is_digit(unsigned char c)
+{
+        return (unsigned char)(c - '0') <= 9;
+}
+
+#if X86_KERNELS
+
+/*
+ * the place value of each digit of a number of 1, 2 or 3 digits; the bytes
+ * after a shorter number are multiplied by 0
+ */
+static const int PLACES[MAX_SHORT_DIGITS + 1][MAX_SHORT_DIGITS] = {
+        { 0, 0, 0 }, { 1, 0, 0 }, { 10, 1, 0 }, { 100, 10, 1 }
+};
+
+/**********take_numbers********
+ *
+ * Reads the numbers that start in one block of text
+ * Inputs:
+ *              struct parse *parse: the parse
+ *              size_t base: the offset of the block
+ *              uint64_t starts: a bit for each byte of the block where a
+ *                               number starts
+ *              uint64_t digits: a bit for each digit of the block and the
+ *                               next one, which has only digits and
+ *                               whitespace
+ * Return: true if the numbers were read, false if the text is bad
+ * Expects:
+ *      * parse to be nonnull
+ *      * the two blocks to be in the text
+ * Notes:
+ *      * stops once every sample is read
+ ************************/
+static bool take_numbers(struct parse *parse, size_t base, uint64_t starts,
+                         uint64_t digits)
+{
+        while (starts != 0 && parse->parsed < parse->count) {
+                unsigned start = __builtin_ctzll(starts);
+                starts &= starts - 1;
+                unsigned length = __builtin_ctzll(~(digits >> start));
+
+                if (length > MAX_SHORT_DIGITS) {
+                        if (!take_number(parse, base + start)) {
+                                return false;
+                        }
+                        continue;
+                }
+                const unsigned char *number = parse->text + base + start;
+                const int *places = PLACES[length];
+                int value = (number[0] - '0') * places[0] +
+                            (number[1] - '0') * places[1] +
+                            (number[2] - '0') * places[2];
+                if ((unsigned)value > parse->denominator) {
+                        return false;
+                }
+                parse->samples[parse->parsed++] = value;
+                parse->at = base + start + length;
+        }
+        return true;
+}
+
+/**********classify_sse********
+ *
+ * Finds the digits and the whitespace in 16 bytes
+ * Inputs:
+ *              const unsigned char *bytes: the bytes
+ *              uint64_t *digits: where a bit for each digit goes
+ *              uint64_t *spaces: where a bit for each whitespace byte goes
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ * Notes:
+ *      * c - lo <= hi - lo is tested unsigned, as min(c - lo, hi - lo)
+ *        == c - lo
+ ************************/
+__attribute__((target("sse4.1")))
+static void classify_sse(const unsigned char *bytes, uint64_t *digits,
+                         uint64_t *spaces)
+{
+        __m128i c = _mm_loadu_si128((const __m128i *)bytes);
+        __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+        __m128i control = _mm_sub_epi8(c, _mm_set1_epi8('\t'));
+        __m128i is_digit = _mm_cmpeq_epi8(
+                _mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i is_space = _mm_or_si128(
+                _mm_cmpeq_epi8(_mm_min_epu8(control,
+                                            _mm_set1_epi8('\r' - '\t')),
+                               control),
+                _mm_cmpeq_epi8(c, _mm_set1_epi8(' ')));
+
+        *digits = (uint16_t)_mm_movemask_epi8(is_digit);
+        *spaces = (uint16_t)_mm_movemask_epi8(is_space);
+}
+
+/**********parse_sse********
+ *
+ * SSE version of Plainppm_samples, which does 16 bytes per step
+ * Inputs and Expects: same as parse_scalar
+ * Return: true if every sample was read, false if the text is bad
+ ************************/
+__attribute__((target("sse4.1")))
+static bool parse_sse(struct parse *parse)
+{
+        const uint64_t all = (1ULL << SSE_BYTES) - 1;
+        uint64_t digits, spaces, next_digits, next_spaces;
+        uint64_t carry = 0;
+        size_t at = parse->at;
+
+        if (at + 2 * SSE_BYTES <= parse->size) {
+                classify_sse(parse->text + at, &next_digits, &next_spaces);
+        }
+        for (; at + 2 * SSE_BYTES <= parse->size &&
+               parse->parsed < parse->count; at += SSE_BYTES) {
+                digits = next_digits;
+                spaces = next_spaces;
+                classify_sse(parse->text + at + SSE_BYTES, &next_digits,
+                             &next_spaces);
+                if ((digits | spaces) != all ||
+                    (next_digits | next_spaces) != all) {
+                        break;
+                }
+
+                uint64_t starts = digits & ~((digits << 1) | carry);
+                carry = digits >> (SSE_BYTES - 1);
+                if (!take_numbers(parse, at, starts,
+                                  digits | next_digits << SSE_BYTES)) {
+                        return false;
+                }
+        }
+        return parse_scalar(parse);
+}
+
+/**********classify_avx2********
+ *
+ * Finds the digits and the whitespace in 32 bytes
+ * Inputs and Expects: same as classify_sse
+ * Return: N/A
+ ************************/
+__attribute__((target("avx2")))
+static void classify_avx2(const unsigned char *bytes, uint64_t *digits,
+                          uint64_t *spaces)
+{
+        __m256i c = _mm256_loadu_si256((const __m256i *)bytes);
+        __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i control = _mm256_sub_epi8(c, _mm256_set1_epi8('\t'));
+        __m256i is_digit = _mm256_cmpeq_epi8(
+                _mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i is_space = _mm256_or_si256(
+                _mm256_cmpeq_epi8(_mm256_min_epu8(control,
+                                                  _mm256_set1_epi8('\r' -
+                                                                   '\t')),
+                                  control),
+                _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')));
+
+        *digits = (uint32_t)_mm256_movemask_epi8(is_digit);
+        *spaces = (uint32_t)_mm256_movemask_epi8(is_space);
+}
+
+/**********parse_avx2********
+ *
+ * AVX2 version of Plainppm_samples, which does 32 bytes per step
+ * Inputs and Expects: same as parse_scalar
+ * Return: true if every sample was read, false if the text is bad
+ * Notes:
+ *      * works the same way as parse_sse
+ ************************/
+__attribute__((target("avx2")))
+static bool parse_avx2(struct parse *parse)
+{
+        const uint64_t all = (1ULL << AVX2_BYTES) - 1;
+        uint64_t digits, spaces, next_digits, next_spaces;
+        uint64_t carry = 0;
+        size_t at = parse->at;
+
+        if (at + 2 * AVX2_BYTES <= parse->size) {
+                classify_avx2(parse->text + at, &next_digits, &next_spaces);
+        }
+        for (; at + 2 * AVX2_BYTES <= parse->size &&
+               parse->parsed < parse->count; at += AVX2_BYTES) {
+                digits = next_digits;
+                spaces = next_spaces;
+                classify_avx2(parse->text + at + AVX2_BYTES, &next_digits,
+                              &next_spaces);
+                if ((digits | spaces) != all ||
+                    (next_digits | next_spaces) != all) {
+                        break;
+                }
+
+                uint64_t starts = digits & ~((digits << 1) | carry);
+                carry = digits >> (AVX2_BYTES - 1);
+                if (!take_numbers(parse, at, starts,
+                                  digits | next_digits << AVX2_BYTES)) {
+                        return false;
+                }
+        }
+        return parse_scalar(parse);
+}
+
+#endif
+
+/**********parse_best********
+ *
+ * Picks the fastest version of Plainppm_samples at the level
+ * of Kernels_level
+ * Inputs: N/A
+ * Return: a pointer to the AVX2, SSE or scalar version
+ * Expects:
+ *      N/A
+ ************************/
+static parse_fun *parse_best(void)
+{
+#if X86_KERNELS
+        Kernel_level level = Kernels_level();
+        if (level >= KERNEL_AVX2) {
+                return parse_avx2;
+        }
+        if (level >= KERNEL_SSE) {
+                return parse_sse;
+        }
+#endif
+        return parse_scalar;
+}
@@ -0,0 +1,32 @@
+/********************************************************************
+ *
+ *                          plainppm.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for plainppm.c
+ *
+ *     Summary:
+ *      plainppm parses the decimal samples of a plain (P3) image that is in
+ *      memory into bytes, the raster the encoders read. Blocks of text are
+ *      sorted into digits and whitespace with vector compares, every
+ *      number is found from a bit mask of where its digits start, and its
+ *      one to three digits are added up at once, so the text is never
+ *      walked a character at a time. Anything unusual in the text, like a
+ *      comment, makes it give up, so the caller can hand the image to a
+ *      reader that handles everything.
+ *
+ *******************************************************************/
+#ifndef PLAINPPM_INCLUDED
+#define PLAINPPM_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+
+bool Plainppm_samples(const unsigned char *text, size_t size,
+                      unsigned denominator, unsigned char *samples,
+                      size_t count);
+
+#endif
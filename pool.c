@@ -0,0 +1,257 @@
+/********************************************************************
+ *
+ *                          pool.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for pool.h
+ *
+ *     Summary:
+ *      pool hands out the big buffers of the pipeline from per-thread lists
+ *      of freed blocks, sorted into size classes, so that the memory of one
+ *      image is reused by the next one instead of going back to the system.
+ *
+ *     Notes:
+ *   - The size classes go up in quarters of a power of two, from 64 bytes,
+ *     so a block is never more than a quarter bigger than what was asked for
+ *     (apart from the smallest class)
+ *   - Every block has a header of POOL_ALIGNMENT bytes in front of it that
+ *     remembers its class, so Pool_free doesn't need to be told the size
+ *   - Pool_reset gives back to the system every freed block that wasn't
+ *     handed out during the last KEEP_IMAGES images; the others stay cached,
+ *     already paged in, so a run of images of a few different sizes keeps
+ *     reusing the same blocks
+ *   - Everything is per thread, so no locks are needed. A block must be
+ *     freed on the thread that allocated it, since its size is counted in
+ *     that thread's stats; its header remembers the thread's stats, and
+ *     Pool_free checks them
+ *   - This module does not use functions from other modules
+ *******************************************************************/
+#define _POSIX_C_SOURCE 200112L
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "assert.h"
+#include "pool.h"
+
+#define MIN_SHIFT 6
+#define MAX_SHIFT 47
+#define STEPS 4
+#define CLASS_COUNT ((MAX_SHIFT - MIN_SHIFT + 1) * STEPS)
+#define KEEP_IMAGES 4
+
+/*
+ * the header in front of every block
+ * Elements:
+ *      struct header *next: the next freed block of the same class
+ *      int class: the size class of the block
+ *      size_t image: the image during which the block was last handed out
+ *      const struct Pool_stats *owner: the stats of the thread that
+ *                                      handed it out
+ *
+ */
+struct header {
+        struct header *next;
+        int class;
+        size_t image;
+        const struct Pool_stats *owner;
+};
+
+static __thread struct header *cached[CLASS_COUNT];
+static __thread struct Pool_stats stats;
+
+static size_t class_size(int class);
+static int class_of(size_t size);
+static void release_unused(size_t image);
+
+/**********Pool_alloc********
+ *
+ * Hands out a block of at least size bytes
+ * Inputs:
+ *              size_t size: the number of bytes needed
+ * Return: a pointer to the block, aligned to POOL_ALIGNMENT bytes
+ * Expects:
+ *      * size to be at most 2^47 bytes
+ * Notes:
+ *      * the contents of the block are uninitialized; a reused block holds
+ *        whatever it last held
+ *      * the block must be freed with Pool_free, not free
+ *      * checked runtime error if size is too big or the memory can't be
+ *        allocated
+ ************************/
+void *Pool_alloc(size_t size)
+{
+        int class = class_of(size);
+        struct header *block = cached[class];
+
+        if (block != NULL) {
+                cached[class] = block->next;
+                stats.cached -= class_size(class);
+                stats.reused++;
+        } else {
+                void *memory = NULL;
+                int failed = posix_memalign(&memory, POOL_ALIGNMENT,
+                                            POOL_ALIGNMENT +
+                                            class_size(class));
+                assert(failed == 0 && memory != NULL);
+                block = memory;
+                block->class = class;
+        }
+
+        block->image = stats.images;
+        block->owner = &stats;
+        stats.allocations++;
+        stats.in_use += class_size(class);
+        if (stats.in_use > stats.high_water) {
+                stats.high_water = stats.in_use;
+        }
+        return (char *)block + POOL_ALIGNMENT;
+}
+
+/**********Pool_free********
+ *
+ * Gives a block back to the pool, where it is kept for reuse
+ * Inputs:
+ *              void *block: a block from Pool_alloc
+ * Return: N/A
+ * Expects:
+ *      * block to be nonnull, and not freed already
+ *      * to be called on the thread that allocated block
+ * Notes:
+ *      * checked runtime error if block is NULL or was allocated by another
+ *        thread
+ ************************/
+void Pool_free(void *block)
+{
+        assert(block != NULL);
+
+        struct header *header = (struct header *)((char *)block -
+                                                  POOL_ALIGNMENT);
+        assert(header->owner == &stats);
+        size_t size = class_size(header->class);
+
+        header->next = cached[header->class];
+        cached[header->class] = header;
+        stats.in_use -= size;
+        stats.cached += size;
+}
+
+/**********Pool_reset********
+ *
+ * Marks the end of an image
+ * Inputs: N/A
+ * Return: N/A
+ * Expects:
+ *      * to be called once each image is finished
+ * Notes:
+ *      * freed blocks that weren't handed out during the last KEEP_IMAGES
+ *        images are given back to the system, and the rest stay cached for
+ *        the next images
+ *      * blocks still in use are not affected
+ ************************/
+void Pool_reset(void)
+{
+        stats.images++;
+        if (stats.images > KEEP_IMAGES) {
+                release_unused(stats.images - KEEP_IMAGES);
+        }
+}
+
+/**********Pool_release********
+ *
+ * Gives every freed block of this thread back to the system
+ * Inputs: N/A
+ * Return: N/A
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * to be called before a thread that used the pool exits, or to drop
+ *        the cache
+ ************************/
+void Pool_release(void)
+{
+        release_unused((size_t)-1);
+}
+
+/**********Pool_stats********
+ *
+ * Returns the statistics of this thread's pool
+ * Inputs: N/A
+ * Return: a copy of the statistics
+ * Expects:
+ *      N/A
+ ************************/
+struct Pool_stats Pool_stats(void)
+{
+        return stats;
+}
+
+/**********class_size********
+ *
+ * Returns the number of bytes in the blocks of a size class
+ * Inputs:
+ *              int class: the size class
+ * Return: the size of its blocks in bytes
+ * Expects:
+ *      * class to be between 0 and CLASS_COUNT - 1
+ ************************/
+static size_t class_size(int class)
+{
+        size_t quarter = (size_t)1 << (class / STEPS + MIN_SHIFT - 2);
+        return quarter * (STEPS + class % STEPS);
+}
+
+/**********class_of********
+ *
+ * Finds the smallest size class whose blocks hold size bytes
+ * Inputs:
+ *              size_t size: the number of bytes needed
+ * Return: the size class
+ * Expects:
+ *      * size to fit in the biggest class
+ * Notes:
+ *      * checked runtime error if size is too big
+ ************************/
+static int class_of(size_t size)
+{
+        int shift = MIN_SHIFT;
+
+        while (shift < MAX_SHIFT && ((size_t)1 << (shift + 1)) < size) {
+                shift++;
+        }
+
+        int class = (shift - MIN_SHIFT) * STEPS;
+        while (class < CLASS_COUNT && class_size(class) < size) {
+                class++;
+        }
+        assert(class < CLASS_COUNT);
+        return class;
+}
+
+/**********release_unused********
+ *
+ * Gives the freed blocks last handed out before an image back to the system
+ * Inputs:
+ *              size_t image: the first image whose blocks are kept
+ * Return: N/A
+ * Expects:
+ *      N/A
+ ************************/
+static void release_unused(size_t image)
+{
+        for (int class = 0; class < CLASS_COUNT; class++) {
+                struct header **link = &cached[class];
+                while (*link != NULL) {
+                        struct header *block = *link;
+                        if (block->image < image) {
+                                *link = block->next;
+                                stats.cached -= class_size(class);
+                                free(block);
+                        } else {
+                                link = &block->next;
+                        }
+                }
+        }
+}
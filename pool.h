@@ -0,0 +1,56 @@
+/********************************************************************
+ *
+ *                          pool.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for pool.c
+ *
+ *     Summary:
+ *      pool hands out the big buffers of the pipeline (planes, code words
+ *      and row buffers) from per-thread lists of freed blocks, sorted into
+ *      size classes, so that when many images are converted in one process
+ *      the memory of one image is reused, already paged in, by the next one
+ *      instead of going back to the system. Pool_reset marks the end of an
+ *      image, and Pool_stats reports how often blocks were reused and how
+ *      much memory was in use at most.
+ *
+ *******************************************************************/
+#ifndef POOL_INCLUDED
+#define POOL_INCLUDED
+
+#include <stddef.h>
+
+/* every block handed out starts on a boundary of this many bytes */
+#define POOL_ALIGNMENT 64
+
+/*
+ * This is the struct definition of the Pool_stats instance
+ * Elements:
+ *      size_t allocations: the number of blocks handed out
+ *      size_t reused: how many of them were freed blocks being reused
+ *      size_t in_use: the bytes handed out and not freed yet
+ *      size_t high_water: the most bytes that were ever in use at once
+ *      size_t cached: the bytes in freed blocks kept for reuse
+ *      size_t images: the number of calls to Pool_reset
+ *
+ */
+struct Pool_stats {
+        size_t allocations;
+        size_t reused;
+        size_t in_use;
+        size_t high_water;
+        size_t cached;
+        size_t images;
+};
+
+void *Pool_alloc(size_t size);
+void Pool_free(void *block);
+
+void Pool_reset(void);
+void Pool_release(void);
+struct Pool_stats Pool_stats(void);
+
+#endif
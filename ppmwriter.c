@@ -0,0 +1,285 @@
+/********************************************************************
+ *
+ *                          ppmwriter.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for ppmwriter.h
+ *
+ *     Summary:
+ *      ppmwriter writes a P6 image from rows of 8-bit RGB bytes straight to
+ *      the output's file descriptor, a buffer of rows at a time.
+ *
+ *     Notes:
+ *   - The header is written by the same writev call as the first rows, and
+ *     rows passed to Ppmwriter_write go out in the same call as whatever is
+ *     still buffered, so a whole raster costs one system call and no copy
+ *   - Rows handed out by Ppmwriter_rows stay in the buffer until it fills
+ *     up, which takes BUFFER_BYTES (or the whole image, if that is smaller),
+ *     or until Ppmwriter_finish
+ *   - The output stream is flushed before the first write, and nothing is
+ *     written through it afterwards, so the two never interleave
+ *   - A write that is cut short, as on a pipe, is resumed where it stopped
+ *   - This module uses functions from pool.h
+ *******************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "assert.h"
+#include "pool.h"
+#include "ppmwriter.h"
+
+#define BUFFER_BYTES (1 << 20)
+#define HEADER_BYTES 32
+#define DENOMINATOR 255
+
+/*
+ * This is the struct definition of the Ppmwriter instance
+ * Elements:
+ *      int fd: the file descriptor of the output
+ *      size_t row_bytes: the number of bytes in a row
+ *      unsigned height: the number of rows in the image
+ *      unsigned rows: the number of rows handed to the writer so far
+ *      char header[]: the P6 header
+ *      size_t header_bytes: the length of the header, or 0 once written
+ *      unsigned char *buffer: rows that haven't been written yet
+ *      size_t capacity: the size of buffer
+ *      size_t used: the number of bytes in buffer
+ *
+ */
+struct Ppmwriter {
+        int fd;
+        size_t row_bytes;
+        unsigned height;
+        unsigned rows;
+        char header[HEADER_BYTES];
+        size_t header_bytes;
+        unsigned char *buffer;
+        size_t capacity;
+        size_t used;
+};
+
+static void flush(Ppmwriter writer, const unsigned char *rows, size_t bytes);
+static void write_all(int fd, struct iovec *parts, int count);
+
+/**********Ppmwriter_new********
+ *
+ * Starts writing a P6 image with a denominator of 255
+ * Inputs:
+ *              FILE *output: where the image is written
+ *              unsigned width: the number of pixels in each row
+ *              unsigned height: the number of rows
+ * Return: a writer that takes the rows of the image, from top to bottom
+ * Expects:
+ *      * output to be nonnull
+ * Notes:
+ *      * flushes output, which must not be written to again until the
+ *        writer is finished
+ *      * the caller assumes ownership of the returned writer, which is
+ *        freed by Ppmwriter_finish
+ *      * checked runtime error if output is NULL or can't be flushed
+ ************************/
+Ppmwriter Ppmwriter_new(FILE *output, unsigned width, unsigned height)
+{
+        assert(output != NULL);
+        int flushed = fflush(output);
+        assert(flushed == 0);
+
+        Ppmwriter writer = malloc(sizeof(*writer));
+        assert(writer != NULL);
+        writer->fd = fileno(output);
+        writer->row_bytes = (size_t)width * 3;
+        writer->height = height;
+        writer->rows = 0;
+        writer->header_bytes = snprintf(writer->header, HEADER_BYTES,
+                                        "P6\n%u %u\n%u\n", width, height,
+                                        DENOMINATOR);
+        writer->capacity = writer->row_bytes * height;
+        if (writer->capacity > BUFFER_BYTES) {
+                writer->capacity = BUFFER_BYTES;
+        }
+        writer->buffer = Pool_alloc(writer->capacity);
+        writer->used = 0;
+        return writer;
+}
+
+/**********Ppmwriter_rows********
+ *
+ * Hands out room for the next rows of the image
+ * Inputs:
+ *              Ppmwriter writer: the writer
+ *              int count: the number of rows
+ * Return: a pointer to count * 3 * width bytes, to be filled with the rows
+ * Expects:
+ *      * writer to be nonnull
+ *      * count to be positive, and no more than the rows still to come
+ * Notes:
+ *      * the rows must be filled in before the next call on writer
+ *      * checked runtime error if:
+ *              * writer is NULL
+ *              * count is out of range
+ *              * the rows can't be written
+ ************************/
+unsigned char *Ppmwriter_rows(Ppmwriter writer, int count)
+{
+        assert(writer != NULL);
+        assert(count > 0 && (unsigned)count <= writer->height - writer->rows);
+        size_t bytes = (size_t)count * writer->row_bytes;
+
+        if (bytes > writer->capacity - writer->used) {
+                flush(writer, NULL, 0);
+        }
+        if (bytes > writer->capacity) {
+                Pool_free(writer->buffer);
+                writer->capacity = bytes;
+                writer->buffer = Pool_alloc(writer->capacity);
+        }
+
+        unsigned char *rows = writer->buffer + writer->used;
+        writer->used += bytes;
+        writer->rows += count;
+        return rows;
+}
+
+/**********Ppmwriter_write********
+ *
+ * Writes the next rows of the image from where they already are
+ * Inputs:
+ *              Ppmwriter writer: the writer
+ *              const unsigned char *rows: count rows of 3 * width bytes
+ *              int count: the number of rows
+ * Return: N/A
+ * Expects:
+ *      * writer and rows to be nonnull
+ *      * count to be nonnegative, and no more than the rows still to come
+ * Notes:
+ *      * rows that fit in the rest of the buffer are copied there; more
+ *        rows than that are written straight from rows, so rows can be
+ *        reused as soon as this returns
+ *      * checked runtime error if:
+ *              * writer or rows is NULL
+ *              * count is out of range
+ *              * the rows can't be written
+ ************************/
+void Ppmwriter_write(Ppmwriter writer, const unsigned char *rows, int count)
+{
+        assert(writer != NULL && rows != NULL);
+        assert(count >= 0 && (unsigned)count <= writer->height - writer->rows);
+        size_t bytes = (size_t)count * writer->row_bytes;
+
+        if (bytes <= writer->capacity - writer->used) {
+                memcpy(writer->buffer + writer->used, rows, bytes);
+                writer->used += bytes;
+        } else {
+                flush(writer, rows, bytes);
+        }
+        writer->rows += count;
+}
+
+/**********Ppmwriter_finish********
+ *
+ * Writes whatever is still buffered and frees a writer
+ * Inputs:
+ *              Ppmwriter *writer: a pointer to the writer
+ * Return: N/A
+ * Expects:
+ *      * writer and *writer to be nonnull
+ *      * every row of the image to have been given to the writer
+ * Notes:
+ *      * sets *writer to NULL
+ *      * checked runtime error if:
+ *              * writer or *writer is NULL
+ *              * rows are missing
+ *              * the rows can't be written
+ ************************/
+void Ppmwriter_finish(Ppmwriter *writer)
+{
+        assert(writer != NULL && *writer != NULL);
+        assert((*writer)->rows == (*writer)->height);
+
+        flush(*writer, NULL, 0);
+        Pool_free((*writer)->buffer);
+        free(*writer);
+        *writer = NULL;
+}
+
+/**********flush********
+ *
+ * Writes the header if it hasn't been written, the buffered rows, and then
+ * some more rows, all in one writev call
+ * Inputs:
+ *              Ppmwriter writer: the writer
+ *              const unsigned char *rows: rows to write after the buffered
+ *                                         ones, or NULL
+ *              size_t bytes: the number of bytes in rows
+ * Return: N/A
+ * Expects:
+ *      * writer to be nonnull
+ * Notes:
+ *      * empties the buffer
+ ************************/
+static void flush(Ppmwriter writer, const unsigned char *rows, size_t bytes)
+{
+        struct iovec parts[3];
+        int count = 0;
+
+        if (writer->header_bytes > 0) {
+                parts[count].iov_base = writer->header;
+                parts[count++].iov_len = writer->header_bytes;
+        }
+        if (writer->used > 0) {
+                parts[count].iov_base = writer->buffer;
+                parts[count++].iov_len = writer->used;
+        }
+        if (bytes > 0) {
+                parts[count].iov_base = (void *)rows;
+                parts[count++].iov_len = bytes;
+        }
+
+        write_all(writer->fd, parts, count);
+        writer->header_bytes = 0;
+        writer->used = 0;
+}
+
+/**********write_all********
+ *
+ * Writes every byte of a list of buffers to a file descriptor
+ * Inputs:
+ *              int fd: the file descriptor
+ *              struct iovec *parts: the buffers, which are changed as they
+ *                                   are written
+ *              int count: the number of buffers
+ * Return: N/A
+ * Expects:
+ *      * parts to be nonnull if count is positive
+ * Notes:
+ *      * checked runtime error if a write fails
+ ************************/
+static void write_all(int fd, struct iovec *parts, int count)
+{
+        while (count > 0) {
+                ssize_t written = writev(fd, parts, count);
+                if (written < 0 && errno == EINTR) {
+                        continue;
+                }
+                assert(written >= 0);
+
+                size_t left = written;
+                while (count > 0 && left >= parts->iov_len) {
+                        left -= parts->iov_len;
+                        parts++;
+                        count--;
+                }
+                if (count > 0) {
+                        parts->iov_base = (char *)parts->iov_base + left;
+                        parts->iov_len -= left;
+                }
+        }
+}
@@ -0,0 +1,33 @@
+/********************************************************************
+ *
+ *                          ppmwriter.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for ppmwriter.c
+ *
+ *     Summary:
+ *      ppmwriter writes a P6 image from rows of interleaved 8-bit RGB
+ *      bytes, with a few large write and writev calls instead of a walk
+ *      over a pixmap. Rows are taken as they are produced: a decoder that
+ *      makes a few rows at a time asks Ppmwriter_rows for room in the
+ *      writer's buffer and decodes straight into it, and rows that are
+ *      already in memory, up to a whole raster, are written where they are
+ *      with Ppmwriter_write.
+ *
+ *******************************************************************/
+#ifndef PPMWRITER_INCLUDED
+#define PPMWRITER_INCLUDED
+
+#include <stdio.h>
+
+typedef struct Ppmwriter *Ppmwriter;
+
+Ppmwriter Ppmwriter_new(FILE *output, unsigned width, unsigned height);
+unsigned char *Ppmwriter_rows(Ppmwriter writer, int count);
+void Ppmwriter_write(Ppmwriter writer, const unsigned char *rows, int count);
+void Ppmwriter_finish(Ppmwriter *writer);
+
+#endif
@@ -12,44 +12,23 @@
  *      quantization includes functions neccesary to perform quantization from 
  *      floats to scaled ints and dequantization from scaled intos to floats.
  *      The floats are to be stored in a struct of six float values, and the 
- *      scaled ints are to be stored in a 32-bit word using the bitpack.h 
- *      interface
+ *      scaled ints are to be stored in a 32-bit word using the inline
+ *      functions bitfields.h generates for the code word layout
  * 
  *     Notes:
- *   - This module uses function from these other modules: arith40.h, 
- *     and bitpack.h
+ *   - This module uses function from these other modules: chroma.h, 
+ *     bitfields.h (through quantization.h), and bitpack.h for its exception
  *******************************************************************/
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include "assert.h"
-#include "arith40.h"
+#include "except.h"
+#include "chroma.h"
 #include "bitpack.h"
 #include "quantization.h"
 
-/* bit size values for each value being stored in the 32-bit word */
-#define A_BIT_SIZE 6
-#define B_BIT_SIZE 6
-#define C_BIT_SIZE 6
-#define D_BIT_SIZE 6
-#define PB_BIT_SIZE 4
-#define PR_BIT_SIZE 4
-
-/* 
- * least significant bit values for each value being stored in the 32-bit word
- */
-#define A_LSB 26
-#define B_LSB 20
-#define C_LSB 14
-#define D_LSB 8
-#define PB_LSB 4
-#define PR_LSB 0
-
-/* our specific literals for quantizing and dequantizing a, b, c, and d */
-#define A_CODE 63.0
-#define BCD_CODE (0.6 / 63)
-
 /**********quantization********
  *
  * Quantizes 6 float values into scaled ints and returns a 32-bit word 
@@ -61,7 +40,7 @@
  * Expects:
  *      * one_block to be non NULL
  * Notes:
- *      * uses the arith40.h interface to find the index of pbavg and pravg
+ *      * uses the chroma.h interface to find the index of pbavg and pravg
  *      * checked runtime error if:
  *              * one_block is NULL
  ************************/
@@ -69,8 +48,8 @@ uint64_t quantization(block_values one_block)
 {
         assert(one_block != NULL);
 
-        unsigned pbavg_index = Arith40_index_of_chroma(one_block->pbavg);
-        unsigned pravg_index = Arith40_index_of_chroma(one_block->pravg);
+        unsigned pbavg_index = Chroma_index_of(one_block->pbavg);
+        unsigned pravg_index = Chroma_index_of(one_block->pravg);
         unsigned a = round((one_block->a) * A_CODE);
         int b = quantized_5bit(one_block->b);
         int c = quantized_5bit(one_block->c);
@@ -96,23 +75,20 @@ uint64_t quantization(block_values one_block)
  * Expects:
  *      N/A
  * Notes:
- *      * uses the bitpack.h interface to pack the ints into their correct bits
- *        within the 32-bit word
+ *      * checks all 6 values once, then packs them with Codeword_pack
+ *      * raises Bitpack_Overflow if any value doesn't fit in its field
  ************************/
 uint64_t packed_32_bit_word(unsigned pbavg, unsigned pravg, unsigned a, int b,
                                                                         int c, 
                                                                         int d)
 {
-        uint64_t word = 0;
+        struct Codeword_fields fields = { .a = a, .b = b, .c = c, .d = d,
+                                          .pb = pbavg, .pr = pravg };
 
-        word = Bitpack_newu(word, A_BIT_SIZE, A_LSB, a);
-        word = Bitpack_news(word, B_BIT_SIZE, B_LSB, b);
-        word = Bitpack_news(word, C_BIT_SIZE, C_LSB, c);
-        word = Bitpack_news(word, D_BIT_SIZE, D_LSB, d);
-        word = Bitpack_newu(word, PB_BIT_SIZE, PB_LSB, pbavg);
-        word = Bitpack_newu(word, PR_BIT_SIZE, PR_LSB, pravg);
-
-        return word;
+        if (!Codeword_fits(fields)) {
+                RAISE(Bitpack_Overflow);
+        }
+        return Codeword_pack(fields);
 }
 
 /**********quantized_5bit********
@@ -146,34 +122,28 @@ int quantized_5bit(float value)
  * Inputs:
  *              uint64_t word: a 64-bit word holding the 32-bit word being 
  *                             unpacked and unquantized
- * Return: a pointer to a struct containing 6 float values, representing the 6
- *         values from the compressed image 32-bit word unquantized into floats
+ * Return: a struct containing 6 float values, representing the 6 values
+ *         from the compressed image 32-bit word unquantized into floats
  * Expects:
  *      N/A
  * Notes:
- *      * Allocates memory for the block_values struct that isn't freed within
- *        this function. Caller assumes ownership of the returned block_values
- *        struct.
- *      * uses the arith40.h interface to find the chroma of the pbavg and 
+ *      * returns the struct by value, so nothing is allocated
+ *      * uses the chroma.h interface to find the chroma of the pbavg and 
  *        pravg indices
- *      * uses the bitpack.h interface to find the ints from their specific
- *        bits within the 32-bit word inputted
+ *      * finds the ints in their specific bits within the 32-bit word with
+ *        Codeword_unpack
  ************************/
-block_values unpacked_floats(uint64_t word) 
+struct block_values unpacked_floats(uint64_t word) 
 {
-        block_values float_one_block = malloc(sizeof(struct block_values));
+        struct block_values float_one_block;
+        struct Codeword_fields fields = Codeword_unpack(word);
         
-        float_one_block->a = (Bitpack_getu(word, A_BIT_SIZE, A_LSB)) / A_CODE;
-        float_one_block->b = unquantized_5bit(Bitpack_gets(word, B_BIT_SIZE, 
-                                                                        B_LSB));
-        float_one_block->c = unquantized_5bit(Bitpack_gets(word, C_BIT_SIZE, 
-                                                                        C_LSB));
-        float_one_block->d = unquantized_5bit(Bitpack_gets(word, D_BIT_SIZE,
-                                                                        D_LSB));
-        float_one_block->pbavg = Arith40_chroma_of_index
-                                      (Bitpack_getu(word, PB_BIT_SIZE, PB_LSB));
-        float_one_block->pravg = Arith40_chroma_of_index
-                                      (Bitpack_getu(word, PR_BIT_SIZE, PR_LSB));
+        float_one_block.a = fields.a / A_CODE;
+        float_one_block.b = unquantized_5bit(fields.b);
+        float_one_block.c = unquantized_5bit(fields.c);
+        float_one_block.d = unquantized_5bit(fields.d);
+        float_one_block.pbavg = Chroma_of_index(fields.pb);
+        float_one_block.pravg = Chroma_of_index(fields.pr);
 
         return float_one_block;
 }
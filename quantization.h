@@ -20,6 +20,45 @@
 #ifndef QUANTIZATION_INCLUDED
 #define QUANTIZATION_INCLUDED
 
+#include "bitfields.h"
+
+/* bit size values for each value being stored in the 32-bit word */
+#define A_BIT_SIZE 6
+#define B_BIT_SIZE 6
+#define C_BIT_SIZE 6
+#define D_BIT_SIZE 6
+#define PB_BIT_SIZE 4
+#define PR_BIT_SIZE 4
+
+/* 
+ * least significant bit values for each value being stored in the 32-bit word
+ */
+#define A_LSB 26
+#define B_LSB 20
+#define C_LSB 14
+#define D_LSB 8
+#define PB_LSB 4
+#define PR_LSB 0
+
+/*
+ * the layout of a code word for bitfields.h, which defines struct
+ * Codeword_fields and the inline functions Codeword_fits, Codeword_pack and
+ * Codeword_unpack
+ */
+#define CODEWORD_FIELD_LIST(X, arg) \
+        X(a, unsigned, A_BIT_SIZE, A_LSB, arg) \
+        X(b, signed, B_BIT_SIZE, B_LSB, arg) \
+        X(c, signed, C_BIT_SIZE, C_LSB, arg) \
+        X(d, signed, D_BIT_SIZE, D_LSB, arg) \
+        X(pb, unsigned, PB_BIT_SIZE, PB_LSB, arg) \
+        X(pr, unsigned, PR_BIT_SIZE, PR_LSB, arg)
+
+BITFIELDS_LAYOUT(Codeword, CODEWORD_FIELD_LIST)
+
+/* our specific literals for quantizing and dequantizing a, b, c, and d */
+#define A_CODE 63.0
+#define BCD_CODE (0.6 / 63)
+
 typedef struct block_values *block_values;
 
 /*
@@ -54,7 +93,7 @@ uint64_t packed_32_bit_word(unsigned pbavg, unsigned pravg,
                                         unsigned a, int b, int c, int d);
 int quantized_5bit(float value);
 
-block_values unpacked_floats(uint64_t word);
+struct block_values unpacked_floats(uint64_t word);
 float unquantized_5bit(int64_t five_bit);
 
 #endif
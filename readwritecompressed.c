@@ -9,110 +9,551 @@
  *      * Implementation for readwritecompressed.c
  *
  *     Summary:
- *      readwritecompressed either writes a UArray2b of 32-bit codewords to 
- *      stdout or reads in a compressed image from either a file or stdin and 
- *      converts the image into a UArray2b of 32-bit codewords
+ *      readwritecompressed either writes a Codewords buffer of 32-bit 
+ *      codewords to stdout or reads in a compressed image from either a file 
+ *      or stdin and converts the image into a Codewords buffer
  * 
  *     Notes:
- *   - This module uses function from these other modules: uarray2b.h, 
- *     and bitpack.h
+ *   - The words of an image are one flat buffer, so they are converted in
+ *     chunks of CHUNK_WORDS no matter where rows end, with the vector byte
+ *     reversal of codewords.h, and each chunk costs one fwrite of a
+ *     megabyte, which stdio passes straight to the system
+ *   - The format number in the header says which color transform the code
+ *     words were encoded with, or that they hold a graymap (see
+ *     Compressed_format)
+ *   - encode_compressed_file maps the output file with outputmap.h, and
+ *     the threads of bands.h each encode their band of rows straight into
+ *     it, with no buffer of the whole image's code words.
+ *     write_compressed_file does the same with rows of code words that are
+ *     already encoded
+ *   - In the native container (see Compressed_container) the code words
+ *     are written as they are in memory, after a struct Native_header, so
+ *     there is nothing to convert: standard output gets them with one
+ *     fwrite, and a mapped file gets them straight from the encoder.
+ *     The header is exactly NATIVE_ALIGN bytes, so the words start on an
+ *     aligned offset and a reader that maps the file can use them in place
+ *   - Compressed files are read in place by wordview.h, which maps them
+ *     and reads either container
+ *   - When convert_compressed_file is asked for the container its input is
+ *     already in, with the header it would write itself, the input is
+ *     passed through unchanged. If standard output is a pipe and the input
+ *     is a mapped file, the bytes go from the file to the pipe with splice,
+ *     without ever being copied through this process; otherwise, or if
+ *     splice fails, they are written from the mapping with fwrite
+ *   - This module uses function from these other modules: codewords.h,
+ *     inputmap.h, wordview.h, outputmap.h, bands.h and pool.h
  *******************************************************************/
+#define _GNU_SOURCE
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "assert.h"
-#include "uarray2b.h"
-#include "bitpack.h"
+#include "codewords.h"
+#include "pool.h"
+#include "readwritecompressed.h"
+#include "inputmap.h"
+#include "wordview.h"
+#include "outputmap.h"
+#include "bands.h"
+
+/* splice moves file pages into a pipe on Linux only */
+#if defined(__linux__)
+#define SPLICE_OUTPUT 1
+#else
+#define SPLICE_OUTPUT 0
+#endif
+
+/* the number of code words converted and written or read at a time */
+#define CHUNK_WORDS (1 << 18)
+/* the header of a compressed image, and room for the longest one */
+#define HEADER_FORMAT "COMP40 Compressed image format %d\n%u %u\n"
+#define HEADER_BYTES 64
+/* the fewest rows of code words worth a thread */
+#define MIN_BAND_ROWS 32
+
+/*
+ * This is the struct definition of an image being encoded into a mapped
+ * file, which is shared by the bands of encode_compressed_file
+ * Elements:
+ *      int width: the number of code words in each row
+ *      Compressed_container container: the container of the file
+ *      Compressed_row *encode: gives the code words of one row
+ *      void *closure: passed to every call of encode
+ *      unsigned char *bytes: where the first row goes in the file
+ *
+ */
+struct encoding {
+        int width;
+        Compressed_container container;
+        Compressed_row *encode;
+        void *closure;
+        unsigned char *bytes;
+};
+
+static int make_header(int width, int height, Compressed_format format,
+                       Compressed_container container, char *header);
+static size_t chunk_words(Codewords compressed_blocks);
+static void encode_band(void *closure, int first, int last);
+static bool passes_through(Wordview view, Compressed_container container);
+static void pass_through(FILE *input, Wordview view);
+static size_t spliced(int fd, off_t offset, size_t size);
+static const uint32_t *codewords_row(void *closure, int row,
+                                     uint32_t *words);
 
 /**********print_to_stdout********
  *
  * Writes a compressed binary image to output in the appropriate format. Each 
- * 32-bit code word is written in big-endian order, and the 32-bit code words
- * are printed to output in row-major order.
+ * 32-bit code word is written in big-endian order, or in native order in the
+ * native container, and the 32-bit code words are printed to output in
+ * row-major order.
  * Inputs:
- *              UArray2b_T compressed_blocks: the UArray2b that stores the 
- *                                            32-bit code words that correspond
- *                                            to each 2x2 block
+ *              Codewords compressed_blocks: the buffer that stores the 
+ *                                           32-bit code words that correspond
+ *                                           to each 2x2 block
+ *              Compressed_format format: the format number for the header
+ *              Compressed_container container: the container to write
  * Return: N/A
  * Expects:
  *      * compressed_blocks to be nonnull
  * Notes:
- *      * frees up memory for the inputted UArray2b
+ *      * frees up memory for the inputted Codewords
  *      * checked runtime error if:
  *              * compressed_blocks is NULL
+ *              * a row can't be written to stdout
  ************************/
-void print_to_stdout(UArray2b_T compressed_blocks) 
+void print_to_stdout(Codewords compressed_blocks, Compressed_format format,
+                     Compressed_container container)
 {
         assert(compressed_blocks != NULL);
-        unsigned width = UArray2b_width(compressed_blocks) * 2;
-        unsigned height = UArray2b_height(compressed_blocks) * 2;
-
-        printf("COMP40 Compressed image format 2\n%u %u", width, height);
-        printf("\n");
-        
-        for (int row = 0; row < UArray2b_height(compressed_blocks); row++) {
-                for (int col = 0; col < UArray2b_width(compressed_blocks); 
-                                                                     col++) {
-                        uint64_t current_word = 
-                                *(uint64_t *)UArray2b_at(compressed_blocks, 
-                                                                       col, 
-                                                                       row);
-                        /* prints out each word to stdout in big-endian order */
-                        for (int i = 24; i >= 0; i -= 8) {
-                                putchar(Bitpack_getu(current_word, 8, i));
-                        }
-                }
+        char header[HEADER_BYTES];
+        int header_bytes = make_header(compressed_blocks->width,
+                                       compressed_blocks->height, format,
+                                       container, header);
+        size_t count = (size_t)compressed_blocks->width *
+                       compressed_blocks->height;
+        size_t header_written = fwrite(header, 1, header_bytes, stdout);
+        assert(header_written == (size_t)header_bytes);
+
+        if (container == COMPRESSED_NATIVE) {
+                size_t written = fwrite(compressed_blocks->words,
+                                        CODEWORD_BYTES, count, stdout);
+                assert(written == count);
+                Codewords_free(&compressed_blocks);
+                return;
         }
-        UArray2b_free(&compressed_blocks);
+
+        size_t chunk = chunk_words(compressed_blocks);
+        unsigned char *buffer = Pool_alloc(chunk * CODEWORD_BYTES);
+
+        for (size_t done = 0; done < count; done += chunk) {
+                size_t words = count - done < chunk ? count - done : chunk;
+                size_t bytes = words * CODEWORD_BYTES;
+                /* converts each word of the chunk to big-endian order */
+                Codewords_to_bigendian(compressed_blocks->words + done,
+                                       buffer, words);
+                size_t written = fwrite(buffer, 1, bytes, stdout);
+                assert(written == bytes);
+        }
+
+        Pool_free(buffer);
+        Codewords_free(&compressed_blocks);
+}
+
+/**********write_compressed_file********
+ *
+ * Writes a compressed binary image to a file, like print_to_stdout, by
+ * mapping the file and converting the code words straight into it with
+ * encode_compressed_file
+ * Inputs:
+ *              Codewords compressed_blocks: the buffer that stores the 
+ *                                           32-bit code words that correspond
+ *                                           to each 2x2 block
+ *              Compressed_format format: the format number for the header
+ *              Compressed_container container: the container to write
+ *              const char *path: the name of the file, which is created or
+ *                                replaced
+ * Return: N/A
+ * Expects:
+ *      * compressed_blocks and path to be nonnull
+ * Notes:
+ *      * the file holds the same bytes print_to_stdout would write
+ *      * frees up memory for the inputted Codewords
+ *      * checked runtime error if:
+ *              * compressed_blocks or path is NULL
+ *              * the file can't be created or mapped
+ ************************/
+void write_compressed_file(Codewords compressed_blocks,
+                           Compressed_format format,
+                           Compressed_container container, const char *path)
+{
+        assert(compressed_blocks != NULL && path != NULL);
+
+        encode_compressed_file(compressed_blocks->width,
+                               compressed_blocks->height, format, container,
+                               codewords_row, compressed_blocks, path);
+        Codewords_free(&compressed_blocks);
+}
+
+/**********encode_compressed_file********
+ *
+ * Writes a compressed binary image to a file a row at a time, with each
+ * band of rows encoded by its own thread straight into the mapped file
+ * Inputs:
+ *              int width: the number of code words in each row
+ *              int height: the number of rows of code words
+ *              Compressed_format format: the format number for the header
+ *              Compressed_container container: the container to write
+ *              Compressed_row *encode: gives the code words of one row
+ *              void *closure: passed to every call of encode
+ *              const char *path: the name of the file, which is created or
+ *                                replaced
+ * Return: N/A
+ * Expects:
+ *      * encode and path to be nonnull
+ *      * width and height to be nonnegative
+ *      * encode to give the same words for a row whichever thread calls it,
+ *        and to only read closure (see bands.h)
+ * Notes:
+ *      * encode is called once for every row: row 0 first, on the calling
+ *        thread, and then the other rows, on several threads at once
+ *      * the file holds the same bytes print_to_stdout would write for the
+ *        same code words
+ *      * checked runtime error if:
+ *              * encode or path is NULL, or width or height is negative
+ *              * the file can't be created or mapped
+ ************************/
+void encode_compressed_file(int width, int height, Compressed_format format,
+                            Compressed_container container,
+                            Compressed_row *encode, void *closure,
+                            const char *path)
+{
+        assert(encode != NULL && path != NULL);
+        assert(width >= 0 && height >= 0);
+        char header[HEADER_BYTES];
+        int header_bytes = make_header(width, height, format, container,
+                                       header);
+        size_t count = (size_t)width * height;
+
+        Outputmap map = Outputmap_new(path, header_bytes +
+                                            count * CODEWORD_BYTES);
+        memcpy(map->bytes, header, header_bytes);
+        struct encoding encoding = { width, container, encode, closure,
+                                     map->bytes + header_bytes };
+        Bands_run(height, MIN_BAND_ROWS, encode_band, &encoding);
+
+        Outputmap_finish(&map);
 }
 
 /**********read_compressed_file********
  *
  * Reads a compressed binary image from output in the appropriate format 
  * (ie reads the 32-bit code words in sequence). Stores the inputted 32-bit 
- * code words in a new UArray2b.
+ * code words in a new Codewords buffer.
  * Inputs:
  *              FILE *input: a pointer to the input compressed binary image
  *                           file
- * Return: a UArray2b that holds the extracted 32-bit code words
+ *              Compressed_format *format: where the format number from the
+ *                                         header goes
+ * Return: a Codewords buffer that holds the extracted 32-bit code words
  * Expects:
- *      * input to be nonnull
+ *      * input and format to be nonnull
  *      * supplied input file to match the number of code words for the stated 
  *      width and height
  * Notes:
- *      * frees up memory for the inputted UArray2b
+ *      * the file is mapped and parsed by wordview.h, and its words are
+ *        converted straight from the mapping
+ *      * the caller assumes ownership of the returned Codewords
  *      * checked runtime error if:
- *              * input is NULL
- *              * if supplied file is too short for given width and height
+ *              * input or format is NULL
+ *              * the header's format number isn't a Compressed_format
+ *              * if supplied file is too short or too long for given width
+ *                and height
  ************************/
-UArray2b_T read_compressed_file(FILE *input)
+Codewords read_compressed_file(FILE *input, Compressed_format *format)
 {
+        assert(input != NULL && format != NULL);
+        Wordview view = Wordview_read(input);
+
+        *format = view->format;
+        Codewords compressed_blocks = Wordview_codewords(view);
+        Wordview_free(&view);
+        return compressed_blocks;
+}
 
+/**********convert_compressed_file********
+ *
+ * Rewrites a compressed image in another container, with the same code
+ * words and format number
+ * Inputs:
+ *              FILE *input: the compressed image, in either container
+ *              Compressed_container container: the container to write
+ *              const char *path: the file to write, or NULL for standard
+ *                                output
+ * Return: N/A
+ * Expects:
+ *      * input to be nonnull
+ * Notes:
+ *      * converting to COMPRESSED_TEXT and back gives the same bytes, and
+ *        so does the other way around
+ *      * an image already in container, written to standard output, is
+ *        passed through unchanged (see pass_through)
+ *      * checked runtime error if input is NULL, or the image can't be read
+ *        or written
+ ************************/
+void convert_compressed_file(FILE *input, Compressed_container container,
+                             const char *path)
+{
         assert(input != NULL);
-        unsigned height, width;
-        int read = fscanf(input, "COMP40 Compressed image format 2\n%u %u",
-                                                           &width, &height);
-        assert(read == 2);
-        int c = getc(input);
-        assert(c == '\n');
-
-        UArray2b_T compressed_blocks = UArray2b_new(width / 2, height / 2, 
-                                                        sizeof(uint64_t), 1);
-
-        for (int row = 0; row < UArray2b_height(compressed_blocks); row++) {
-                for (int col = 0; col < UArray2b_width(compressed_blocks); 
-                                                                     col++) {
-                        uint64_t current_word = 0;
-                        /* reads in each word from input in big-endian order */
-                        for (int i = 24; i >= 0; i -= 8) {
-                                int current_bit = getc(input);
-                                assert(current_bit != EOF);
-                                current_word = Bitpack_newu(current_word, 8, i,
-                                                                   current_bit);
+        Wordview view = Wordview_read(input);
+
+        if (path == NULL && passes_through(view, container)) {
+                pass_through(input, view);
+                Wordview_free(&view);
+                return;
+        }
+
+        Compressed_format format = view->format;
+        Codewords compressed_blocks = Wordview_codewords(view);
+        Wordview_free(&view);
+
+        if (path == NULL) {
+                print_to_stdout(compressed_blocks, format, container);
+        } else {
+                write_compressed_file(compressed_blocks, format, container,
+                                      path);
+        }
+}
+
+/**********make_header********
+ *
+ * Makes the header of a compressed image
+ * Inputs:
+ *              int width: the number of code words in each row
+ *              int height: the number of rows of code words
+ *              Compressed_format format: the format number for the header
+ *              Compressed_container container: the container to write
+ *              char *header: where the header goes, HEADER_BYTES long
+ * Return: the length of the header
+ * Expects:
+ *      * header to be nonnull
+ * Notes:
+ *      * the native header is NATIVE_HEADER_BYTES long, which is also the
+ *        offset of its code words, so nothing pads them to NATIVE_ALIGN
+ ************************/
+static int make_header(int width, int height, Compressed_format format,
+                       Compressed_container container, char *header)
+{
+        if (container == COMPRESSED_TEXT) {
+                return snprintf(header, HEADER_BYTES, HEADER_FORMAT,
+                                (int)format, (unsigned)width * 2,
+                                (unsigned)height * 2);
+        }
+
+        struct Native_header native;
+        assert(sizeof(native) == NATIVE_HEADER_BYTES &&
+               NATIVE_HEADER_BYTES % NATIVE_ALIGN == 0 &&
+               NATIVE_HEADER_BYTES <= HEADER_BYTES);
+        memset(&native, 0, sizeof(native));
+        memcpy(native.magic, NATIVE_MAGIC, NATIVE_MAGIC_BYTES);
+        native.version = NATIVE_VERSION;
+        native.byte_order = NATIVE_BYTE_ORDER;
+        native.layout = NATIVE_ROW_MAJOR;
+        native.format = format;
+        native.width = (uint32_t)width * 2;
+        native.height = (uint32_t)height * 2;
+        native.word_offset = NATIVE_HEADER_BYTES;
+        native.word_count = (uint64_t)width * height;
+        memcpy(header, &native, sizeof(native));
+        return NATIVE_HEADER_BYTES;
+}
+
+/**********chunk_words********
+ *
+ * Picks how many code words are converted at a time
+ * Inputs:
+ *              Codewords compressed_blocks: the code words of the image
+ * Return: CHUNK_WORDS, or the number of words in the image if it is smaller,
+ *         and at least 1
+ * Expects:
+ *      * compressed_blocks to be nonnull
+ ************************/
+static size_t chunk_words(Codewords compressed_blocks)
+{
+        size_t count = (size_t)compressed_blocks->width *
+                       compressed_blocks->height;
+
+        if (count > CHUNK_WORDS) {
+                return CHUNK_WORDS;
+        }
+        return count > 0 ? count : 1;
+}
+
+/**********encode_band********
+ *
+ * Encodes a band of rows of code words into their place in a mapped file
+ * Inputs:
+ *              void *closure: the struct encoding
+ *              int first: the first row of the band
+ *              int last: one past the last row of the band
+ * Return: N/A
+ * Expects:
+ *      * closure to be nonnull
+ *      * the rows to be in range
+ * Notes:
+ *      * in the native container, each row is encoded straight into the
+ *        file, which is aligned for uint32_t since the mapping starts on a
+ *        page and the words on a multiple of NATIVE_ALIGN. In the text
+ *        container, each row is encoded into a buffer of one row, which
+ *        stays in cache, and reversed into the file from there
+ ************************/
+static void encode_band(void *closure, int first, int last)
+{
+        struct encoding *encoding = closure;
+        size_t row_bytes = (size_t)encoding->width * CODEWORD_BYTES;
+        uint32_t *buffer = NULL;
+
+        if (encoding->container == COMPRESSED_TEXT) {
+                buffer = Pool_alloc(row_bytes > 0 ? row_bytes : 1);
+        }
+        for (int row = first; row < last; row++) {
+                unsigned char *place = encoding->bytes + row * row_bytes;
+                if (buffer == NULL) {
+                        uint32_t *target = (uint32_t *)place;
+                        const uint32_t *words = encoding->encode(
+                                encoding->closure, row, target);
+                        if (words != target) {
+                                memcpy(place, words, row_bytes);
                         }
-                        *(uint64_t *)UArray2b_at(compressed_blocks, col, row) = 
-                                                                   current_word;
+                } else {
+                        const uint32_t *words = encoding->encode(
+                                encoding->closure, row, buffer);
+                        /* converts each word of the row to big-endian */
+                        Codewords_to_bigendian(words, place,
+                                               encoding->width);
+                }
+        }
+        if (buffer != NULL) {
+                Pool_free(buffer);
+        }
+}
+
+/**********codewords_row********
+ *
+ * Hands out one row of a Codewords buffer, for encode_compressed_file
+ * Inputs:
+ *              void *closure: the Codewords
+ *              int row: the row
+ *              uint32_t *words: not used
+ * Return: the row of code words, where it is in the buffer
+ * Expects:
+ *      * closure to be nonnull and row in range
+ ************************/
+static const uint32_t *codewords_row(void *closure, int row, uint32_t *words)
+{
+        (void)words;
+        return Codewords_row(closure, row);
+}
+
+/**********passes_through********
+ *
+ * Tells whether an image can be written in a container as it is
+ * Inputs:
+ *              Wordview view: the image
+ *              Compressed_container container: the container to write
+ * Return: true if the bytes of the image are exactly what would be written
+ *         for it in container, false if not
+ * Expects:
+ *      * view to be nonnull
+ * Notes:
+ *      * the header has to match byte for byte, so a native container
+ *        written in the other byte order, or a text header laid out
+ *        differently, is rewritten instead
+ ************************/
+static bool passes_through(Wordview view, Compressed_container container)
+{
+        char header[HEADER_BYTES];
+        int header_bytes = make_header(view->width, view->height,
+                                       view->format, container, header);
+        const unsigned char *bytes = view->input->bytes;
+
+        return view->words - bytes == header_bytes &&
+               memcmp(bytes, header, header_bytes) == 0;
+}
+
+/**********pass_through********
+ *
+ * Writes the bytes of an image to standard output unchanged
+ * Inputs:
+ *              FILE *input: the file the image was read from
+ *              Wordview view: the image, read from input
+ * Return: N/A
+ * Expects:
+ *      * input and view to be nonnull
+ * Notes:
+ *      * as much as splice can move goes straight from the file to the
+ *        pipe, and the rest is written from the mapping or buffer
+ *      * checked runtime error if the bytes can't be written
+ ************************/
+static void pass_through(FILE *input, Wordview view)
+{
+        Inputmap map = view->input;
+        size_t sent = 0;
+
+        if (map->mapped) {
+                off_t offset = map->bytes - (const unsigned char *)map->base;
+                sent = spliced(fileno(input), offset, map->size);
+        }
+        if (sent < map->size) {
+                size_t written = fwrite(map->bytes + sent, 1,
+                                        map->size - sent, stdout);
+                assert(written == map->size - sent);
+        }
+}
+
+/**********spliced********
+ *
+ * Moves bytes of a file to standard output with splice, if it is a pipe
+ * Inputs:
+ *              int fd: the file
+ *              off_t offset: where the bytes start in the file
+ *              size_t size: the number of bytes
+ * Return: the number of bytes moved, from the start, which is 0 if
+ *         standard output isn't a pipe or splice can't be used
+ * Expects:
+ *      * fd to be open for reading
+ * Notes:
+ *      * stops at the first call that fails, and the caller writes the
+ *        rest; the file's own position is not moved
+ ************************/
+static size_t spliced(int fd, off_t offset, size_t size)
+{
+#if SPLICE_OUTPUT
+        struct stat info;
+        if (fflush(stdout) != 0 || fstat(STDOUT_FILENO, &info) != 0 ||
+            !S_ISFIFO(info.st_mode)) {
+                return 0;
+        }
+
+        size_t sent = 0;
+        while (sent < size) {
+                loff_t from = offset + (off_t)sent;
+                ssize_t moved = splice(fd, &from, STDOUT_FILENO, NULL,
+                                       size - sent, SPLICE_F_MORE);
+                if (moved <= 0) {
+                        break;
                 }
+                sent += (size_t)moved;
         }
-        return compressed_blocks;        
+        return sent;
+#else
+        (void)fd;
+        (void)offset;
+        (void)size;
+        return 0;
+#endif
 }
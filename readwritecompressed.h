@@ -1,7 +1,99 @@
 #ifndef READWRITECOMPRESSED_INCLUDED
 #define READWRITECOMPRESSED_INCLUDED
 
-void print_to_stdout(UArray2b_T compressed_blocks);
-UArray2b_T read_compressed_file(FILE *input);
+#include <stdio.h>
+#include <stdint.h>
+#include "codewords.h"
 
-#endif
\ No newline at end of file
+/*
+ * the format numbers in the header of a compressed image, which say how its
+ * code words were encoded
+ *      COMPRESSED_YPBPR: the Y/Pb/Pr transform, the original format
+ *      COMPRESSED_YCOCG: the YCoCg-R transform of ycocg.h
+ *      COMPRESSED_GRAY: a graymap, with neutral chroma (see graymap.h)
+ */
+typedef enum Compressed_format {
+        COMPRESSED_YPBPR = 2,
+        COMPRESSED_YCOCG = 3,
+        COMPRESSED_GRAY = 4
+} Compressed_format;
+
+/*
+ * the containers a compressed image can be written in
+ *      COMPRESSED_TEXT: the text header, then the code words in big-endian
+ *                       order, the original container
+ *      COMPRESSED_NATIVE: a struct Native_header, then the code words in
+ *                         the writer's byte order, NATIVE_ALIGN aligned
+ */
+typedef enum Compressed_container {
+        COMPRESSED_TEXT,
+        COMPRESSED_NATIVE
+} Compressed_container;
+
+/* what a native container starts with, and the version this code writes */
+#define NATIVE_MAGIC "C40WORDS"
+#define NATIVE_MAGIC_BYTES 8
+#define NATIVE_VERSION 1
+/* byte_order as the writer stores it; a reader with the other order sees
+   the bytes reversed */
+#define NATIVE_BYTE_ORDER 0x01020304u
+/* the layout of the code words: one per 2x2 block, in row-major order */
+#define NATIVE_ROW_MAJOR 1
+/* the size of the header, and what the offset of the code words is a
+   multiple of */
+#define NATIVE_HEADER_BYTES 64
+#define NATIVE_ALIGN 64
+
+/*
+ * This is the struct definition of the header of a native container. Every
+ * field is naturally aligned, so there is no padding, and every number is
+ * in the byte order of byte_order
+ * Elements:
+ *      char magic[NATIVE_MAGIC_BYTES]: NATIVE_MAGIC, with no terminator
+ *      uint32_t version: NATIVE_VERSION
+ *      uint32_t byte_order: NATIVE_BYTE_ORDER, in the writer's order
+ *      uint32_t layout: NATIVE_ROW_MAJOR
+ *      uint32_t format: the Compressed_format of the code words
+ *      uint32_t width: the width of the image in pixels
+ *      uint32_t height: the height of the image in pixels
+ *      uint64_t word_offset: where the code words start in the file, a
+ *                            multiple of NATIVE_ALIGN
+ *      uint64_t word_count: the number of code words, width / 2 *
+ *                           height / 2
+ *      unsigned char reserved[16]: zeros
+ *
+ */
+struct Native_header {
+        char magic[NATIVE_MAGIC_BYTES];
+        uint32_t version;
+        uint32_t byte_order;
+        uint32_t layout;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint64_t word_offset;
+        uint64_t word_count;
+        unsigned char reserved[16];
+};
+
+/*
+ * gives the code words of one row of an image for encode_compressed_file,
+ * either in words, which has room for the row, or wherever they already are
+ */
+typedef const uint32_t *Compressed_row(void *closure, int row,
+                                       uint32_t *words);
+
+void print_to_stdout(Codewords compressed_blocks, Compressed_format format,
+                     Compressed_container container);
+void write_compressed_file(Codewords compressed_blocks,
+                           Compressed_format format,
+                           Compressed_container container, const char *path);
+void encode_compressed_file(int width, int height, Compressed_format format,
+                            Compressed_container container,
+                            Compressed_row *encode, void *closure,
+                            const char *path);
+Codewords read_compressed_file(FILE *input, Compressed_format *format);
+void convert_compressed_file(FILE *input, Compressed_container container,
+                             const char *path);
+
+#endif
@@ -15,10 +15,30 @@
  *      values to a ppm image that holds RGB color space values.
  * 
  *     Notes:
- *   - This module also contains functions that trim the last row and/or column
- *     as necessary
+ *   - Images are trimmed to an even width and height by Rgbview_trim in
+ *     rgbview.h, and every conversion only reads the pixels inside the
+ *     image's width and height
+ *   - The planar functions produce and consume a CVS_planes instead of a 
+ *     UArray2b of CVS structs, with pb and pr already averaged per 2x2 block
+ *   - The planar encoders and the YCoCg-R encoder read from an Rgbview, so
+ *     the scanlines of a P6 image are used right where they are in memory.
+ *     Only an image read by Pnm_ppmread has its scanlines gathered first
+ *   - Images with a denominator of at most 255 are converted to planes a 
+ *     pair of scanlines at a time by colorconvert.h
+ *   - Without a vector version, and for samples that don't fit in a byte, 
+ *     pixels are converted with the lookup tables in rgbtables.h
+ *   - RGBtoFixedPlanes is the start of the integer-only pipeline, which turns
+ *     RGB into CVS_planes16 through fixed-point tables
+ *   - TableViewtoP6 decodes code words straight to RGB through the tables
+ *     of decodetables.h, for either pipeline
+ *   - The P6 versions of the decoders write their scanlines straight into
+ *     the buffer of a ppmwriter.h writer instead of into a pixmap
+ *   - RGBtoYcocgWords encodes straight from RGB to code words with the
+ *     YCoCg-R transform of ycocg.h, a pair of 8-bit scanlines at a time
  *   - This module calls function from these other modules: a2methods.h, 
- *     a2blocked.h and uarray2b.h
+ *     a2blocked.h, uarray2b.h, cvsplanes.h, codewords.h, colorconvert.h, 
+ *     rgbtables.h, decodetables.h, ycocg.h, rgbview.h, ppmwriter.h,
+ *     wordview.h and pool.h
  *******************************************************************/
 #include <string.h>
 #include <stdlib.h>
@@ -29,100 +49,31 @@
 #include "a2methods.h"
 #include "a2blocked.h"
 #include "uarray2b.h"
+#include "cvsplanes.h"
+#include "codewords.h"
+#include "colorconvert.h"
+#include "rgbtables.h"
+#include "decodetables.h"
+#include "ycocg.h"
+#include "rgbview.h"
+#include "ppmwriter.h"
+#include "readwritecompressed.h"
+#include "wordview.h"
+#include "pool.h"
 #include "rgbcomponent.h"
 
 #define DENOMINATOR 255
-#define NEWBLOCKSIZE 2
+#define MAX_8_BIT_DENOMINATOR 255
 
-/**********trimmed_image********
- *
- * Trims off the last row and/or column of an inputted ppm image if necessary 
- * to make the image have an even width and height
- * Inputs:
- *              Pnm_ppm original_image: the ppm image that is to be trimmed if
- *                                      needed
- * Return: a ppm image in Pnm_ppm format that has an even width and 
- *         height value
- * Expects:
- *      * original_image to be non NULL
- * Notes:
- *      * frees up memory for the inputted pnm_ppm image, and allocates memory
- *        for the returned image. The caller assumes ownership of the returned
- *        image
- *      * checked runtime error if:
- *              * original_image is NULL
- ************************/
-Pnm_ppm trimmed_image(Pnm_ppm original_image) 
-{
-        assert(original_image != NULL);
-
-        int new_height = original_image->height;
-        int new_width = original_image->width;
-
-        if (original_image->height % 2 == 1) {
-                new_height = new_height - 1;
-        } 
-        if (original_image->width % 2 == 1) {
-                new_width = new_width - 1;
-        }
-
-        /* trimmed image pixels array for new Ppm_pnm */
-        A2Methods_UArray2 new_image_array = original_image->methods->
-                        new_with_blocksize(new_width, new_height, 
-                                original_image->methods->
-                                        size(original_image->pixels), 
-                                                                NEWBLOCKSIZE);
-
-        /* populate new array with the pixels from the old image */
-        original_image->methods->map_block_major(new_image_array, og_to_new, 
-                                                                original_image);
-        
-        Pnm_ppm new_image = malloc(sizeof(struct Pnm_ppm));
-        new_image->width = new_width;
-        new_image->height = new_height;
-        new_image->denominator = original_image->denominator;
-        new_image->pixels = new_image_array;
-        new_image->methods = original_image->methods;
-
-        Pnm_ppmfree(&original_image);
-
-        return new_image;
-}
-
-/**********og_to_new********
- *
- * Copies one pixel from one UArray2b to another new UArray2b
- * Inputs:
- *              int col: the column value of the current position in the 
- *                       A2Methods_UArray2 A2uarray2
- *              int row: the row value of the current position in the 
- *                       A2Methods_UArray2 A2uarray2
- *              A2Methods_UArray2 A2uarray2: An A2Methods_UArray2 
- *                        representing the image to be copied to 
- *                              (voided in this function)
- *              void *elem: A pointer to the element in the A2Methods_UArray2 
- *                          at position (col, row)
- *              void *original_image: An A2Methods_UArray2 representing the 
- *                                    image to be copied from
- * Return: N/A
- * Expects:
- *      None
- * Notes:
- *      * to be used in a methods->map function
- *      * in the map, copies every pixel in the bounds of the
- *        new A2Methods_UArray2 A2uarray2's width and height
- ************************/
-void og_to_new(int col, int row, A2Methods_UArray2 A2uarray2, void *elem, 
-                                                        void *original_image) 
-{
-        (void)A2uarray2;
-        /* 
-         * places the pixel at (col, row) in the old image into (col, row) of
-         * the new image
-         */
-        *(Pnm_rgb)elem = (*(Pnm_rgb)(((Pnm_ppm)original_image)->methods)
-                        ->at(((Pnm_ppm)original_image)->pixels, col, row));
-}
+static void rows_to_planes(Rgbview view, CVS_planes planes);
+static const unsigned char *view_row(Rgbview view, int row, 
+                                     unsigned char *rgb_bytes);
+static void blocks_to_planes(Pnm_ppm image, CVS_planes planes);
+static void gather_row(Pnm_ppm image, int row, unsigned char *rgb_bytes);
+static void gather_samples(Rgbview view, int row, unsigned *samples);
+static void gather_scaled_row(Rgbview view, int row, 
+                              const unsigned char *scale, 
+                              unsigned char *rgb_bytes);
 
 /**********RGBtoComponentVideo********
  *
@@ -173,14 +124,12 @@ UArray2b_T RGBtoComponentVideo(Pnm_ppm trimmed_image)
  * Return: N/A
  * Expects:
  *      trimmed_image to be nonnull
- *      one_pixel to be nonnull (created within function, not passed in)
  * Notes:
  *      * to be used as an apply function in the UArray2b_map function
- *      * in the map, copies each pixel (after it is converted to component 
- *        video space) into a new UArray2b
+ *      * in the map, writes each pixel (after it is converted to component 
+ *        video space) straight into its element of the new UArray2b
  *      * checked runtime error if
  *              * trimmed_image is NULL
- *              * one_pixel is NULL
  ************************/
 void onePixelToComponentVideo(int col, int row, UArray2b_T componentVideo, 
                                                 void *elem, void *trimmed_image)
@@ -188,8 +137,7 @@ void onePixelToComponentVideo(int col, int row, UArray2b_T componentVideo,
         (void)componentVideo;
 
         assert(trimmed_image != NULL);
-        CVS one_pixel = malloc(sizeof(struct CVS));
-        assert(one_pixel != NULL);
+        CVS one_pixel = elem;
 
         Pnm_ppm image = *(Pnm_ppm *)trimmed_image;
         Pnm_rgb rgb_struct = image->methods->at(image->pixels, col, row);
@@ -201,10 +149,6 @@ void onePixelToComponentVideo(int col, int row, UArray2b_T componentVideo,
         one_pixel->y = 0.299 * r + 0.587 * g + 0.114 * b;
         one_pixel->pb = -0.168736 * r - 0.331264 * g + 0.5 * b;
         one_pixel->pr = 0.5 * r - 0.418688 * g - 0.081312 * b;
-
-        /* set current element to its corresponding CVS struct */
-        *(CVS)elem = *one_pixel;
-        free(one_pixel);
 }
 
 /**********ComponentVideotoRGB********
@@ -276,13 +220,12 @@ Pnm_ppm ComponentVideotoRGB(UArray2b_T componentVideo)
  * Return: N/A
  * Expects:
  *      * rgb_pixmap to be non NULL
- *      * rgb_struct to be non NULL (created within function, not passed in)
  * Notes:
  *      * to be used as an apply function in the UArray2b_map function
- *      * in the map, copies each pixel from CVS to RGB color space
+ *      * in the map, converts each pixel from CVS to RGB color space
+ *        straight into its element of the pixmap
  *      * checked runtime error if:
  *              * rgb_pixmap is NULL
- *              * rgb_struct is NULL
  ************************/
 void onePixelToRGB(int col, int row, UArray2b_T componentVideo, void *elem, 
                                                              void *rgb_pixmap) 
@@ -291,17 +234,14 @@ void onePixelToRGB(int col, int row, UArray2b_T componentVideo, void *elem,
         assert(rgb_pixmap != NULL);
 
         CVS one_pixel = (CVS)UArray2b_at(componentVideo, col, row);
-        Pnm_rgb rgb_struct = malloc(sizeof(struct Pnm_rgb));
-        assert(rgb_struct != NULL);
-        
+        Pnm_ppm rgb_image = rgb_pixmap;
+
         /* 
-         * places the converted RGB struct into the new pixmap at the current
+         * converts into the RGB struct of the new pixmap at the current
          * column and row
          */
-        (*(Pnm_rgb)(((Pnm_ppm)rgb_pixmap)->methods)->
-                at(((Pnm_ppm)rgb_pixmap)->pixels, col, row)) = 
-                                        *CVS_to_RGB(one_pixel, rgb_struct);
-        free(rgb_struct);
+        CVS_to_RGB(one_pixel, rgb_image->methods->at(rgb_image->pixels, col, 
+                                                                    row));
 }
 
 /**********CVS_to_RGB********
@@ -346,3 +286,540 @@ Pnm_rgb CVS_to_RGB(CVS one_pixel, Pnm_rgb rgb_struct)
         return rgb_struct;
 }
 
+
+/**********RGB_to_CVS********
+ *
+ * Converts the int values in an RGB struct into component video color space 
+ * float values, and stores those values in a CVS struct.
+ * Inputs:
+ *              Pnm_rgb rgb_struct: an Pnm_rgb struct that stores the int 
+ *                                  values to be converted
+ *              unsigned denominator: the denominator of the image the pixel 
+ *                                    came from
+ *              CVS one_pixel: a CVS struct that stores the resulting float 
+ *                             values after they have been converted
+ * Return: returns the CVS struct that holds the float values
+ * Expects:
+ *      * rgb_struct to be nonnull
+ *      * one_pixel to be nonnull
+ * Notes:
+ *      * computes exactly the same values as onePixelToComponentVideo
+ *      * checked runtime error if:
+ *              * rgb_struct is NULL
+ *              * one_pixel is NULL
+ ************************/
+CVS RGB_to_CVS(Pnm_rgb rgb_struct, unsigned denominator, CVS one_pixel)
+{
+        assert(rgb_struct != NULL);
+        assert(one_pixel != NULL);
+
+        float r = (float)rgb_struct->red / (float)denominator;
+        float g = (float)rgb_struct->green / (float)denominator;
+        float b = (float)rgb_struct->blue / (float)denominator;
+
+        one_pixel->y = 0.299 * r + 0.587 * g + 0.114 * b;
+        one_pixel->pb = -0.168736 * r - 0.331264 * g + 0.5 * b;
+        one_pixel->pr = 0.5 * r - 0.418688 * g - 0.081312 * b;
+
+        return one_pixel;
+}
+
+/**********RGBtoComponentPlanes********
+ *
+ * Transforms each pixel of an image from RGB color space into 
+ * component video color space and stores the result in planes, with the pb
+ * and pr values averaged over each 2x2 block
+ * Inputs:
+ *              Rgbview view: the trimmed image that is to be converted into
+ *                            component video color space
+ * Return: a CVS_planes holding the y value of every pixel and the averaged 
+ *         pb and pr values of every 2x2 block
+ * Expects:
+ *      * view to be nonnull, with an even width and height
+ * Notes:
+ *      * the planes produce the same code words as the UArray2b of CVS structs
+ *      * does not free view. The caller assumes ownership of the returned 
+ *        CVS_planes
+ *      * checked runtime error if:
+ *              * view is NULL
+ ************************/
+CVS_planes RGBtoComponentPlanes(Rgbview view)
+{
+        assert(view != NULL);
+        CVS_planes planes = CVS_planes_new(view->width, view->height);
+
+        if (view->denominator <= MAX_8_BIT_DENOMINATOR) {
+                rows_to_planes(view, planes);
+        } else {
+                blocks_to_planes(view->image, planes);
+        }
+
+        return planes;
+}
+
+/**********rows_to_planes********
+ *
+ * Fills planes from an image with 8-bit samples, a pair of scanlines at a 
+ * time, using the scanline conversion in colorconvert.h
+ * Inputs:
+ *              Rgbview view: the image to be converted
+ *              CVS_planes planes: planes with the same width and height as
+ *                                 view
+ * Return: N/A
+ * Expects:
+ *      * view and planes to be nonnull
+ *      * the denominator of view to be at most 255
+ * Notes:
+ *      * the scanlines of a raster are converted where they are; those of a
+ *        Pnm_ppm are first copied into interleaved bytes
+ *      * on a CPU without a vector version in colorconvert.h, the lookup 
+ *        tables in rgbtables.h are used instead; both give the same values
+ ************************/
+static void rows_to_planes(Rgbview view, CVS_planes planes)
+{
+        struct Colorconvert_scale scale = 
+                                Colorconvert_scale_of(view->denominator);
+        Rgbtables tables = NULL;
+        if (!Colorconvert_vectorized()) {
+                tables = Rgbtables_new(view->denominator, false);
+        }
+
+        size_t row_bytes = (size_t)planes->width * 3;
+        unsigned char *buffer = Pool_alloc(row_bytes * 2);
+
+        for (int row = 0; row < planes->height; row += 2) {
+                const unsigned char *top = view_row(view, row, buffer);
+                const unsigned char *bottom = view_row(view, row + 1, 
+                                                       buffer + row_bytes);
+
+                size_t chroma_row = (size_t)(row / 2) * planes->chroma_width;
+                float *y_top = planes->y + (size_t)row * planes->width;
+                float *y_bottom = y_top + planes->width;
+
+                if (tables != NULL) {
+                        Rgbtables_rows_to_planes(tables, top, bottom, 
+                                                 planes->width, y_top, 
+                                                 y_bottom, 
+                                                 planes->pbavg + chroma_row,
+                                                 planes->pravg + chroma_row);
+                } else {
+                        Colorconvert_rows_to_planes(top, bottom, planes->width,
+                                                    scale, y_top, y_bottom,
+                                                    planes->pbavg + chroma_row,
+                                                    planes->pravg + chroma_row);
+                }
+        }
+
+        if (tables != NULL) {
+                Rgbtables_free(&tables);
+        }
+        Pool_free(buffer);
+}
+
+/**********view_row********
+ *
+ * Finds one scanline of an image as interleaved 8-bit RGB bytes
+ * Inputs:
+ *              Rgbview view: the image holding the scanline
+ *              int row: the index of the scanline
+ *              unsigned char *rgb_bytes: where the 3 * width bytes are 
+ *                                        gathered, if the image has no 
+ *                                        raster
+ * Return: the scanline in the raster, or rgb_bytes
+ * Expects:
+ *      * view and rgb_bytes to be nonnull
+ *      * every sample of the image to fit in a byte
+ ************************/
+static const unsigned char *view_row(Rgbview view, int row, 
+                                     unsigned char *rgb_bytes)
+{
+        if (view->raster != NULL) {
+                return Rgbview_row(view, row);
+        }
+        gather_row(view->image, row, rgb_bytes);
+        return rgb_bytes;
+}
+
+/**********gather_row********
+ *
+ * Copies one scanline of an image into interleaved 8-bit RGB bytes
+ * Inputs:
+ *              Pnm_ppm image: the image holding the scanline
+ *              int row: the index of the scanline
+ *              unsigned char *rgb_bytes: where the 3 * width bytes go
+ * Return: N/A
+ * Expects:
+ *      * image and rgb_bytes to be nonnull
+ *      * every sample of image to fit in a byte
+ ************************/
+static void gather_row(Pnm_ppm image, int row, unsigned char *rgb_bytes)
+{
+        for (unsigned col = 0; col < image->width; col++) {
+                Pnm_rgb pixel = image->methods->at(image->pixels, col, row);
+                rgb_bytes[col * 3] = pixel->red;
+                rgb_bytes[col * 3 + 1] = pixel->green;
+                rgb_bytes[col * 3 + 2] = pixel->blue;
+        }
+}
+
+/**********blocks_to_planes********
+ *
+ * Fills planes from an image one 2x2 block at a time, using the lookup 
+ * tables in rgbtables.h or RGB_to_CVS
+ * Inputs:
+ *              Pnm_ppm image: the image to be converted
+ *              CVS_planes planes: planes with the same width and height as
+ *                                 image
+ * Return: N/A
+ * Expects:
+ *      * image and planes to be nonnull
+ * Notes:
+ *      * works for any denominator, so it handles images with samples that
+ *        don't fit in a byte
+ *      * the tables are only built when the image has more pixels than the
+ *        denominator, since building them costs about as much as converting
+ *        that many pixels
+ *      * the averages are summed in the same order as compress_one_block, so
+ *        the planes produce the same code words as the UArray2b of CVS structs
+ ************************/
+static void blocks_to_planes(Pnm_ppm image, CVS_planes planes)
+{
+        A2Methods_T methods = image->methods;
+
+        /* building the tables only pays off with more pixels than entries */
+        Rgbtables tables = NULL;
+        if (image->denominator < (size_t)planes->width * planes->height) {
+                tables = Rgbtables_new(image->denominator, false);
+        }
+
+        for (int row = 0; row < planes->height; row += 2) {
+                float *y_top = planes->y + (size_t)row * planes->width;
+                float *y_bottom = y_top + planes->width;
+                float *pbavg = planes->pbavg + 
+                                        (size_t)(row / 2) * planes->chroma_width;
+                float *pravg = planes->pravg + 
+                                        (size_t)(row / 2) * planes->chroma_width;
+
+                for (int col = 0; col < planes->width; col += 2) {
+                        struct CVS pixels[4];
+                        /* top left, top right, bottom left, bottom right */
+                        for (int i = 0; i < 4; i++) {
+                                Pnm_rgb pixel = methods->at(image->pixels,
+                                                            col + i % 2, 
+                                                            row + i / 2);
+                                if (tables != NULL) {
+                                        Rgbtables_pixel(tables, pixel->red,
+                                                        pixel->green, 
+                                                        pixel->blue,
+                                                        &pixels[i].y,
+                                                        &pixels[i].pb,
+                                                        &pixels[i].pr);
+                                } else {
+                                        RGB_to_CVS(pixel, image->denominator,
+                                                   &pixels[i]);
+                                }
+                        }
+
+                        y_top[col] = pixels[0].y;
+                        y_top[col + 1] = pixels[1].y;
+                        y_bottom[col] = pixels[2].y;
+                        y_bottom[col + 1] = pixels[3].y;
+
+                        pbavg[col / 2] = (pixels[0].pb + pixels[1].pb + 
+                                          pixels[2].pb + pixels[3].pb) / 4.0;
+                        pravg[col / 2] = (pixels[0].pr + pixels[1].pr + 
+                                          pixels[2].pr + pixels[3].pr) / 4.0;
+                }
+        }
+
+        if (tables != NULL) {
+                Rgbtables_free(&tables);
+        }
+}
+
+/**********ComponentPlanestoP6********
+ *
+ * Transforms every pixel held in planes from component video color space to 
+ * RGB color space, straight into the rows of a P6 writer
+ * Inputs:
+ *              CVS_planes planes: the y plane and the averaged pb and pr 
+ *                                 planes of an image
+ *              Ppmwriter writer: a writer for an image the size of planes,
+ *                                with no rows written yet
+ * Return: N/A
+ * Expects:
+ *      * planes and writer to be nonnull
+ * Notes:
+ *      * each scanline is converted by colorconvert.h, which gives the same
+ *        samples as CVS_to_RGB, and every pixel in a 2x2 block uses the pb
+ *        and pr values of its block
+ *      * frees up the memory used for the inputted planes
+ *      * checked runtime error if planes or writer is NULL
+ ************************/
+void ComponentPlanestoP6(CVS_planes planes, Ppmwriter writer)
+{
+        assert(planes != NULL && writer != NULL);
+
+        for (int row = 0; row < planes->height; row++) {
+                size_t chroma_row = (size_t)(row / 2) * planes->chroma_width;
+                Colorconvert_planes_to_row(planes->y + 
+                                                (size_t)row * planes->width,
+                                           planes->pbavg + chroma_row,
+                                           planes->pravg + chroma_row,
+                                           planes->width, 
+                                           Ppmwriter_rows(writer, 1));
+        }
+
+        CVS_planes_free(&planes);
+}
+
+/**********RGBtoFixedPlanes********
+ *
+ * Transforms each pixel of a ppm image from RGB color space into 
+ * fixed-point component video color space, with pb and pr averaged over each
+ * 2x2 block, using integer arithmetic only
+ * Inputs:
+ *              Rgbview view: the trimmed image that is to be converted
+ * Return: a CVS_planes16 holding the y value of every pixel and the averaged
+ *         pb and pr values of every 2x2 block, with CVS_FIXED_SHIFT 
+ *         fractional bits
+ * Expects:
+ *      * view to be nonnull, with an even width and height
+ * Notes:
+ *      * does not free view, so the float pipeline can still run on it. The
+ *        caller assumes ownership of the returned CVS_planes16
+ *      * works for any denominator
+ *      * checked runtime error if:
+ *              * view is NULL
+ ************************/
+CVS_planes16 RGBtoFixedPlanes(Rgbview view)
+{
+        assert(view != NULL);
+        CVS_planes16 planes = CVS_planes16_new(view->width, view->height);
+        Rgbtables tables = Rgbtables_new(view->denominator, true);
+
+        size_t row_samples = (size_t)planes->width * 3;
+        unsigned *top = Pool_alloc(row_samples * 2 * sizeof(unsigned));
+        unsigned *bottom = top + row_samples;
+
+        for (int row = 0; row < planes->height; row += 2) {
+                gather_samples(view, row, top);
+                gather_samples(view, row + 1, bottom);
+
+                size_t chroma_row = (size_t)(row / 2) * planes->chroma_width;
+                int16_t *y_top = planes->y + (size_t)row * planes->width;
+
+                Rgbtables_rows_to_planes16(tables, top, bottom, planes->width,
+                                           y_top, y_top + planes->width,
+                                           planes->pbavg + chroma_row,
+                                           planes->pravg + chroma_row);
+        }
+
+        Pool_free(top);
+        Rgbtables_free(&tables);
+        return planes;
+}
+
+/**********gather_samples********
+ *
+ * Copies one scanline of an image into interleaved RGB samples
+ * Inputs:
+ *              Rgbview view: the image holding the scanline
+ *              int row: the index of the scanline
+ *              unsigned *samples: where the 3 * width samples go
+ * Return: N/A
+ * Expects:
+ *      * view and samples to be nonnull
+ ************************/
+static void gather_samples(Rgbview view, int row, unsigned *samples)
+{
+        if (view->raster != NULL) {
+                const unsigned char *rgb_bytes = Rgbview_row(view, row);
+                for (size_t i = 0; i < (size_t)view->width * 3; i++) {
+                        samples[i] = rgb_bytes[i];
+                }
+                return;
+        }
+
+        Pnm_ppm image = view->image;
+        for (unsigned col = 0; col < image->width; col++) {
+                Pnm_rgb pixel = image->methods->at(image->pixels, col, row);
+                samples[col * 3] = pixel->red;
+                samples[col * 3 + 1] = pixel->green;
+                samples[col * 3 + 2] = pixel->blue;
+        }
+}
+
+/**********RGBtoYcocgWords********
+ *
+ * Compresses an image straight into a buffer of 32-bit words with the
+ * YCoCg-R transform
+ * Inputs:
+ *              Rgbview view: the trimmed image that is to be compressed
+ * Return: A Codewords buffer with each 2x2 block corresponding to one 32 bit 
+ *         word
+ * Expects:
+ *      * view to be nonnull, with an even width and height
+ * Notes:
+ *      * samples with a denominator other than 255 are first scaled to 
+ *        0..255 through a table with one entry per sample value
+ *      * does not free view. The caller assumes ownership of the returned
+ *        Codewords
+ *      * checked runtime error if:
+ *              * view is NULL
+ ************************/
+Codewords RGBtoYcocgWords(Rgbview view)
+{
+        assert(view != NULL);
+        unsigned denominator = view->denominator;
+        Codewords compressed_blocks = Codewords_new(view->width / 2,
+                                                    view->height / 2);
+
+        unsigned char *scale = NULL;
+        if (denominator != DENOMINATOR) {
+                scale = Pool_alloc((size_t)denominator + 1);
+                for (unsigned sample = 0; sample <= denominator; sample++) {
+                        scale[sample] = (sample * DENOMINATOR + 
+                                         denominator / 2) / denominator;
+                }
+        }
+
+        size_t row_bytes = (size_t)view->width * 3;
+        unsigned char *buffer = Pool_alloc(row_bytes * 2);
+
+        for (int row = 0; row < compressed_blocks->height; row++) {
+                const unsigned char *top = buffer;
+                const unsigned char *bottom = buffer + row_bytes;
+                if (scale == NULL) {
+                        top = view_row(view, row * 2, buffer);
+                        bottom = view_row(view, row * 2 + 1, 
+                                          buffer + row_bytes);
+                } else {
+                        gather_scaled_row(view, row * 2, scale, buffer);
+                        gather_scaled_row(view, row * 2 + 1, scale, 
+                                          buffer + row_bytes);
+                }
+                Ycocg_rows_to_words(top, bottom, compressed_blocks->width,
+                                    Codewords_row(compressed_blocks, row));
+        }
+
+        Pool_free(buffer);
+        if (scale != NULL) {
+                Pool_free(scale);
+        }
+        return compressed_blocks;
+}
+
+/**********gather_scaled_row********
+ *
+ * Copies one scanline of an image into interleaved 8-bit RGB bytes, scaling
+ * every sample through a table
+ * Inputs:
+ *              Rgbview view: the image holding the scanline
+ *              int row: the index of the scanline
+ *              const unsigned char *scale: the byte of each sample value,
+ *                                          from 0 to the denominator
+ *              unsigned char *rgb_bytes: where the 3 * width bytes go
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * every sample of the image to be at most its denominator
+ ************************/
+static void gather_scaled_row(Rgbview view, int row, 
+                              const unsigned char *scale, 
+                              unsigned char *rgb_bytes)
+{
+        if (view->raster != NULL) {
+                const unsigned char *samples = Rgbview_row(view, row);
+                for (size_t i = 0; i < (size_t)view->width * 3; i++) {
+                        rgb_bytes[i] = scale[samples[i]];
+                }
+                return;
+        }
+
+        Pnm_ppm image = view->image;
+        for (unsigned col = 0; col < image->width; col++) {
+                Pnm_rgb pixel = image->methods->at(image->pixels, col, row);
+                rgb_bytes[col * 3] = scale[pixel->red];
+                rgb_bytes[col * 3 + 1] = scale[pixel->green];
+                rgb_bytes[col * 3 + 2] = scale[pixel->blue];
+        }
+}
+
+/**********TableViewtoP6********
+ *
+ * Decodes the code words of a compressed file in memory with the
+ * table-driven decoder, straight into the rows of a P6 writer
+ * Inputs:
+ *              Wordview view: the code words of the image
+ *              const struct Decodetables *tables: the tables to decode with
+ *              Ppmwriter writer: a writer for an image 2 * width by 
+ *                                2 * height, with no rows written yet
+ * Return: N/A
+ * Expects:
+ *      * all arguments to be nonnull
+ * Notes:
+ *      * each row of code words is put in native order in a buffer of one
+ *        row, which stays in cache, so the code words of the whole image
+ *        are never copied. Rows already in native order are decoded where
+ *        they are in the file
+ *      * checked runtime error if any argument is NULL
+ ************************/
+void TableViewtoP6(Wordview view, const struct Decodetables *tables,
+                   Ppmwriter writer)
+{
+        assert(view != NULL && tables != NULL && writer != NULL);
+        size_t row_bytes = (size_t)view->width * 2 * 3;
+        uint32_t *words = Pool_alloc((view->width > 0 ? view->width : 1) *
+                                     sizeof(uint32_t));
+
+        for (int row = 0; row < view->height; row++) {
+                unsigned char *top = Ppmwriter_rows(writer, 2);
+                const uint32_t *row_words = Wordview_row(view, row, words);
+                Decodetables_words_to_rows(tables, row_words, view->width,
+                                           top, top + row_bytes);
+        }
+
+        Pool_free(words);
+}
+
+/**********TableViewtoRows********
+ *
+ * Decodes some rows of code words of a compressed file in memory with the
+ * table-driven decoder, straight into their place in a raster
+ * Inputs:
+ *              Wordview view: the code words of the image
+ *              const struct Decodetables *tables: the tables to decode with
+ *              int first: the first row of code words to decode
+ *              int last: one past the last row of code words to decode
+ *              unsigned char *raster: the first byte of the image's 8-bit
+ *                                     RGB raster, 2 * height rows of
+ *                                     2 * width pixels
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * 0 <= first <= last <= the height of the view
+ * Notes:
+ *      * only the scanlines of the given rows are written, so the rows of
+ *        one image can be decoded by several threads at once
+ *      * checked runtime error if a pointer is NULL or the rows are out of
+ *        range
+ ************************/
+void TableViewtoRows(Wordview view, const struct Decodetables *tables,
+                     int first, int last, unsigned char *raster)
+{
+        assert(view != NULL && tables != NULL && raster != NULL);
+        assert(0 <= first && first <= last && last <= view->height);
+        size_t row_bytes = (size_t)view->width * 2 * 3;
+        uint32_t *words = Pool_alloc((view->width > 0 ? view->width : 1) *
+                                     sizeof(uint32_t));
+
+        for (int row = first; row < last; row++) {
+                unsigned char *top = raster + (size_t)row * 2 * row_bytes;
+                const uint32_t *row_words = Wordview_row(view, row, words);
+                Decodetables_words_to_rows(tables, row_words, view->width,
+                                           top, top + row_bytes);
+        }
+
+        Pool_free(words);
+}
@@ -45,12 +45,22 @@ Pnm_ppm ComponentVideotoRGB(UArray2b_T componentVideo);
 void onePixelToRGB(int col, int row, UArray2b_T componentVideo, void *elem, 
                                                              void *rgb_pixmap);
 Pnm_rgb CVS_to_RGB(CVS one_pixel, Pnm_rgb rgb_struct);
+CVS RGB_to_CVS(Pnm_rgb rgb_struct, unsigned denominator, CVS one_pixel);
+
+/* conversion between RGB color space and planar component video */
+CVS_planes RGBtoComponentPlanes(Rgbview view);
+void ComponentPlanestoP6(CVS_planes planes, Ppmwriter writer);
+
+/* the start of the integer-only pipeline */
+CVS_planes16 RGBtoFixedPlanes(Rgbview view);
+
+/* the YCoCg-R encoder, straight from RGB to code words */
+Codewords RGBtoYcocgWords(Rgbview view);
+
+/* the table-driven decoder */
+void TableViewtoP6(Wordview view, const struct Decodetables *tables,
+                   Ppmwriter writer);
+void TableViewtoRows(Wordview view, const struct Decodetables *tables,
+                     int first, int last, unsigned char *raster);
 
-/* 
- * trimming the image (neccesary for coversion to Component Video color 
- * space) 
- */
-Pnm_ppm trimmed_image(Pnm_ppm original_image);
-void og_to_new(int col, int row, A2Methods_UArray2 A2uarray2, 
-                                         void *elem, void *original_image);
 #endif
\ No newline at end of file
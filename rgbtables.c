@@ -0,0 +1,413 @@
+/********************************************************************
+ *
+ *                          rgbtables.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for rgbtables.h
+ *
+ *     Summary:
+ *      rgbtables converts RGB samples to component video color space (CVS)
+ *      with lookup tables. For one denominator it stores, for every sample
+ *      value, what that sample adds to y, pb and pr for each channel, so a
+ *      pixel becomes 9 lookups and 6 adds with no divides or multiplies.
+ *      The tables hold either doubles, which give exactly the same floats as
+ *      RGB_to_CVS, or fixed-point ints for the CVS_planes16 planes.
+ *
+ *     Notes:
+ *   - Each double entry is the product RGB_to_CVS computes for that sample,
+ *     with the scaled sample rounded to float first. The negative terms are
+ *     stored negated, and a - x is the same as a + (-x), so adding the
+ *     entries in channel order gives the same double, and the same float, as
+ *     the expressions there
+ *   - The fixed-point entries are rounded to CVS_FIXED_SHIFT +
+ *     RGBTABLES_EXTRA_BITS fractional bits, and a sum is rounded (half away
+ *     from zero, like CVS_planes_to_fixed) down to CVS_FIXED_SHIFT bits only
+ *     once, so a result is off by at most one unit from converting the float
+ *     result
+ *   - The tables always cover every sample from 0 to 255, so rows of bytes
+ *     never need a bounds check, even when a sample is above the denominator
+ *   - This module uses functions from cvsplanes.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "assert.h"
+#include "cvsplanes.h"
+#include "rgbtables.h"
+
+#define MAX_8_BIT_SAMPLE 255
+#define FIXED_SHIFT (CVS_FIXED_SHIFT + RGBTABLES_EXTRA_BITS)
+#define FIXED_MIN -32768
+#define FIXED_MAX 32767
+
+static void build_entries(struct Rgbtables_entry *entries, unsigned count,
+                          unsigned denominator, double y_coefficient,
+                          double pb_coefficient, double pr_coefficient);
+static void build_fixed_entries(struct Rgbtables_fixed_entry *entries,
+                                unsigned count, unsigned denominator,
+                                double y_coefficient, double pb_coefficient,
+                                double pr_coefficient);
+static int16_t fixed_value(int64_t sum, int shift);
+
+/**********Rgbtables_new********
+ *
+ * Builds the lookup tables for images with the given denominator
+ * Inputs:
+ *              unsigned denominator: the denominator of the image
+ *              bool fixed: true for fixed-point tables, false for double
+ *                          tables
+ * Return: a new Rgbtables
+ * Expects:
+ *      * denominator to be nonzero
+ * Notes:
+ *      * the tables have an entry for every sample up to the larger of
+ *        denominator and 255
+ *      * the caller must free the tables with Rgbtables_free
+ *      * checked runtime error if:
+ *              * denominator is 0
+ *              * the memory can't be allocated
+ ************************/
+Rgbtables Rgbtables_new(unsigned denominator, bool fixed)
+{
+        assert(denominator > 0);
+
+        Rgbtables tables = malloc(sizeof(struct Rgbtables));
+        assert(tables != NULL);
+
+        tables->denominator = denominator;
+        tables->max_sample = denominator > MAX_8_BIT_SAMPLE ? denominator
+                                                          : MAX_8_BIT_SAMPLE;
+        tables->fixed = fixed;
+        tables->red = tables->green = tables->blue = NULL;
+        tables->fixed_red = tables->fixed_green = tables->fixed_blue = NULL;
+
+        unsigned count = tables->max_sample + 1;
+        if (fixed) {
+                struct Rgbtables_fixed_entry *entries =
+                        malloc(3 * (size_t)count * sizeof(*entries));
+                assert(entries != NULL);
+                tables->fixed_red = entries;
+                tables->fixed_green = entries + count;
+                tables->fixed_blue = entries + 2 * (size_t)count;
+
+                build_fixed_entries(tables->fixed_red, count, denominator,
+                                    0.299, -0.168736, 0.5);
+                build_fixed_entries(tables->fixed_green, count, denominator,
+                                    0.587, -0.331264, -0.418688);
+                build_fixed_entries(tables->fixed_blue, count, denominator,
+                                    0.114, 0.5, -0.081312);
+        } else {
+                struct Rgbtables_entry *entries =
+                        malloc(3 * (size_t)count * sizeof(*entries));
+                assert(entries != NULL);
+                tables->red = entries;
+                tables->green = entries + count;
+                tables->blue = entries + 2 * (size_t)count;
+
+                build_entries(tables->red, count, denominator,
+                              0.299, -0.168736, 0.5);
+                build_entries(tables->green, count, denominator,
+                              0.587, -0.331264, -0.418688);
+                build_entries(tables->blue, count, denominator,
+                              0.114, 0.5, -0.081312);
+        }
+
+        return tables;
+}
+
+/**********Rgbtables_free********
+ *
+ * Deallocates an Rgbtables and its tables
+ * Inputs:
+ *              Rgbtables *tables: pointer to the Rgbtables to be freed
+ * Return: N/A
+ * Expects:
+ *      * tables and *tables to be nonnull
+ * Notes:
+ *      * sets *tables to NULL
+ *      * checked runtime error if tables or *tables is NULL
+ ************************/
+void Rgbtables_free(Rgbtables *tables)
+{
+        assert(tables != NULL && *tables != NULL);
+
+        /* the three channels of a kind share one allocation */
+        free((*tables)->red);
+        free((*tables)->fixed_red);
+        free(*tables);
+        *tables = NULL;
+}
+
+/**********build_entries********
+ *
+ * Fills the double table of one channel
+ * Inputs:
+ *              struct Rgbtables_entry *entries: the count entries to fill
+ *              unsigned count: the number of entries
+ *              unsigned denominator: the denominator of the image
+ *              double y_coefficient, pb_coefficient, pr_coefficient: the
+ *                      channel's column of the color matrix
+ * Return: N/A
+ * Expects:
+ *      * entries to be nonnull
+ * Notes:
+ *      * the sample is scaled in float, like RGB_to_CVS
+ ************************/
+static void build_entries(struct Rgbtables_entry *entries, unsigned count,
+                          unsigned denominator, double y_coefficient,
+                          double pb_coefficient, double pr_coefficient)
+{
+        for (unsigned sample = 0; sample < count; sample++) {
+                float scaled = (float)sample / (float)denominator;
+
+                entries[sample].y = y_coefficient * scaled;
+                entries[sample].pb = pb_coefficient * scaled;
+                entries[sample].pr = pr_coefficient * scaled;
+        }
+}
+
+/**********build_fixed_entries********
+ *
+ * Fills the fixed-point table of one channel
+ * Inputs:
+ *              struct Rgbtables_fixed_entry *entries: the count entries to
+ *                                                     fill
+ *              unsigned count: the number of entries
+ *              unsigned denominator: the denominator of the image
+ *              double y_coefficient, pb_coefficient, pr_coefficient: the
+ *                      channel's column of the color matrix
+ * Return: N/A
+ * Expects:
+ *      * entries to be nonnull
+ ************************/
+static void build_fixed_entries(struct Rgbtables_fixed_entry *entries,
+                                unsigned count, unsigned denominator,
+                                double y_coefficient, double pb_coefficient,
+                                double pr_coefficient)
+{
+        double one = (double)(1 << FIXED_SHIFT);
+
+        for (unsigned sample = 0; sample < count; sample++) {
+                double scaled = (double)sample / denominator * one;
+
+                entries[sample].y = lround(y_coefficient * scaled);
+                entries[sample].pb = lround(pb_coefficient * scaled);
+                entries[sample].pr = lround(pr_coefficient * scaled);
+        }
+}
+
+/**********Rgbtables_pixel********
+ *
+ * Converts one RGB pixel to component video color space
+ * Inputs:
+ *              Rgbtables tables: double tables for the pixel's denominator
+ *              unsigned red, green, blue: the samples of the pixel
+ *              float *y, *pb, *pr: where the results are written
+ * Return: N/A
+ * Expects:
+ *      * tables and all pointers to be nonnull
+ *      * tables to hold doubles
+ *      * every sample to be at most tables->max_sample
+ * Notes:
+ *      * gives the same values as RGB_to_CVS
+ *      * checked runtime error if:
+ *              * tables or any pointer is NULL
+ *              * tables holds fixed-point ints
+ *              * a sample is above tables->max_sample
+ ************************/
+void Rgbtables_pixel(Rgbtables tables, unsigned red, unsigned green,
+                     unsigned blue, float *y, float *pb, float *pr)
+{
+        assert(tables != NULL && !tables->fixed);
+        assert(y != NULL && pb != NULL && pr != NULL);
+        assert(red <= tables->max_sample && green <= tables->max_sample &&
+               blue <= tables->max_sample);
+
+        const struct Rgbtables_entry *r = &tables->red[red];
+        const struct Rgbtables_entry *g = &tables->green[green];
+        const struct Rgbtables_entry *b = &tables->blue[blue];
+
+        *y = r->y + g->y + b->y;
+        *pb = r->pb + g->pb + b->pb;
+        *pr = r->pr + g->pr + b->pr;
+}
+
+/**********Rgbtables_rows_to_planes********
+ *
+ * Table version of Colorconvert_rows_to_planes: converts two scanlines of
+ * interleaved 8-bit RGB into their y values and the averaged pb and pr
+ * values of the 2x2 blocks they make up
+ * Inputs:
+ *              Rgbtables tables: double tables for the image's denominator
+ *              const unsigned char *top: width pixels of the top scanline,
+ *                                        3 bytes (red, green, blue) each
+ *              const unsigned char *bottom: width pixels of the scanline below
+ *              int width: the number of pixels in each scanline
+ *              float *y_top: where the width y values of top are written
+ *              float *y_bottom: where the width y values of bottom are written
+ *              float *pbavg: where the width / 2 averaged pb values go
+ *              float *pravg: where the width / 2 averaged pr values go
+ * Return: N/A
+ * Expects:
+ *      * tables and all pointers to be nonnull
+ *      * tables to hold doubles
+ *      * width to be even and nonnegative
+ * Notes:
+ *      * gives the same values as RGB_to_CVS followed by the averaging in
+ *        RGBtoComponentPlanes
+ *      * checked runtime error if:
+ *              * tables or any pointer is NULL
+ *              * tables holds fixed-point ints
+ *              * width is negative or odd
+ ************************/
+void Rgbtables_rows_to_planes(Rgbtables tables, const unsigned char *top,
+                              const unsigned char *bottom, int width,
+                              float *y_top, float *y_bottom,
+                              float *pbavg, float *pravg)
+{
+        assert(tables != NULL && !tables->fixed);
+        assert(top != NULL && bottom != NULL);
+        assert(y_top != NULL && y_bottom != NULL);
+        assert(pbavg != NULL && pravg != NULL);
+        assert(width >= 0 && width % 2 == 0);
+
+        for (int col = 0; col < width; col += 2) {
+                const unsigned char *pixels[4] = { top + col * 3,
+                                                   top + col * 3 + 3,
+                                                   bottom + col * 3,
+                                                   bottom + col * 3 + 3 };
+                float y[4], pb[4], pr[4];
+
+                /* top left, top right, bottom left, bottom right */
+                for (int i = 0; i < 4; i++) {
+                        const struct Rgbtables_entry *r =
+                                                &tables->red[pixels[i][0]];
+                        const struct Rgbtables_entry *g =
+                                                &tables->green[pixels[i][1]];
+                        const struct Rgbtables_entry *b =
+                                                &tables->blue[pixels[i][2]];
+
+                        y[i] = r->y + g->y + b->y;
+                        pb[i] = r->pb + g->pb + b->pb;
+                        pr[i] = r->pr + g->pr + b->pr;
+                }
+
+                y_top[col] = y[0];
+                y_top[col + 1] = y[1];
+                y_bottom[col] = y[2];
+                y_bottom[col + 1] = y[3];
+                pbavg[col / 2] = (pb[0] + pb[1] + pb[2] + pb[3]) / 4.0;
+                pravg[col / 2] = (pr[0] + pr[1] + pr[2] + pr[3]) / 4.0;
+        }
+}
+
+/**********Rgbtables_rows_to_planes16********
+ *
+ * Fixed-point version of Rgbtables_rows_to_planes, for CVS_planes16 planes
+ * Inputs:
+ *              Rgbtables tables: fixed-point tables for the image's
+ *                                denominator
+ *              const unsigned *top: width pixels of the top scanline, 3
+ *                                   samples (red, green, blue) each
+ *              const unsigned *bottom: width pixels of the scanline below
+ *              int width: the number of pixels in each scanline
+ *              int16_t *y_top, *y_bottom, *pbavg, *pravg: where the results
+ *                      are written, with CVS_FIXED_SHIFT fractional bits
+ * Return: N/A
+ * Expects:
+ *      * tables and all pointers to be nonnull
+ *      * tables to hold fixed-point ints
+ *      * width to be even and nonnegative
+ *      * every sample to be at most tables->max_sample
+ * Notes:
+ *      * takes whole samples rather than bytes, so it works for any 
+ *        denominator
+ *      * each value is rounded once, half away from zero, and saturated to
+ *        the range of an int16_t
+ *      * checked runtime error if:
+ *              * tables or any pointer is NULL
+ *              * tables holds doubles
+ *              * width is negative or odd
+ *              * a sample is above tables->max_sample
+ ************************/
+void Rgbtables_rows_to_planes16(Rgbtables tables, const unsigned *top,
+                                const unsigned *bottom, int width,
+                                int16_t *y_top, int16_t *y_bottom,
+                                int16_t *pbavg, int16_t *pravg)
+{
+        assert(tables != NULL && tables->fixed);
+        assert(top != NULL && bottom != NULL);
+        assert(y_top != NULL && y_bottom != NULL);
+        assert(pbavg != NULL && pravg != NULL);
+        assert(width >= 0 && width % 2 == 0);
+
+        for (int col = 0; col < width; col += 2) {
+                const unsigned *pixels[4] = { top + col * 3, 
+                                              top + col * 3 + 3,
+                                              bottom + col * 3,
+                                              bottom + col * 3 + 3 };
+                int64_t y[4];
+                int64_t pb_sum = 0;
+                int64_t pr_sum = 0;
+
+                /* top left, top right, bottom left, bottom right */
+                for (int i = 0; i < 4; i++) {
+                        assert(pixels[i][0] <= tables->max_sample &&
+                               pixels[i][1] <= tables->max_sample &&
+                               pixels[i][2] <= tables->max_sample);
+                        const struct Rgbtables_fixed_entry *r =
+                                        &tables->fixed_red[pixels[i][0]];
+                        const struct Rgbtables_fixed_entry *g =
+                                        &tables->fixed_green[pixels[i][1]];
+                        const struct Rgbtables_fixed_entry *b =
+                                        &tables->fixed_blue[pixels[i][2]];
+
+                        y[i] = (int64_t)r->y + g->y + b->y;
+                        pb_sum += (int64_t)r->pb + g->pb + b->pb;
+                        pr_sum += (int64_t)r->pr + g->pr + b->pr;
+                }
+
+                y_top[col] = fixed_value(y[0], RGBTABLES_EXTRA_BITS);
+                y_top[col + 1] = fixed_value(y[1], RGBTABLES_EXTRA_BITS);
+                y_bottom[col] = fixed_value(y[2], RGBTABLES_EXTRA_BITS);
+                y_bottom[col + 1] = fixed_value(y[3], RGBTABLES_EXTRA_BITS);
+
+                /* the average divides by 4, which is 2 more bits of shift */
+                pbavg[col / 2] = fixed_value(pb_sum, RGBTABLES_EXTRA_BITS + 2);
+                pravg[col / 2] = fixed_value(pr_sum, RGBTABLES_EXTRA_BITS + 2);
+        }
+}
+
+/**********fixed_value********
+ *
+ * Drops the extra fractional bits of a fixed-point sum
+ * Inputs:
+ *              int64_t sum: the sum to be shifted
+ *              int shift: the number of fractional bits to drop
+ * Return: sum / (1 << shift), rounded half away from zero and clamped to the
+ *         range of an int16_t
+ * Expects:
+ *      * shift to be positive
+ ************************/
+static int16_t fixed_value(int64_t sum, int shift)
+{
+        int64_t half = (int64_t)1 << (shift - 1);
+        int64_t value;
+
+        if (sum >= 0) {
+                value = (sum + half) >> shift;
+        } else {
+                value = -((-sum + half) >> shift);
+        }
+
+        if (value < FIXED_MIN) {
+                return FIXED_MIN;
+        } else if (value > FIXED_MAX) {
+                return FIXED_MAX;
+        }
+        return (int16_t)value;
+}
@@ -0,0 +1,105 @@
+/********************************************************************
+ *
+ *                          rgbtables.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for rgbtables.c
+ *
+ *     Summary:
+ *      rgbtables converts RGB samples to component video color space (CVS)
+ *      with lookup tables. For one denominator it stores, for every sample
+ *      value, what that sample adds to y, pb and pr for each channel, so a
+ *      pixel becomes 9 lookups and 6 adds with no divides or multiplies.
+ *      The tables hold either doubles, which give exactly the same floats as
+ *      RGB_to_CVS, or fixed-point ints for the CVS_planes16 planes.
+ *
+ *******************************************************************/
+#ifndef RGBTABLES_INCLUDED
+#define RGBTABLES_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * number of fractional bits kept by the fixed-point tables beyond
+ * CVS_FIXED_SHIFT, so sums of several entries are only rounded once
+ */
+#define RGBTABLES_EXTRA_BITS 8
+
+typedef struct Rgbtables *Rgbtables;
+
+/*
+ * This is the struct definition of the Rgbtables_entry instance, which holds
+ * what one sample of one channel adds to the y, pb and pr of its pixel
+ * Elements:
+ *      double y: the sample's term of y
+ *      double pb: the sample's term of pb
+ *      double pr: the sample's term of pr
+ *
+ */
+struct Rgbtables_entry {
+        double y;
+        double pb;
+        double pr;
+};
+
+/*
+ * This is the struct definition of the Rgbtables_fixed_entry instance. It is
+ * the same as Rgbtables_entry, with every term stored as a fixed-point int
+ * with CVS_FIXED_SHIFT + RGBTABLES_EXTRA_BITS fractional bits.
+ * Elements:
+ *      int32_t y, pb, pr: the sample's terms of y, pb and pr
+ *
+ */
+struct Rgbtables_fixed_entry {
+        int32_t y;
+        int32_t pb;
+        int32_t pr;
+};
+
+/*
+ * This is the struct definition of the Rgbtables instance
+ * Elements:
+ *      unsigned denominator: the denominator the tables were built for
+ *      unsigned max_sample: the largest sample the tables have an entry for
+ *      bool fixed: true if the fixed-point tables were built instead of the
+ *                  double ones
+ *      struct Rgbtables_entry *red, *green, *blue: max_sample + 1 entries
+ *                                                  for each channel, or NULL
+ *                                                  if fixed is true
+ *      struct Rgbtables_fixed_entry *fixed_red, *fixed_green, *fixed_blue:
+ *              max_sample + 1 entries for each channel, or NULL if fixed is
+ *              false
+ *
+ */
+struct Rgbtables {
+        unsigned denominator;
+        unsigned max_sample;
+        bool fixed;
+        struct Rgbtables_entry *red;
+        struct Rgbtables_entry *green;
+        struct Rgbtables_entry *blue;
+        struct Rgbtables_fixed_entry *fixed_red;
+        struct Rgbtables_fixed_entry *fixed_green;
+        struct Rgbtables_fixed_entry *fixed_blue;
+};
+
+Rgbtables Rgbtables_new(unsigned denominator, bool fixed);
+void Rgbtables_free(Rgbtables *tables);
+
+void Rgbtables_pixel(Rgbtables tables, unsigned red, unsigned green,
+                     unsigned blue, float *y, float *pb, float *pr);
+
+void Rgbtables_rows_to_planes(Rgbtables tables, const unsigned char *top,
+                              const unsigned char *bottom, int width,
+                              float *y_top, float *y_bottom,
+                              float *pbavg, float *pravg);
+void Rgbtables_rows_to_planes16(Rgbtables tables, const unsigned *top,
+                                const unsigned *bottom, int width,
+                                int16_t *y_top, int16_t *y_bottom,
+                                int16_t *pbavg, int16_t *pravg);
+
+#endif
@@ -0,0 +1,363 @@
+/********************************************************************
+ *
+ *                          rgbview.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for rgbview.h
+ *
+ *     Summary:
+ *      rgbview parses P6 images with samples of one byte in place, parses
+ *      P3 images with samples of one byte into a raster of bytes, and hands
+ *      every other image to Pnm_ppmread.
+ *
+ *     Notes:
+ *   - The input is put in memory by inputmap.h: mapped if it is a regular
+ *     file and read into one buffer if it is a pipe. A P6 image then costs
+ *     no copy at all, instead of a call of methods->at for every pixel
+ *   - A P3 raster is parsed by plainppm.h, with vector kernels, into a
+ *     block from pool.h, and the text is freed as soon as it is parsed
+ *   - Anything the parsers don't take (two-byte samples, a header they
+ *     can't read, a raster that is too short or has samples over the
+ *     denominator, comments in a P3 raster) goes to Pnm_ppmread through a
+ *     stream over the same memory, so bad images fail just as they did
+ *     before
+ *   - Trimming only changes the width and height, and no pixels are
+ *     copied, so the stride stays that of the whole image
+ *   - This module uses functions from inputmap.h, plainppm.h, pool.h and
+ *     pnm.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include "assert.h"
+#include "pnm.h"
+#include "a2methods.h"
+#include "inputmap.h"
+#include "plainppm.h"
+#include "pool.h"
+#include "rgbview.h"
+
+#define MAX_8_BIT_DENOMINATOR 255
+
+static bool parsed_raster(Inputmap map, Rgbview view);
+static bool parsed_text(Inputmap map, Rgbview view);
+static const unsigned char *parsed_header(Inputmap map, char magic,
+                                          Rgbview view, size_t *count);
+static bool header_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number);
+static bool samples_fit(const unsigned char *raster, size_t count,
+                        unsigned denominator);
+
+/**********Rgbview_map********
+ *
+ * Reads a ppm image to be encoded from bytes already in memory
+ * Inputs:
+ *              Inputmap input: the bytes of the image
+ *              A2Methods_T methods: the methods for the pixmap, if the image
+ *                                   has to be read by Pnm_ppmread
+ * Return: a view of the image
+ * Expects:
+ *      * input and methods to be nonnull
+ * Notes:
+ *      * takes ownership of input, which is freed with the view or before
+ *        it is returned
+ *      * the caller assumes ownership of the returned view, and frees it
+ *        with Rgbview_free
+ *      * checked runtime error if input or methods is NULL, and
+ *        Pnm_Badformat is raised if the image isn't a ppm image
+ ************************/
+Rgbview Rgbview_map(Inputmap input, A2Methods_T methods)
+{
+        assert(input != NULL && methods != NULL);
+        Rgbview view = malloc(sizeof(*view));
+        assert(view != NULL);
+        Inputmap map = input;
+
+        view->image = NULL;
+        view->samples = NULL;
+        if (parsed_raster(map, view)) {
+                view->input = map;
+                return view;
+        }
+        if (parsed_text(map, view)) {
+                Inputmap_free(&map);
+                view->input = NULL;
+                return view;
+        }
+
+        FILE *stream = Inputmap_stream(map);
+        Pnm_ppm image = Pnm_ppmread(stream, methods);
+        fclose(stream);
+        Inputmap_free(&map);
+
+        view->width = image->width;
+        view->height = image->height;
+        view->denominator = image->denominator;
+        view->raster = NULL;
+        view->stride = 0;
+        view->image = image;
+        view->input = NULL;
+        return view;
+}
+
+/**********Rgbview_trim********
+ *
+ * Trims the last column and/or row of an image, so its width and height
+ * are even
+ * Inputs:
+ *              Rgbview view: the view to be trimmed
+ * Return: N/A
+ * Expects:
+ *      * view to be nonnull
+ * Notes:
+ *      * nothing is copied: the trimmed row and column stay in memory and
+ *        are never read
+ *      * checked runtime error if view is NULL
+ ************************/
+void Rgbview_trim(Rgbview view)
+{
+        assert(view != NULL);
+
+        view->width -= view->width % 2;
+        view->height -= view->height % 2;
+        if (view->image != NULL) {
+                view->image->width = view->width;
+                view->image->height = view->height;
+        }
+}
+
+/**********Rgbview_row********
+ *
+ * Returns one row of the raster of a view
+ * Inputs:
+ *              Rgbview view: the view
+ *              int row: the index of the row
+ * Return: a pointer to the 3 * width interleaved RGB bytes of the row
+ * Expects:
+ *      * view to be nonnull, with a raster
+ *      * row to be between 0 and height - 1
+ * Notes:
+ *      * checked runtime error if view is NULL, has no raster or row is out
+ *        of range
+ ************************/
+const unsigned char *Rgbview_row(Rgbview view, int row)
+{
+        assert(view != NULL && view->raster != NULL);
+        assert(row >= 0 && (unsigned)row < view->height);
+
+        return view->raster + (size_t)row * view->stride;
+}
+
+/**********Rgbview_free********
+ *
+ * Frees a view, along with its image or the memory its raster is in
+ * Inputs:
+ *              Rgbview *view: a pointer to the view to be freed
+ * Return: N/A
+ * Expects:
+ *      * view and *view to be nonnull
+ * Notes:
+ *      * sets *view to NULL
+ *      * checked runtime error if view or *view is NULL
+ ************************/
+void Rgbview_free(Rgbview *view)
+{
+        assert(view != NULL && *view != NULL);
+
+        if ((*view)->image != NULL) {
+                Pnm_ppmfree(&(*view)->image);
+        }
+        if ((*view)->input != NULL) {
+                Inputmap_free(&(*view)->input);
+        }
+        if ((*view)->samples != NULL) {
+                Pool_free((*view)->samples);
+        }
+        free(*view);
+        *view = NULL;
+}
+
+/**********parsed_raster********
+ *
+ * Parses a P6 image with samples of one byte in place
+ * Inputs:
+ *              Inputmap map: the bytes of the image
+ *              Rgbview view: where the size, denominator and raster go
+ * Return: true if the image was parsed, false if it has to be read by
+ *         Pnm_ppmread
+ * Expects:
+ *      * map and view to be nonnull
+ ************************/
+static bool parsed_raster(Inputmap map, Rgbview view)
+{
+        size_t count;
+        const unsigned char *cursor = parsed_header(map, '6', view, &count);
+
+        if (cursor == NULL ||
+            (size_t)(map->bytes + map->size - cursor) < count ||
+            !samples_fit(cursor, count, view->denominator)) {
+                return false;
+        }
+        view->raster = cursor;
+        view->stride = (size_t)view->width * 3;
+        return true;
+}
+
+/**********parsed_text********
+ *
+ * Parses a P3 image with samples of one byte into a raster of bytes
+ * Inputs:
+ *              Inputmap map: the bytes of the image
+ *              Rgbview view: where the size, denominator and raster go
+ * Return: true if the image was parsed, false if it has to be read by
+ *         Pnm_ppmread
+ * Expects:
+ *      * map and view to be nonnull
+ * Notes:
+ *      * the raster is in view->samples, which the view owns
+ ************************/
+static bool parsed_text(Inputmap map, Rgbview view)
+{
+        size_t count;
+        const unsigned char *cursor = parsed_header(map, '3', view, &count);
+
+        if (cursor == NULL) {
+                return false;
+        }
+        unsigned char *samples = Pool_alloc(count > 0 ? count : 1);
+        if (!Plainppm_samples(cursor, map->bytes + map->size - cursor,
+                              view->denominator, samples, count)) {
+                Pool_free(samples);
+                return false;
+        }
+        view->samples = samples;
+        view->raster = samples;
+        view->stride = (size_t)view->width * 3;
+        return true;
+}
+
+/**********parsed_header********
+ *
+ * Parses the header of a ppm image with samples of one byte
+ * Inputs:
+ *              Inputmap map: the bytes of the image
+ *              char magic: the digit after the P, '6' or '3'
+ *              Rgbview view: where the size and denominator go
+ *              size_t *count: where the number of samples goes
+ * Return: the first byte of the raster, or NULL if the header has a
+ *         different magic number or can't be parsed
+ * Expects:
+ *      * map, view and count to be nonnull
+ ************************/
+static const unsigned char *parsed_header(Inputmap map, char magic,
+                                          Rgbview view, size_t *count)
+{
+        const unsigned char *cursor = map->bytes;
+        const unsigned char *end = map->bytes + map->size;
+        unsigned width, height, denominator;
+
+        if (map->size < 2 || cursor[0] != 'P' || cursor[1] != magic) {
+                return NULL;
+        }
+        cursor += 2;
+        if (!header_number(&cursor, end, &width) ||
+            !header_number(&cursor, end, &height) ||
+            !header_number(&cursor, end, &denominator)) {
+                return NULL;
+        }
+        /* exactly one whitespace character ends the header */
+        if (cursor == end || !isspace(*cursor) || denominator == 0 ||
+            denominator > MAX_8_BIT_DENOMINATOR) {
+                return NULL;
+        }
+        cursor++;
+
+        size_t row_bytes = (size_t)width * 3;
+        if (height != 0 && row_bytes > SIZE_MAX / height) {
+                return NULL;
+        }
+        view->width = width;
+        view->height = height;
+        view->denominator = denominator;
+        *count = row_bytes * height;
+        return cursor;
+}
+
+/**********header_number********
+ *
+ * Reads one number from the header of an image in memory, skipping
+ * whitespace and comments
+ * Inputs:
+ *              const unsigned char **cursor: the position to read from,
+ *                                            moved past the number
+ *              const unsigned char *end: the end of the bytes
+ *              unsigned *number: where the number goes
+ * Return: true if there was a number that fits in an int, false if not
+ * Expects:
+ *      * all pointers to be nonnull
+ ************************/
+static bool header_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number)
+{
+        const unsigned char *at = *cursor;
+
+        while (at < end && (*at == '#' || isspace(*at))) {
+                if (*at == '#') {
+                        while (at < end && *at != '\n') {
+                                at++;
+                        }
+                } else {
+                        at++;
+                }
+        }
+        if (at == end || !isdigit(*at)) {
+                return false;
+        }
+
+        unsigned value = 0;
+        while (at < end && isdigit(*at)) {
+                unsigned digit = *at - '0';
+                if (value > (INT_MAX - digit) / 10) {
+                        return false;
+                }
+                value = value * 10 + digit;
+                at++;
+        }
+        *cursor = at;
+        *number = value;
+        return true;
+}
+
+/**********samples_fit********
+ *
+ * Checks that no sample of a raster is over its denominator
+ * Inputs:
+ *              const unsigned char *raster: the samples
+ *              size_t count: the number of samples
+ *              unsigned denominator: the largest sample allowed
+ * Return: true if every sample is at most denominator
+ * Expects:
+ *      * raster to be nonnull
+ * Notes:
+ *      * only looks at the samples if denominator is under 255
+ ************************/
+static bool samples_fit(const unsigned char *raster, size_t count,
+                        unsigned denominator)
+{
+        if (denominator >= MAX_8_BIT_DENOMINATOR) {
+                return true;
+        }
+
+        unsigned char largest = 0;
+        for (size_t i = 0; i < count; i++) {
+                largest = raster[i] > largest ? raster[i] : largest;
+        }
+        return largest <= denominator;
+}
@@ -0,0 +1,63 @@
+/********************************************************************
+ *
+ *                          rgbview.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for rgbview.c
+ *
+ *     Summary:
+ *      rgbview reads the image that the encoders convert. A P6 image with
+ *      samples of one byte is parsed in place in the memory of
+ *      inputmap.h, and its raster is used where it is, as rows of
+ *      interleaved 8-bit RGB bytes, so it is never copied. A P3 image with
+ *      samples of one byte is parsed by plainppm.h into a raster of the
+ *      same layout. Any other image is read by Pnm_ppmread, and the view
+ *      holds that Pnm_ppm instead.
+ *
+ *******************************************************************/
+#ifndef RGBVIEW_INCLUDED
+#define RGBVIEW_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+#include "pnm.h"
+#include "a2methods.h"
+#include "inputmap.h"
+
+typedef struct Rgbview *Rgbview;
+
+/*
+ * This is the struct definition of the Rgbview instance
+ * Elements:
+ *      unsigned width: the number of pixels in each row
+ *      unsigned height: the number of rows
+ *      unsigned denominator: the largest sample
+ *      const unsigned char *raster: the first byte of the first row, or NULL
+ *                                   if the samples aren't bytes in memory
+ *      size_t stride: the number of bytes from one row to the next
+ *      Pnm_ppm image: the image, if raster is NULL
+ *      Inputmap input: the memory raster points into, if it is a P6 raster
+ *      unsigned char *samples: the memory raster points into, if it was
+ *                              parsed from a P3 raster
+ *
+ */
+struct Rgbview {
+        unsigned width;
+        unsigned height;
+        unsigned denominator;
+        const unsigned char *raster;
+        size_t stride;
+        Pnm_ppm image;
+        Inputmap input;
+        unsigned char *samples;
+};
+
+Rgbview Rgbview_map(Inputmap input, A2Methods_T methods);
+void Rgbview_trim(Rgbview view);
+const unsigned char *Rgbview_row(Rgbview view, int row);
+void Rgbview_free(Rgbview *view);
+
+#endif
@@ -0,0 +1,391 @@
+/********************************************************************
+ *
+ *                          wordview.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for wordview.h
+ *
+ *     Summary:
+ *      wordview parses the header of a compressed image in memory and
+ *      hands out its code words from there.
+ *
+ *     Notes:
+ *   - The header is the one print_to_stdout writes: the magic text, the
+ *     format number, the width and the height, with any whitespace before
+ *     each number, and then one newline
+ *   - The rest of the file has to be exactly the width / 2 * height / 2
+ *     words of the header, so a file that was cut short, or has anything
+ *     after its words, fails before any of it is decoded
+ *   - A file that starts with NATIVE_MAGIC is a native container instead:
+ *     its struct Native_header is checked field by field, and its code
+ *     words start at the header's word_offset. A header whose byte_order
+ *     reads reversed came from a machine with the other byte order, and
+ *     its numbers and words are reversed as they are read
+ *   - Wordview_row reverses the bytes of one row into a buffer the decoder
+ *     keeps in cache, with the vector kernels of codewords.h, so a decoder
+ *     that goes a row at a time never copies the whole image. Rows of a
+ *     native container in this machine's order aren't converted at all:
+ *     Wordview_row returns a pointer to them in the file's memory
+ *   - This module uses functions from inputmap.h and codewords.h, and the
+ *     format numbers of readwritecompressed.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <limits.h>
+#include "assert.h"
+#include "codewords.h"
+#include "readwritecompressed.h"
+#include "inputmap.h"
+#include "wordview.h"
+
+/* what every header starts with, before the format number */
+#define MAGIC "COMP40 Compressed image format"
+
+static void read_text(Wordview view);
+static void read_native(Wordview view);
+static bool header_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number);
+static void convert_words(Wordview view, const unsigned char *bytes,
+                          uint32_t *words, size_t count);
+static uint32_t reverse_word(uint32_t word);
+static uint64_t reverse_long(uint64_t number);
+static bool little_endian(void);
+
+/**********Wordview_read********
+ *
+ * Reads a compressed image in place
+ * Inputs:
+ *              FILE *input: the file, positioned at the start of the image
+ * Return: a view of the image's code words
+ * Expects:
+ *      * input to be nonnull
+ *      * the file to hold exactly the code words its header says it has
+ * Notes:
+ *      * reads the rest of the file
+ *      * the caller assumes ownership of the returned view, and frees it
+ *        with Wordview_free
+ *      * the image can be in either container of readwritecompressed.h
+ *      * checked runtime error if:
+ *              * input is NULL
+ *              * the header can't be parsed
+ *              * the header's format number isn't a Compressed_format
+ *              * a native header has another version or layout
+ *              * the file is longer or shorter than the header says
+ ************************/
+Wordview Wordview_read(FILE *input)
+{
+        assert(input != NULL);
+        Wordview view = malloc(sizeof(*view));
+        assert(view != NULL);
+        Inputmap map = Inputmap_new(input);
+        view->input = map;
+
+        if (map->size >= NATIVE_MAGIC_BYTES &&
+            memcmp(map->bytes, NATIVE_MAGIC, NATIVE_MAGIC_BYTES) == 0) {
+                read_native(view);
+        } else {
+                read_text(view);
+        }
+
+        const unsigned char *end = map->bytes + map->size;
+        size_t count = (size_t)view->width * view->height;
+        assert(view->height == 0 ||
+               (size_t)view->width <= SIZE_MAX / CODEWORD_BYTES /
+                                      view->height);
+        assert((size_t)(end - view->words) == count * CODEWORD_BYTES);
+        return view;
+}
+
+/**********Wordview_row********
+ *
+ * Gets one row of code words of a view in native order
+ * Inputs:
+ *              Wordview view: the view
+ *              int row: the index of the row
+ *              uint32_t *words: room for view->width words
+ * Return: the row's view->width code words, which are either in words or
+ *         in the view's own memory
+ * Expects:
+ *      * view and words to be nonnull
+ *      * row to be between 0 and height - 1
+ * Notes:
+ *      * the words of a native container in this machine's order are
+ *        returned where they are, and words isn't written; the row lasts
+ *        as long as the view
+ *      * checked runtime error if view or words is NULL, or row is out of
+ *        range
+ ************************/
+const uint32_t *Wordview_row(Wordview view, int row, uint32_t *words)
+{
+        assert(view != NULL && words != NULL);
+        assert(row >= 0 && row < view->height);
+
+        size_t row_bytes = (size_t)view->width * CODEWORD_BYTES;
+        const unsigned char *bytes = view->words + (size_t)row * row_bytes;
+
+        if (view->order == WORDVIEW_NATIVE &&
+            (uintptr_t)bytes % sizeof(uint32_t) == 0) {
+                return (const uint32_t *)bytes;
+        }
+        convert_words(view, bytes, words, view->width);
+        return words;
+}
+
+/**********Wordview_codewords********
+ *
+ * Converts every code word of a view into a new Codewords buffer
+ * Inputs:
+ *              Wordview view: the view
+ * Return: the code words of the image, in native order
+ * Expects:
+ *      * view to be nonnull
+ * Notes:
+ *      * for decoders that need the whole image at once; the caller
+ *        assumes ownership of the returned Codewords
+ *      * checked runtime error if view is NULL
+ ************************/
+Codewords Wordview_codewords(Wordview view)
+{
+        assert(view != NULL);
+
+        Codewords codewords = Codewords_new(view->width, view->height);
+        convert_words(view, view->words, codewords->words,
+                      (size_t)view->width * view->height);
+        return codewords;
+}
+
+/**********Wordview_free********
+ *
+ * Frees a view and the memory its code words are in
+ * Inputs:
+ *              Wordview *view: a pointer to the view to be freed
+ * Return: N/A
+ * Expects:
+ *      * view and *view to be nonnull
+ * Notes:
+ *      * sets *view to NULL
+ *      * checked runtime error if view or *view is NULL
+ ************************/
+void Wordview_free(Wordview *view)
+{
+        assert(view != NULL && *view != NULL);
+
+        Inputmap_free(&(*view)->input);
+        free(*view);
+        *view = NULL;
+}
+
+/**********read_text********
+ *
+ * Parses the text header of a compressed image in a view's memory
+ * Inputs:
+ *              Wordview view: the view, with only its input set
+ * Return: N/A
+ * Expects:
+ *      * view to be nonnull
+ * Notes:
+ *      * sets everything in the view but its input
+ *      * checked runtime error if the header can't be parsed, or its format
+ *        number isn't a Compressed_format
+ ************************/
+static void read_text(Wordview view)
+{
+        Inputmap map = view->input;
+        const unsigned char *cursor = map->bytes;
+        const unsigned char *end = map->bytes + map->size;
+        unsigned number, width, height;
+
+        size_t magic = strlen(MAGIC);
+        assert(map->size >= magic && memcmp(cursor, MAGIC, magic) == 0);
+        cursor += magic;
+        bool parsed = header_number(&cursor, end, &number) &&
+                      header_number(&cursor, end, &width) &&
+                      header_number(&cursor, end, &height);
+        assert(parsed);
+        assert(number >= COMPRESSED_YPBPR && number <= COMPRESSED_GRAY);
+        assert(cursor < end && *cursor == '\n');
+        cursor++;
+
+        view->width = width / 2;
+        view->height = height / 2;
+        view->format = (Compressed_format)number;
+        view->order = WORDVIEW_BIGENDIAN;
+        view->words = cursor;
+}
+
+/**********read_native********
+ *
+ * Checks the struct Native_header of a native container in a view's memory
+ * Inputs:
+ *              Wordview view: the view, with only its input set
+ * Return: N/A
+ * Expects:
+ *      * view to be nonnull
+ *      * the input to start with NATIVE_MAGIC
+ * Notes:
+ *      * sets everything in the view but its input
+ *      * the header is copied out of the file before it is read, so it
+ *        needn't be aligned in memory
+ *      * checked runtime error if the header is cut short, or any field of
+ *        it doesn't hold what readwritecompressed.h says it must
+ ************************/
+static void read_native(Wordview view)
+{
+        Inputmap map = view->input;
+        struct Native_header header;
+
+        assert(map->size >= sizeof(header));
+        memcpy(&header, map->bytes, sizeof(header));
+        bool swapped = header.byte_order != NATIVE_BYTE_ORDER;
+        assert(!swapped || reverse_word(header.byte_order) ==
+                           NATIVE_BYTE_ORDER);
+        if (swapped) {
+                header.version = reverse_word(header.version);
+                header.layout = reverse_word(header.layout);
+                header.format = reverse_word(header.format);
+                header.width = reverse_word(header.width);
+                header.height = reverse_word(header.height);
+                header.word_offset = reverse_long(header.word_offset);
+                header.word_count = reverse_long(header.word_count);
+        }
+
+        assert(header.version == NATIVE_VERSION);
+        assert(header.layout == NATIVE_ROW_MAJOR);
+        assert(header.format >= COMPRESSED_YPBPR &&
+               header.format <= COMPRESSED_GRAY);
+        assert(header.width <= INT_MAX && header.height <= INT_MAX);
+        assert(header.word_offset >= sizeof(header) &&
+               header.word_offset % NATIVE_ALIGN == 0 &&
+               header.word_offset <= map->size);
+        assert(header.word_count == (uint64_t)(header.width / 2) *
+                                    (header.height / 2));
+
+        view->width = header.width / 2;
+        view->height = header.height / 2;
+        view->format = (Compressed_format)header.format;
+        view->order = swapped ? WORDVIEW_SWAPPED : WORDVIEW_NATIVE;
+        view->words = map->bytes + header.word_offset;
+}
+
+/**********header_number********
+ *
+ * Reads one number from the header of a compressed image in memory,
+ * skipping the whitespace before it
+ * Inputs:
+ *              const unsigned char **cursor: the position to read from,
+ *                                            moved past the number
+ *              const unsigned char *end: the end of the bytes
+ *              unsigned *number: where the number goes
+ * Return: true if there was a number that fits in an int, false if not
+ * Expects:
+ *      * all pointers to be nonnull
+ ************************/
+static bool header_number(const unsigned char **cursor,
+                          const unsigned char *end, unsigned *number)
+{
+        const unsigned char *at = *cursor;
+
+        while (at < end && isspace(*at)) {
+                at++;
+        }
+        if (at == end || !isdigit(*at)) {
+                return false;
+        }
+
+        unsigned value = 0;
+        while (at < end && isdigit(*at)) {
+                unsigned digit = *at - '0';
+                if (value > (INT_MAX - digit) / 10) {
+                        return false;
+                }
+                value = value * 10 + digit;
+                at++;
+        }
+        *cursor = at;
+        *number = value;
+        return true;
+}
+
+/**********convert_words********
+ *
+ * Puts code words of a view into native order
+ * Inputs:
+ *              Wordview view: the view the words are from
+ *              const unsigned char *bytes: the words in the view's memory
+ *              uint32_t *words: where the count words are written
+ *              size_t count: the number of words
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ * Notes:
+ *      * words in the other order are big-endian on a little-endian
+ *        machine, so they take the vector kernels of codewords.h there
+ ************************/
+static void convert_words(Wordview view, const unsigned char *bytes,
+                          uint32_t *words, size_t count)
+{
+        if (view->order == WORDVIEW_NATIVE) {
+                memcpy(words, bytes, count * CODEWORD_BYTES);
+        } else if (view->order == WORDVIEW_BIGENDIAN || little_endian()) {
+                Codewords_from_bigendian(bytes, words, count);
+        } else {
+                memcpy(words, bytes, count * CODEWORD_BYTES);
+                for (size_t i = 0; i < count; i++) {
+                        words[i] = reverse_word(words[i]);
+                }
+        }
+}
+
+/**********reverse_word********
+ *
+ * Reverses the order of the bytes of a 32-bit word
+ * Inputs:
+ *              uint32_t word: the word
+ * Return: the word with its bytes reversed
+ * Expects:
+ *      N/A
+ ************************/
+static uint32_t reverse_word(uint32_t word)
+{
+        return word >> 24 | (word >> 8 & 0xff00) | (word << 8 & 0xff0000) |
+               word << 24;
+}
+
+/**********reverse_long********
+ *
+ * Reverses the order of the bytes of a 64-bit number
+ * Inputs:
+ *              uint64_t number: the number
+ * Return: the number with its bytes reversed
+ * Expects:
+ *      N/A
+ ************************/
+static uint64_t reverse_long(uint64_t number)
+{
+        return (uint64_t)reverse_word((uint32_t)number) << 32 |
+               reverse_word((uint32_t)(number >> 32));
+}
+
+/**********little_endian********
+ *
+ * Tells whether this machine stores the low byte of a word first
+ * Inputs: N/A
+ * Return: true if it does
+ * Expects:
+ *      N/A
+ ************************/
+static bool little_endian(void)
+{
+        uint32_t probe = 1;
+        unsigned char first;
+
+        memcpy(&first, &probe, 1);
+        return first == 1;
+}
@@ -0,0 +1,71 @@
+/********************************************************************
+ *
+ *                          wordview.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for wordview.c
+ *
+ *     Summary:
+ *      wordview reads a compressed image in place. The file is put in
+ *      memory by inputmap.h, which maps it if it is a regular file, its
+ *      header is parsed there, and its length is checked against the size
+ *      in the header. A decoder can then take the code words a row at a
+ *      time straight from the file's memory, or all at once as Codewords.
+ *      Both containers of readwritecompressed.h are read; the code words of
+ *      a native container in this machine's byte order are used where they
+ *      are, without being converted at all.
+ *
+ *******************************************************************/
+#ifndef WORDVIEW_INCLUDED
+#define WORDVIEW_INCLUDED
+
+#include <stdio.h>
+#include <stdint.h>
+#include "codewords.h"
+#include "readwritecompressed.h"
+#include "inputmap.h"
+
+typedef struct Wordview *Wordview;
+
+/*
+ * the byte orders the code words of a view can be in
+ *      WORDVIEW_BIGENDIAN: big-endian, from a text container
+ *      WORDVIEW_NATIVE: this machine's order, from a native container
+ *      WORDVIEW_SWAPPED: the other order, from a native container written
+ *                        by a machine with the other byte order
+ */
+typedef enum Wordview_order {
+        WORDVIEW_BIGENDIAN,
+        WORDVIEW_NATIVE,
+        WORDVIEW_SWAPPED
+} Wordview_order;
+
+/*
+ * This is the struct definition of the Wordview instance
+ * Elements:
+ *      int width: the number of code words in each row (image width / 2)
+ *      int height: the number of rows of code words (image height / 2)
+ *      Compressed_format format: the format number from the header
+ *      Wordview_order order: the byte order of the code words
+ *      const unsigned char *words: the code words
+ *      Inputmap input: the memory words points into
+ *
+ */
+struct Wordview {
+        int width;
+        int height;
+        Compressed_format format;
+        Wordview_order order;
+        const unsigned char *words;
+        Inputmap input;
+};
+
+Wordview Wordview_read(FILE *input);
+const uint32_t *Wordview_row(Wordview view, int row, uint32_t *words);
+Codewords Wordview_codewords(Wordview view);
+void Wordview_free(Wordview *view);
+
+#endif
@@ -0,0 +1,264 @@
+/********************************************************************
+ *
+ *                          ycocg.c
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Implementation for ycocg.h
+ *
+ *     Summary:
+ *      ycocg is a cheaper color transform for the 2x2 block encoder. It
+ *      turns pairs of 8-bit RGB scanlines into code words through YCoCg-R,
+ *      with integer arithmetic only.
+ *
+ *     Notes:
+ *   - YCoCg-R, forward:  Co = R - B, t = B + Co / 2, Cg = G - t,
+ *     Y = t + Cg / 2;  inverse:  t = Y - Cg / 2, G = Cg + t, B = t - Co / 2,
+ *     R = B + Co, where / 2 rounds down. The inverse undoes the forward
+ *     transform exactly, and for a fixed Co and Cg it only adds a constant
+ *     to Y in each channel, which is why the table decoder can decode it
+ *   - Y is 0..255, so a block's a, b, c and d come from sums of 4 values of
+ *     Y, and its Co and Cg from sums of 4 values of Co and Cg. Every sum has
+ *     at most 2041 values, so each is quantized with one lookup in a table
+ *     built the first time it is needed
+ *   - a, b, c and d are quantized like the float encoder quantizes y / 255,
+ *     rounded half away from zero, and Co and Cg like Pb and Pr with
+ *     YCOCG_CHROMA_SCALE, so a code word has the same fields and the
+ *     compressed image the same size
+ *   - Halving a negative value is done without shifting it, since shifting
+ *     a negative value right isn't defined the same way by every compiler
+ *   - This module uses functions from chroma.h and the layout of the code
+ *     word from quantization.h
+ *******************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "assert.h"
+#include "chroma.h"
+#include "quantization.h"
+#include "ycocg.h"
+
+#define SAMPLE_MAX 255
+#define SUM_MAX (4 * SAMPLE_MAX)
+#define DIFFERENCE_MAX (4 * SAMPLE_MAX)
+
+/* a is quantized to A_STEPS steps, and b, c and d to 1 / BCD_CODE steps */
+#define A_STEPS 63
+#define BCD_STEPS 105
+#define BCD_MAX 31
+
+/* rounds a constant expression half away from zero */
+#define ROUNDED(x) ((int)((x) < 0 ? (x) - 0.5 : (x) + 0.5))
+
+/*
+ * This is the struct definition of the quantizers instance, which holds
+ * the quantized field of every sum the encoder can see
+ * Elements:
+ *      uint8_t a[]: the a field of each sum of 4 y values
+ *      int8_t bcd[]: the b, c or d field of each difference of 4 y values,
+ *                    indexed by the difference plus DIFFERENCE_MAX
+ *      uint8_t chroma[]: the chroma index of each sum of 4 Co or Cg values,
+ *                        indexed by the sum plus 2 * DIFFERENCE_MAX
+ *
+ */
+struct quantizers {
+        uint8_t a[SUM_MAX + 1];
+        int8_t bcd[2 * DIFFERENCE_MAX + 1];
+        uint8_t chroma[4 * DIFFERENCE_MAX + 1];
+};
+
+static const struct quantizers *quantizers(void);
+static int rounded_ratio(int numerator, int denominator);
+static int halved(int value);
+
+/**********Ycocg_rows_to_words********
+ *
+ * Converts two 8-bit RGB scanlines into a row of 32-bit code words, through
+ * YCoCg-R
+ * Inputs:
+ *              const unsigned char *top: the 2 * count pixels of the top
+ *                                        scanline, 3 bytes each
+ *              const unsigned char *bottom: the 2 * count pixels of the
+ *                                           scanline below
+ *              int count: the number of 2x2 blocks
+ *              uint32_t *words: where the count code words are written
+ * Return: N/A
+ * Expects:
+ *      * all pointers to be nonnull
+ *      * count to be nonnegative
+ *      * the samples to have a denominator of 255
+ * Notes:
+ *      * uses no floating point, apart from building the tables once
+ *      * checked runtime error if:
+ *              * any pointer is NULL
+ *              * count is negative
+ ************************/
+void Ycocg_rows_to_words(const unsigned char *top, const unsigned char *bottom,
+                         int count, uint32_t *words)
+{
+        assert(top != NULL && bottom != NULL && words != NULL);
+        assert(count >= 0);
+
+        const struct quantizers *tables = quantizers();
+
+        for (int i = 0; i < count; i++) {
+                /* top left, top right, bottom left, bottom right */
+                const unsigned char *pixels[4] = { top + i * 6,
+                                                   top + i * 6 + 3,
+                                                   bottom + i * 6,
+                                                   bottom + i * 6 + 3 };
+                int y[4];
+                int co_sum = 0;
+                int cg_sum = 0;
+
+                for (int j = 0; j < 4; j++) {
+                        int co = pixels[j][0] - pixels[j][2];
+                        int t = pixels[j][2] + halved(co);
+                        int cg = pixels[j][1] - t;
+
+                        y[j] = t + halved(cg);
+                        co_sum += co;
+                        cg_sum += cg;
+                }
+
+                /* the discrete cosine transform, on sums of 4 values */
+                struct Codeword_fields fields = {
+                        .a = tables->a[y[3] + y[2] + y[1] + y[0]],
+                        .b = tables->bcd[y[3] + y[2] - y[1] - y[0] +
+                                         DIFFERENCE_MAX],
+                        .c = tables->bcd[y[3] - y[2] + y[1] - y[0] +
+                                         DIFFERENCE_MAX],
+                        .d = tables->bcd[y[3] - y[2] - y[1] + y[0] +
+                                         DIFFERENCE_MAX],
+                        .pb = tables->chroma[co_sum + 2 * DIFFERENCE_MAX],
+                        .pr = tables->chroma[cg_sum + 2 * DIFFERENCE_MAX]
+                };
+                words[i] = Codeword_pack(fields);
+        }
+}
+
+/**********Ycocg_to_rgb********
+ *
+ * Converts one pixel from YCoCg-R back to RGB
+ * Inputs:
+ *              int y: the Y value
+ *              int co: the Co value
+ *              int cg: the Cg value
+ *              int *red, *green, *blue: where the samples go
+ * Return: N/A
+ * Expects:
+ *      * red, green and blue to be nonnull
+ * Notes:
+ *      * the samples aren't clamped, so with a y of 0 this gives what the
+ *        chroma adds to each channel
+ *      * checked runtime error if any pointer is NULL
+ ************************/
+void Ycocg_to_rgb(int y, int co, int cg, int *red, int *green, int *blue)
+{
+        assert(red != NULL && green != NULL && blue != NULL);
+
+        int t = y - halved(cg);
+
+        *green = cg + t;
+        *blue = t - halved(co);
+        *red = *blue + co;
+}
+
+/**********Ycocg_chroma_of_index********
+ *
+ * Returns the Co or Cg value of a chroma index
+ * Inputs:
+ *              unsigned index: the index, from 0 to CHROMA_LEVELS - 1
+ * Return: the level of the index times YCOCG_CHROMA_SCALE, rounded half
+ *         away from zero
+ * Expects:
+ *      * index to be less than CHROMA_LEVELS
+ * Notes:
+ *      * checked runtime error if index is too big
+ ************************/
+int Ycocg_chroma_of_index(unsigned index)
+{
+        assert(index < CHROMA_LEVELS);
+        return ROUNDED(Chroma_of_index(index) * (double)YCOCG_CHROMA_SCALE);
+}
+
+/**********quantizers********
+ *
+ * Returns the tables that quantize the sums of a block
+ * Inputs: N/A
+ * Return: a pointer to the tables
+ * Expects:
+ *      N/A
+ * Notes:
+ *      * the tables are built by the first call
+ ************************/
+static const struct quantizers *quantizers(void)
+{
+        static struct quantizers tables;
+        static bool built = false;
+
+        if (!built) {
+                for (int sum = 0; sum <= SUM_MAX; sum++) {
+                        tables.a[sum] = rounded_ratio(sum * A_STEPS, SUM_MAX);
+                }
+                for (int difference = -DIFFERENCE_MAX;
+                     difference <= DIFFERENCE_MAX; difference++) {
+                        int field = rounded_ratio(difference * BCD_STEPS,
+                                                  SUM_MAX);
+                        if (field > BCD_MAX) {
+                                field = BCD_MAX;
+                        } else if (field < -BCD_MAX) {
+                                field = -BCD_MAX;
+                        }
+                        tables.bcd[difference + DIFFERENCE_MAX] = field;
+                }
+                for (int sum = -2 * DIFFERENCE_MAX; sum <= 2 * DIFFERENCE_MAX;
+                     sum++) {
+                        float chroma = (float)sum / (4 * YCOCG_CHROMA_SCALE);
+                        tables.chroma[sum + 2 * DIFFERENCE_MAX] =
+                                                Chroma_index_of(chroma);
+                }
+                built = true;
+        }
+        return &tables;
+}
+
+/**********rounded_ratio********
+ *
+ * Divides two ints, rounding half away from zero
+ * Inputs:
+ *              int numerator: the value to be divided
+ *              int denominator: the value to divide by
+ * Return: numerator / denominator, rounded
+ * Expects:
+ *      * denominator to be positive
+ ************************/
+static int rounded_ratio(int numerator, int denominator)
+{
+        if (numerator >= 0) {
+                return (2 * numerator + denominator) / (2 * denominator);
+        }
+        return -((-2 * numerator + denominator) / (2 * denominator));
+}
+
+/**********halved********
+ *
+ * Halves an int, rounding down
+ * Inputs:
+ *              int value: the value to be halved
+ * Return: value / 2, rounded towards negative infinity, like an arithmetic
+ *         shift right by 1
+ * Expects:
+ *      N/A
+ ************************/
+static int halved(int value)
+{
+        if (value >= 0) {
+                return value / 2;
+        }
+        return -((1 - value) / 2);
+}
@@ -0,0 +1,39 @@
+/********************************************************************
+ *
+ *                          ycocg.h
+ *
+ *     Assignment: arith
+ *     Authors:    Kabir Pamnani & Isaac Monheit
+ *     Date:       March 9th, 2023
+ *
+ *      * Interface for ycocg.c
+ *
+ *     Summary:
+ *      ycocg is a cheaper color transform for the 2x2 block encoder, picked
+ *      with --ycocg. Instead of the float Y/Pb/Pr matrices it uses YCoCg-R,
+ *      which turns 8-bit RGB into Y, Co and Cg with integer adds and halvings
+ *      only and can be undone exactly. Y goes through the same 2x2 discrete
+ *      cosine transform, and Co and Cg take the places of Pb and Pr, so the
+ *      code words are the same size. Compressed images say which transform
+ *      they use in their header (see readwritecompressed.h), and are decoded
+ *      with the tables from Decodetables_ycocg.
+ *
+ *******************************************************************/
+#ifndef YCOCG_INCLUDED
+#define YCOCG_INCLUDED
+
+#include <stdint.h>
+
+/*
+ * Co and Cg of 8-bit samples are between -255 and 255, so over this scale
+ * they lie in [-0.5, 0.5] like Pb and Pr, and use the same chroma levels
+ */
+#define YCOCG_CHROMA_SCALE 510
+
+void Ycocg_rows_to_words(const unsigned char *top, const unsigned char *bottom,
+                         int count, uint32_t *words);
+
+void Ycocg_to_rgb(int y, int co, int cg, int *red, int *green, int *blue);
+int Ycocg_chroma_of_index(unsigned index);
+
+#endif